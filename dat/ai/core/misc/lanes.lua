@@ -391,7 +391,7 @@ end
 function lanes.getNonPointP( p, pos, rad, margin, biasdir )
    local ews
    if not pos or not rad or not margin then
-      ews = p:stats().ew_stealth
+      ews = p:stats("ew_stealth")
    end
    pos = pos or p:pos()
    rad = rad or math.min( 2000, ews )
@@ -0,0 +1,84 @@
+--[[
+<?xml version='1.0' encoding='utf8'?>
+<event name="Lua Benchmark">
+ <location>none</location>
+ <chance>0</chance>
+</event>
+--]]
+--[[
+   Runs the benchmark passed with --bench-lua, which is started by the engine
+   instead of the main menu. Running it from an event lets the benchmark use
+   hooks and everything else missions and events can.
+
+   The benchmark script has to return a function, which is run as a coroutine
+   that gets resumed every frame with the delta tick, so it can let the
+   simulation run by yielding. The function has to return a table with the
+   result columns and rows, see utils/benchmark/common.lua, which get printed
+   as csv and written to a csv file with the same name in the write directory.
+   Once done, bench_status is set to "ok" or the error message, and the engine
+   reports it and quits.
+--]]
+-- luacheck: globals update bench_status (Hook functions passed by name and status read by the engine)
+
+local co, name
+
+local function fail( msg )
+   warn( msg )
+   bench_status = msg
+end
+
+local function report( res )
+   local csvfile = file.new( name..".csv" )
+   csvfile:open("w")
+   local function log( msg )
+      print( msg )
+      csvfile:write( msg.."\n" )
+   end
+   log( table.concat( res.columns, "," ) )
+   for k,row in ipairs(res.rows) do
+      local vals = {}
+      for i,c in ipairs(res.columns) do
+         local v = row[c]
+         if type(v)=="number" and math.floor(v)~=v then
+            vals[i] = string.format( "%.6g", v )
+         else
+            vals[i] = tostring(v)
+         end
+      end
+      log( table.concat( vals, "," ) )
+   end
+   csvfile:close()
+end
+
+function create ()
+   local path = naev.conf().bench_lua
+   if not path then
+      return fail( "no benchmark was passed with --bench-lua" )
+   end
+   name = string.match( path, "([^/]*)%.lua$" ) or path
+   local modname = string.gsub( string.gsub( path, "%.lua$", "" ), "/", "." )
+   local ok, func = pcall( require, modname )
+   if not ok then
+      return fail( func )
+   elseif type(func)~="function" then
+      return fail( string.format( "'%s' does not return a function", path ) )
+   end
+   co = coroutine.create( func )
+   hook.update( "update" )
+end
+
+function update( dt )
+   if bench_status then
+      return
+   end
+   local ok, res = coroutine.resume( co, dt )
+   if not ok then
+      return fail( res )
+   elseif coroutine.status( co )=="dead" then
+      if type(res)~="table" or not res.columns or not res.rows then
+         return fail( string.format( "'%s' did not return any results", name ) )
+      end
+      report( res )
+      bench_status = "ok"
+   end
+end
@@ -381,7 +381,7 @@ function scom.spawn( pilots )
       -- Make sure they survive the nebula
       if nebu_vol > 0 then
          local dmg = nebu_vol * (1-p:shipstat("nebu_absorb",true))
-         if p:stats().shield_regen <= dmg then
+         if p:stats("shield_regen") <= dmg then
             if leader==p then
                leader = nil
             end
@@ -9,14 +9,17 @@ function init( _p, po )
    mem.force_off = false
 end
 
-function update( _p, po )
-   if mem.nebu_vol <= 0 or mem.force_off then
-      return
+-- Run for all the pilots with the outfit at once, entries are { p, po, mem }
+function update_batch( entries, _dt )
+   for _k,e in ipairs(entries) do
+      local po, m = e[2], e[3]
+      if m.nebu_vol > 0 and not m.force_off then
+         po:state("on")
+         local regen = math.min( max_regen, m.nebu_vol )
+         po:set( "shield_regen_malus", -regen )
+         po:set( "energy_regen_malus", regen )
+      end
    end
-   po:state("on")
-   local regen = math.min( max_regen, mem.nebu_vol )
-   po:set( "shield_regen_malus", -regen )
-   po:set( "energy_regen_malus", regen )
 end
 
 
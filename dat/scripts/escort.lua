@@ -238,10 +238,10 @@ function escort.reset_ai ()
       if not l then return end
 
       -- Find and limit max speed
-      local minspeed = player.pilot():stats().speed_max * 0.9
+      local minspeed = player.pilot():stats("speed_max") * 0.9
       for k,p in ipairs(mem._escort.convoy) do
          if p:exists() then
-            minspeed = math.min( p:stats().speed_max * 0.95, minspeed )
+            minspeed = math.min( p:stats("speed_max") * 0.95, minspeed )
          end
       end
       l:setSpeedLimit( minspeed )
@@ -1,12 +1,23 @@
 #include "lib/sdf.glsl"
 
+#ifdef RADAR_BATCH
+in vec4 colour;
+in vec2 dimensions;
+in vec2 radar_pos;
+uniform float radar_radius; // Clips to a circle if positive
+#else /* RADAR_BATCH */
 uniform vec4 colour;
 uniform vec2 dimensions;
+#endif /* RADAR_BATCH */
 
 in vec2 pos;
 out vec4 colour_out;
 
 void main(void) {
+#ifdef RADAR_BATCH
+   if (radar_radius > 0.0 && length(radar_pos) > radar_radius)
+      discard;
+#endif /* RADAR_BATCH */
    vec2 uv = pos * dimensions;
    float d = sdBox( uv, dimensions-vec2(2.0) );
    float alpha = smoothstep(-1.0,  0.0, -d);
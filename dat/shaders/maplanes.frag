@@ -0,0 +1,20 @@
+#include "lib/sdf.glsl"
+
+uniform float radius;
+
+in vec2 pos;
+in vec2 dimensions;
+in vec4 colour;
+in vec4 colour2;
+out vec4 colour_out;
+
+/* Same as jumplane.frag, but with the parameters per vertex. */
+void main(void) {
+   vec2 uv        = pos * dimensions;
+   float d        = sdBox( uv, dimensions-vec2(1.0) );
+   float alpha    = smoothstep( -1.0,  0.0, -d);
+   colour_out     = mix( colour, colour2, smoothstep(0.0,1.0,pos.x*0.5+0.5) );
+   colour_out.a  *= 0.8 - 0.6*abs(pos.x);
+   colour_out.a  *= smoothstep(dimensions.x, dimensions.x-radius, length(uv));
+   colour_out.a  *= alpha;
+}
@@ -0,0 +1,25 @@
+uniform mat4 projection;
+uniform float zoom;
+
+in vec2 centre;
+in vec2 dir;
+in vec2 vertex;
+in vec2 size;
+in vec4 colour_start;
+in vec4 colour_end;
+
+out vec2 pos;
+out vec2 dimensions;
+out vec4 colour;
+out vec4 colour2;
+
+void main(void) {
+   /* The length follows the zoom, but the width is in pixels. */
+   dimensions  = vec2( size.x * zoom, size.y );
+   vec2 normal = vec2( -dir.y, dir.x );
+   vec2 p      = centre * zoom + dir * vertex.x * dimensions.x + normal * vertex.y * dimensions.y;
+   pos         = vertex;
+   colour      = colour_start;
+   colour2     = colour_end;
+   gl_Position = projection * vec4( p, 0.0, 1.0 );
+}
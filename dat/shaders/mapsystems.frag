@@ -0,0 +1,17 @@
+#include "lib/sdf.glsl"
+
+in vec2 pos;
+in float dimension;
+in float fill;
+in vec4 colour;
+out vec4 colour_out;
+
+/* Same as circle.frag, but with the parameters per vertex. */
+void main(void) {
+   float d = sdCircle( pos*dimension, dimension-1.0 );
+   if (fill < 0.5)
+      d = abs(d);
+   float alpha = smoothstep(-1.0, 0.0, -d);
+   colour_out   = colour;
+   colour_out.a *= alpha;
+}
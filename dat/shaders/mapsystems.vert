@@ -0,0 +1,23 @@
+uniform mat4 projection;
+uniform float zoom;
+uniform float radius;
+
+in vec2 centre;
+in vec2 vertex;
+in float size;
+in float filled;
+in vec4 vertex_colour;
+
+out vec2 pos;
+out float dimension;
+out float fill;
+out vec4 colour;
+
+void main(void) {
+   /* Systems have a fixed size in pixels. */
+   dimension   = size * radius;
+   pos         = vertex;
+   fill        = filled;
+   colour      = vertex_colour;
+   gl_Position = projection * vec4( centre * zoom + vertex * dimension, 0.0, 1.0 );
+}
@@ -0,0 +1,22 @@
+/* Radar markers are drawn instanced, with one instance per marker. */
+uniform mat4 projection;
+in vec4 vertex; // Unit square centred at the origin
+in vec4 marker; // Position, size and rotation of the marker
+in vec4 marker_colour;
+
+out vec2 pos;
+out vec2 radar_pos;
+out vec4 colour;
+out vec2 dimensions;
+
+void main(void) {
+   float c = cos( marker.w );
+   float s = sin( marker.w );
+   vec2 p = marker.xy + mat2( c, s, -s, c ) * (vertex.xy * marker.z);
+
+   pos         = vertex.xy;
+   radar_pos   = p;
+   colour      = marker_colour;
+   dimensions  = vec2( marker.z );
+   gl_Position = projection * vec4( p, 0.0, 1.0 );
+}
@@ -1,12 +1,39 @@
-/* Same as project_pos.vert */
+/* Trails are drawn instanced, with one instance per trail segment. */
 uniform mat4 projection;
-in vec4 vertex;
-out vec2 pos;
+in vec4 vertex; // Unit square, x goes along the segment and y across
+in vec4 segment; // Screen coordinates of the start and end of the segment
+in float thick; // Thickness in screen coordinates
+in vec2 depth; // Start and end depth of the trail
+in vec4 colour1;
+in vec4 colour2;
+in vec2 time;
+in vec2 position1;
+in vec2 position2;
+in vec2 params; // Unique value and timer of the trail
 
-uniform vec2 z; // Depth
+out vec2 pos;
+out vec4 c1;
+out vec4 c2;
+out vec2 t;
+out vec2 pos1;
+out vec2 pos2;
+out float r;
+out float dt;
 
 void main(void) {
-   pos = vertex.xy;
-   gl_Position = projection * vertex;
-   gl_Position.z = mix( z.x, z.y, vertex.x ); // Use the "trail" depth
+   vec2 d = segment.zw - segment.xy;
+   vec2 n = vec2( -d.y, d.x ) / length( d );
+   vec2 p = segment.xy + d * vertex.x + n * thick * (vertex.y - 0.5);
+
+   pos  = vertex.xy;
+   c1   = colour1;
+   c2   = colour2;
+   t    = time;
+   pos1 = position1;
+   pos2 = position2;
+   r    = params.x;
+   dt   = params.y;
+
+   gl_Position = projection * vec4( p, 0.0, 1.0 );
+   gl_Position.z = mix( depth.x, depth.y, vertex.x ); // Use the "trail" depth
 }
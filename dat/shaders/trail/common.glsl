@@ -3,13 +3,13 @@
 
 // For ideas: https://thebookofshaders.com/05/
 
-uniform vec4 c1;  // Start colour
-uniform vec4 c2;  // End colour
-uniform vec2 t; // Start and end time [0,1]
-uniform float dt; // Current time (in seconds)
-uniform vec2 pos1;// Start position
-uniform vec2 pos2;// End position
-uniform float r;  // Unique value per trail [0,1]
+in vec4 c1;  // Start colour
+in vec4 c2;  // End colour
+in vec2 t; // Start and end time [0,1]
+in float dt; // Current time (in seconds)
+in vec2 pos1;// Start position
+in vec2 pos2;// End position
+in float r;  // Unique value per trail [0,1]
 uniform vec3 nebu_col; // Base colour of the nebula, only changes when entering new system
 
 in vec2 pos;
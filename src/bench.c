@@ -0,0 +1,124 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file bench.c
+ *
+ * @brief Running Lua benchmarks headless.
+ *
+ * When a benchmark is passed with --bench-lua, the main menu is replaced by a
+ * throwaway player and the BENCH_EVENT event, which loads the benchmark script
+ * and runs it from its own environment, so that the script has access to hooks
+ * and everything else missions and events can use. The main loop then runs
+ * without rendering and with a fixed delta tick, so that the same benchmark
+ * simulates the same amount of time on every machine.
+ *
+ * The event sets the global "bench_status" to "ok" once the benchmark has
+ * written its results, or to an error message if it failed, after which the
+ * game reports it and quits.
+ */
+/** @cond */
+#include "naev.h"
+/** @endcond */
+
+#include "bench.h"
+
+#include "conf.h"
+#include "event.h"
+#include "log.h"
+#include "menu.h"
+#include "nlua.h"
+#include "pause.h"
+#include "player.h"
+
+static int          bench_running = 0; /**< Whether a benchmark is running. */
+static unsigned int bench_event   = 0; /**< ID of the benchmark event. */
+
+/**
+ * @brief Starts the benchmark if one was passed on the command line.
+ *
+ * Has to be called once the main menu is open, which it replaces.
+ *
+ *    @return 1 if a benchmark was started, 0 if there is none, and <0 on error.
+ */
+int bench_start( void )
+{
+   if ( conf.bench_lua == NULL )
+      return 0;
+
+   /* Benchmarks toggle settings, which shouldn't stick. */
+   conf.nosave = 1;
+
+   menu_main_close();
+   if ( player_newHeadless( _( "Benchmark" ) ) ) {
+      WARN( _( "Unable to create the player for benchmark '%s'!" ),
+            conf.bench_lua );
+      naev_quit();
+      return -1;
+   }
+   unpause_game();
+
+   if ( event_start( BENCH_EVENT, &bench_event ) ) {
+      WARN( _( "Unable to start the '%s' event for benchmark '%s'!" ),
+            BENCH_EVENT, conf.bench_lua );
+      naev_quit();
+      return -1;
+   }
+
+   LOG( _( "Running benchmark '%s'." ), conf.bench_lua );
+   bench_running = 1;
+   return 1;
+}
+
+/**
+ * @brief Checks to see if a benchmark is running.
+ */
+int bench_isRunning( void )
+{
+   return bench_running;
+}
+
+/**
+ * @brief Overrides the delta tick of a frame while benchmarking.
+ *
+ *    @param[in,out] dt Real delta tick of the frame.
+ */
+void bench_frame( double *dt )
+{
+   if ( bench_running )
+      *dt = BENCH_DT;
+}
+
+/**
+ * @brief Checks to see if the benchmark is done, and if so reports it and quits
+ * the game.
+ */
+void bench_update( void )
+{
+   const nlua_env *env;
+   const char     *status;
+
+   if ( !bench_running )
+      return;
+
+   env = event_getEnv( bench_event );
+   if ( env == NULL ) {
+      WARN( _( "Benchmark '%s' failed: the event stopped without results!" ),
+            conf.bench_lua );
+      bench_running = 0;
+      naev_quit();
+      return;
+   }
+
+   nlua_getenv( naevL, env, "bench_status" );
+   status = lua_tostring( naevL, -1 );
+   if ( status != NULL ) {
+      if ( strcmp( status, "ok" ) == 0 )
+         LOG( _( "Benchmark finished: '%s'." ), conf.bench_lua );
+      else
+         WARN( _( "Benchmark '%s' failed: %s" ), conf.bench_lua, status );
+      bench_running = 0;
+      naev_quit();
+   }
+   lua_pop( naevL, 1 );
+}
@@ -0,0 +1,19 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+#define BENCH_EVENT "Lua Benchmark" /**< Event that runs the benchmarks. */
+#define BENCH_DT ( 1. / 60. ) /**< Fixed delta tick used while benchmarking. */
+
+/*
+ * Control.
+ */
+int bench_start( void );
+int bench_isRunning( void );
+
+/*
+ * Main loop hooks.
+ */
+void bench_frame( double *dt );
+void bench_update( void );
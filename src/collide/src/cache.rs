@@ -0,0 +1,239 @@
+//! Packed on-disk cache for collision polygons.
+//!
+//! Instead of having one small file per asset, all the cached polygons are stored in a single
+//! archive that gets memory mapped on start up. The archive is laid out as:
+//!
+//! * Header: magic (8 bytes), version (u32), number of entries (u32)
+//! * Index: sorted list of entries of (blake3 hash, offset, length)
+//! * Data: the bitcode serialized data referenced by the index
+//!
+//! New entries are kept in memory and only written out when [`flush`] is called, which rewrites
+//! the archive merging the old and new entries.
+use anyhow::Result;
+use fs_err as fs;
+use memmap2::Mmap;
+use nlog::{warn, warn_err};
+use serde::Serialize;
+use serde::de::DeserializeOwned;
+use std::collections::{BTreeMap, HashMap};
+use std::path::{Path, PathBuf};
+use std::sync::{LazyLock, RwLock};
+
+const MAGIC: &[u8; 8] = b"NAEVPOLY";
+const VERSION: u32 = 3;
+const HEADER_SIZE: usize = 16;
+const KEY_SIZE: usize = blake3::OUT_LEN;
+const ENTRY_SIZE: usize = KEY_SIZE + 8 + 8;
+
+/// Key used to index the cache.
+pub type Key = [u8; KEY_SIZE];
+
+pub struct PackedCache {
+   /// Path to the archive
+   path: PathBuf,
+   /// Memory mapped archive, if it exists and is valid
+   mmap: Option<Mmap>,
+   /// Number of entries in the mapped index
+   count: usize,
+   /// Entries that have not been written to disk yet
+   pending: HashMap<Key, Vec<u8>>,
+}
+
+impl PackedCache {
+   /// Opens a packed cache from a path. Missing or invalid archives are treated as empty.
+   pub fn open<P: AsRef<Path>>(path: P) -> Self {
+      let path = path.as_ref().to_path_buf();
+      let (mmap, count) = match Self::map(&path) {
+         Ok(Some((mmap, count))) => (Some(mmap), count),
+         Ok(None) => (None, 0),
+         Err(e) => {
+            warn_err!(e.context(format!("unable to map '{}'", path.display())));
+            (None, 0)
+         }
+      };
+      PackedCache {
+         path,
+         mmap,
+         count,
+         pending: HashMap::new(),
+      }
+   }
+
+   fn map(path: &Path) -> Result<Option<(Mmap, usize)>> {
+      let file = match std::fs::File::open(path) {
+         Ok(file) => file,
+         Err(e) if e.kind() == std::io::ErrorKind::NotFound => return Ok(None),
+         Err(e) => return Err(e.into()),
+      };
+      // Safety: the archive is only ever replaced by renaming, never modified in place.
+      let mmap = unsafe { Mmap::map(&file)? };
+      if mmap.len() < HEADER_SIZE || &mmap[0..8] != MAGIC {
+         anyhow::bail!("invalid header");
+      }
+      let version = u32::from_le_bytes(mmap[8..12].try_into()?);
+      if version != VERSION {
+         // Just regenerate, not worth warning about
+         return Ok(None);
+      }
+      let count = u32::from_le_bytes(mmap[12..16].try_into()?) as usize;
+      if mmap.len() < HEADER_SIZE + count * ENTRY_SIZE {
+         anyhow::bail!("truncated index");
+      }
+      Ok(Some((mmap, count)))
+   }
+
+   /// Gets the raw index entry at a position.
+   fn entry(mmap: &[u8], i: usize) -> (&[u8], usize, usize) {
+      let base = HEADER_SIZE + i * ENTRY_SIZE;
+      let key = &mmap[base..base + KEY_SIZE];
+      let offset = u64::from_le_bytes(
+         mmap[base + KEY_SIZE..base + KEY_SIZE + 8]
+            .try_into()
+            .unwrap(),
+      );
+      let len = u64::from_le_bytes(
+         mmap[base + KEY_SIZE + 8..base + ENTRY_SIZE]
+            .try_into()
+            .unwrap(),
+      );
+      (key, offset as usize, len as usize)
+   }
+
+   /// Looks up an entry in the memory mapped archive with a binary search over the index.
+   fn get_mapped(&self, key: &Key) -> Option<&[u8]> {
+      let mmap = self.mmap.as_ref()?;
+      let (mut lo, mut hi) = (0, self.count);
+      while lo < hi {
+         let mid = (lo + hi) / 2;
+         let (k, offset, len) = Self::entry(mmap, mid);
+         match k.cmp(key.as_slice()) {
+            std::cmp::Ordering::Less => lo = mid + 1,
+            std::cmp::Ordering::Greater => hi = mid,
+            std::cmp::Ordering::Equal => return mmap.get(offset..offset.checked_add(len)?),
+         }
+      }
+      None
+   }
+
+   /// Iterates over the raw data of all the entries in the memory mapped archive.
+   #[cfg(test)]
+   pub fn mapped_values(&self) -> impl Iterator<Item = &[u8]> {
+      let mmap = self.mmap.as_deref();
+      let count = if mmap.is_some() { self.count } else { 0 };
+      (0..count).filter_map(move |i| {
+         let mmap = mmap?;
+         let (_, offset, len) = Self::entry(mmap, i);
+         mmap.get(offset..offset.checked_add(len)?)
+      })
+   }
+
+   /// Gets the raw data associated with a key.
+   pub fn get(&self, key: &Key) -> Option<&[u8]> {
+      match self.pending.get(key) {
+         Some(data) => Some(data.as_slice()),
+         None => self.get_mapped(key),
+      }
+   }
+
+   /// Adds a new entry to the cache. It will not be written to disk until flushed.
+   pub fn insert(&mut self, key: Key, data: Vec<u8>) {
+      self.pending.insert(key, data);
+   }
+
+   /// Writes the pending entries to disk, rewriting the archive.
+   pub fn flush(&mut self) -> Result<()> {
+      if self.pending.is_empty() {
+         return Ok(());
+      }
+
+      let data = {
+         let mut entries: BTreeMap<&[u8], &[u8]> = BTreeMap::new();
+         if let Some(mmap) = &self.mmap {
+            for i in 0..self.count {
+               let (k, offset, len) = Self::entry(mmap, i);
+               let Some(end) = offset.checked_add(len) else {
+                  continue;
+               };
+               if let Some(d) = mmap.get(offset..end) {
+                  entries.insert(k, d);
+               }
+            }
+         }
+         for (k, d) in &self.pending {
+            entries.insert(k.as_slice(), d.as_slice());
+         }
+
+         let mut offset = HEADER_SIZE + entries.len() * ENTRY_SIZE;
+         let total = offset + entries.values().map(|d| d.len()).sum::<usize>();
+         let mut data: Vec<u8> = Vec::with_capacity(total);
+         data.extend_from_slice(MAGIC);
+         data.extend_from_slice(&VERSION.to_le_bytes());
+         data.extend_from_slice(&(entries.len() as u32).to_le_bytes());
+         for (k, d) in &entries {
+            data.extend_from_slice(k);
+            data.extend_from_slice(&(offset as u64).to_le_bytes());
+            data.extend_from_slice(&(d.len() as u64).to_le_bytes());
+            offset += d.len();
+         }
+         for d in entries.values() {
+            data.extend_from_slice(d);
+         }
+         data
+      };
+
+      // Other instances of the game may be flushing at the same time, so use a unique name
+      let tmp = self.path.with_extension(format!("{}.tmp", std::process::id()));
+      if let Err(e) = fs::write(&tmp, &data) {
+         let _ = fs::remove_file(&tmp);
+         return Err(e.into());
+      }
+
+      // Have to unmap before replacing the file or some platforms will complain, and map
+      // whatever is there afterwards even if replacing it failed
+      self.mmap = None;
+      self.count = 0;
+      let renamed = fs::rename(&tmp, &self.path);
+      if let Some((mmap, count)) = Self::map(&self.path)? {
+         self.mmap = Some(mmap);
+         self.count = count;
+      }
+      if let Err(e) = renamed {
+         let _ = fs::remove_file(&tmp);
+         return Err(e.into());
+      }
+      self.pending.clear();
+      Ok(())
+   }
+}
+
+/// The global collision cache.
+static CACHE: LazyLock<RwLock<PackedCache>> = LazyLock::new(|| {
+   RwLock::new(PackedCache::open(
+      ndata::cache_dir().join("collisions.pack"),
+   ))
+});
+
+/// Tries to load an object from the collision cache.
+pub fn load<T: DeserializeOwned>(key: &blake3::Hash) -> Option<T> {
+   let cache = CACHE.read().unwrap();
+   let data = cache.get(key.as_bytes())?;
+   match bitcode::deserialize::<T>(data) {
+      Ok(obj) => Some(obj),
+      Err(e) => {
+         warn!("corrupted collision cache entry: {e}");
+         None
+      }
+   }
+}
+
+/// Stores an object in the collision cache. Use [`flush`] to write to disk.
+pub fn store<T: Serialize>(key: &blake3::Hash, obj: &T) -> Result<()> {
+   let data = bitcode::serialize(obj)?;
+   CACHE.write().unwrap().insert(*key.as_bytes(), data);
+   Ok(())
+}
+
+/// Writes any new collision cache entries to disk.
+pub fn flush() -> Result<()> {
+   CACHE.write().unwrap().flush()
+}
@@ -5,6 +5,7 @@ use nlog::warn;
 use physics::vec2::Vec2;
 use tinyvec::ArrayVec;
 
+pub mod cache;
 pub mod polygon;
 
 pub(crate) const TOLERANCE: f64 = 1e-6;
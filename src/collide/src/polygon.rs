@@ -1,17 +1,24 @@
-use crate::{line_circle, line_line};
+use crate::{cache, line_circle, line_line};
 use anyhow::Result;
-use fs_err as fs;
 use image::GenericImageView;
 use itertools::Itertools;
 use nalgebra::Vector2;
 use nlog::{warn, warn_err};
+use rayon::prelude::*;
 use serde::{Deserialize, Serialize};
+use std::cell::RefCell;
 use std::collections::VecDeque;
 use std::path::Path;
 use tinyvec::ArrayVec;
 
 const ALPHA_THRESHOLD: u8 = 50;
 
+thread_local! {
+    /// Scratch buffer for the edges of the other polygon in [`Polygon::intersect_polygon`].
+    static EDGES: RefCell<Vec<(Vector2<f64>, Vector2<f64>, Aabb)>> =
+        const { RefCell::new(Vec::new()) };
+}
+
 #[derive(Debug, PartialEq, Serialize, Deserialize, Clone)]
 pub struct Polygon {
    /// The points in the polygon.
@@ -24,6 +31,8 @@ pub struct Polygon {
    pub ymin: f64,
    /// Maximum y value of the AABB
    pub ymax: f64,
+   /// Radius of the bounding circle centered on the origin
+   pub radius: f64,
    pub start: Option<Vector2<i32>>,
 }
 
@@ -33,11 +42,13 @@ impl Polygon {
       let mut xmax = -f64::INFINITY;
       let mut ymin = f64::INFINITY;
       let mut ymax = -f64::INFINITY;
+      let mut radius2: f64 = 0.0;
       for p in &points {
          xmin = xmin.min(p.x);
          xmax = xmax.max(p.x);
          ymin = ymin.min(p.y);
          ymax = ymax.max(p.y);
+         radius2 = radius2.max(p.norm_squared());
       }
       Polygon {
          points,
@@ -45,6 +56,7 @@ impl Polygon {
          xmax,
          ymin,
          ymax,
+         radius: radius2.sqrt(),
          start,
       }
    }
@@ -244,6 +256,12 @@ impl Polygon {
    ) -> ArrayVec<[Vector2<f64>; 2]> {
       let mut hit = ArrayVec::new();
 
+      // Bounding circle testing
+      let rsum = self.radius + radius;
+      if centre.norm_squared() > rsum * rsum {
+         return hit;
+      }
+
       // AABB testing
       let r2 = radius * radius;
       let cx = centre.x.clamp(self.xmin, self.xmax);
@@ -286,6 +304,12 @@ impl Polygon {
       other: &Polygon,
       rel: Vector2<f64>,
    ) -> ArrayVec<[Vector2<f64>; 2]> {
+      // Bounding circle test
+      let rsum = self.radius + other.radius;
+      if rel.norm_squared() > rsum * rsum {
+         return ArrayVec::new();
+      }
+
       // AABB test
       let oxmin = other.xmin + rel.x;
       let oxmax = other.xmax + rel.x;
@@ -295,18 +319,54 @@ impl Polygon {
          return ArrayVec::new();
       }
 
+      // Only edges touching the region where both AABB overlap can intersect, so we can discard
+      // most edges before doing any pairwise testing. Order is kept so that the hits are the same
+      // as when testing every edge pair.
+      let region = Aabb {
+         xmin: self.xmin.max(oxmin) - crate::TOLERANCE,
+         xmax: self.xmax.min(oxmax) + crate::TOLERANCE,
+         ymin: self.ymin.max(oymin) - crate::TOLERANCE,
+         ymax: self.ymax.min(oymax) + crate::TOLERANCE,
+      };
       // Test edge vs edge
       let mut hit = ArrayVec::new();
-      for (s1, e1) in self.points.iter().circular_tuple_windows() {
-         for (s2, e2) in other.points.iter().circular_tuple_windows() {
-            let h = line_line(*s1, *e1, *s2 + rel, *e2 + rel);
-            if let Some(h) = h.first() {
-               hit.push(*h);
-               if hit.is_full() {
-                  return hit;
+      EDGES.with_borrow_mut(|others| {
+         others.clear();
+         others.extend(
+            other
+               .points
+               .iter()
+               .circular_tuple_windows()
+               .filter_map(|(s2, e2)| {
+                  let (s2, e2) = (*s2 + rel, *e2 + rel);
+                  let bb = Aabb::from_segment(s2, e2);
+                  bb.overlaps(&region).then_some((s2, e2, bb))
+               }),
+         );
+         if others.is_empty() {
+            return;
+         }
+         for (s1, e1) in self.points.iter().circular_tuple_windows() {
+            let bb = Aabb::from_segment(*s1, *e1);
+            if !bb.overlaps(&region) {
+               continue;
+            }
+            for (s2, e2, obb) in others.iter() {
+               if !bb.overlaps(obb) {
+                  continue;
+               }
+               let h = line_line(*s1, *e1, *s2, *e2);
+               if let Some(h) = h.first() {
+                  hit.push(*h);
+                  if hit.is_full() {
+                     return;
+                  }
                }
             }
          }
+      });
+      if hit.is_full() {
+         return hit;
       }
 
       // Test to see if one is inside the other
@@ -323,7 +383,35 @@ impl Polygon {
    }
 }
 
-#[derive(Debug, Serialize, Deserialize)]
+/// Simple axis-aligned bounding box used for broad-phase tests.
+#[derive(Debug, Clone, Copy)]
+struct Aabb {
+   xmin: f64,
+   xmax: f64,
+   ymin: f64,
+   ymax: f64,
+}
+
+impl Aabb {
+   fn from_segment(s: Vector2<f64>, e: Vector2<f64>) -> Self {
+      Aabb {
+         xmin: s.x.min(e.x),
+         xmax: s.x.max(e.x),
+         ymin: s.y.min(e.y),
+         ymax: s.y.max(e.y),
+      }
+   }
+
+   /// Inclusive overlap test, touching boxes count as overlapping.
+   fn overlaps(&self, other: &Aabb) -> bool {
+      self.xmin <= other.xmax
+         && self.xmax >= other.xmin
+         && self.ymin <= other.ymax
+         && self.ymax >= other.ymin
+   }
+}
+
+#[derive(Debug, PartialEq, Serialize, Deserialize)]
 pub struct SpinPolygon {
    /// The different collision polygons for each of the view starting at dir_off and incrementing
    /// by dir_inc.
@@ -335,6 +423,14 @@ pub struct SpinPolygon {
 }
 
 impl SpinPolygon {
+   pub fn new(polygons: Vec<Polygon>, dir_inc: f64, dir_off: f64) -> Self {
+      SpinPolygon {
+         polygons,
+         dir_inc,
+         dir_off,
+      }
+   }
+
    pub fn from_image_path<P: AsRef<Path>>(path: P, sx: u32, sy: u32) -> Result<Self> {
       let path = ndata::image_path(&path)?;
       let stats = ndata::stat(&path)?;
@@ -342,10 +438,7 @@ impl SpinPolygon {
       hasher.update(path.as_ref().as_os_str().as_encoded_bytes());
       hasher.update(&stats.modtime.to_ne_bytes());
       let hash = hasher.finalize();
-      let cache_path = ndata::cache_dir().join(format!("collisions/{hash}"));
-      if let Ok(data) = fs::read(&cache_path)
-         && let Ok(poly) = bitcode::deserialize::<SpinPolygon>(&data)
-      {
+      if let Some(poly) = cache::load::<SpinPolygon>(&hash) {
          return Ok(poly);
       }
 
@@ -356,7 +449,7 @@ impl SpinPolygon {
       )
       .decode()?;
       let poly = SpinPolygon::from_image(&img, sx, sy);
-      fs::write(&cache_path, bitcode::serialize(&poly)?)?;
+      cache::store(&hash, &poly)?;
 
       Ok(poly)
    }
@@ -373,27 +466,21 @@ impl SpinPolygon {
          );
       }
 
-      let mut polygons = Vec::new();
+      // Each frame is independent, so we can trace them all in parallel
       let bimg = img.fast_blur(1.0);
-      for y in 0..sy {
-         for x in 0..sx {
-            let dir = (y * sx + x) as f64 / (sx * sy) as f64 * -std::f64::consts::TAU;
-
-            let poly = Polygon::from_subimage(&bimg, x * sw, y * sh, sw, sh, dir);
-            polygons.push(poly);
-            // let p: Vec<_> = poly.points.iter().map( |p| imageproc::point::Point::new( (x*sw + p.x as u32) as f64, (y*sh + p.y as u32) as f64 ) ).collect();
-            //imageproc::drawing::draw_hollow_polygon_mut(&mut img, &p, image::Rgba::<u8>([255, 0, 0,255]));
-         }
-      }
+      let mut polygons: Vec<Polygon> = (0..sx * sy)
+         .into_par_iter()
+         .map(|i| {
+            let (x, y) = (i % sx, i / sx);
+            let dir = i as f64 / (sx * sy) as f64 * -std::f64::consts::TAU;
+            Polygon::from_subimage(&bimg, x * sw, y * sh, sw, sh, dir)
+         })
+         .collect();
       let dir_inc = 1.0 / (sx * sy) as f64 * std::f64::consts::TAU;
       let dir_off = -dir_inc * 0.5;
       polygons.reverse();
 
-      SpinPolygon {
-         polygons,
-         dir_inc,
-         dir_off,
-      }
+      SpinPolygon::new(polygons, dir_inc, dir_off)
    }
 
    pub fn view(&self, dir: f64) -> &Polygon {
@@ -673,6 +760,7 @@ mod tests {
             xmax: 3.0 - c.x,
             ymin: 1.0 - c.y,
             ymax: 3.0 - c.y,
+            radius: (c - v(1.0, 1.0)).norm(),
             start: Some(Vector2::new(1, 1)),
          }
       );
@@ -1088,4 +1176,232 @@ mod tests {
       let p = poly.intersect_circle(v(1.0, 1.0), 1.0);
       assert_eq!(p.len(), 2);
    }
+
+   /// Generates a sprite sheet with a differently shaped blob in each frame.
+   fn sprite_sheet(sx: u32, sy: u32, size: u32) -> image::DynamicImage {
+      let img = image::RgbaImage::from_fn(sx * size, sy * size, |x, y| {
+         let (fx, fy) = (x % size, y % size);
+         let frame = (y / size) * sx + x / size;
+         let c = size as f64 * 0.5;
+         let (dx, dy) = (fx as f64 - c, fy as f64 - c);
+         let r = c * 0.4 + frame as f64 * 0.5;
+         if dx * dx * 1.5 + dy * dy <= r * r {
+            image::Rgba([255, 255, 255, 255])
+         } else {
+            image::Rgba([0, 0, 0, 0])
+         }
+      });
+      image::DynamicImage::ImageRgba8(img)
+   }
+
+   #[test]
+   fn spinpolygon_parallel_matches_serial() {
+      let (sx, sy, size) = (4, 2, 32);
+      let img = sprite_sheet(sx, sy, size);
+      let poly = SpinPolygon::from_image(&img, sx, sy);
+
+      let bimg = img.fast_blur(1.0);
+      let mut serial = Vec::new();
+      for y in 0..sy {
+         for x in 0..sx {
+            let dir = (y * sx + x) as f64 / (sx * sy) as f64 * -std::f64::consts::TAU;
+            serial.push(Polygon::from_subimage(
+               &bimg,
+               x * size,
+               y * size,
+               size,
+               size,
+               dir,
+            ));
+         }
+      }
+      serial.reverse();
+      assert_eq!(poly.polygons, serial);
+   }
+
+   #[test]
+   fn spinpolygon_packed_cache() {
+      let dir = std::env::temp_dir().join(format!("naev-collide-{}", std::process::id()));
+      std::fs::create_dir_all(&dir).unwrap();
+
+      let polys: Vec<(blake3::Hash, SpinPolygon)> = (1..4)
+         .map(|n| {
+            let hash = blake3::hash(&n.to_ne_bytes());
+            (hash, SpinPolygon::from_image(&sprite_sheet(n, n, 24), n, n))
+         })
+         .collect();
+
+      // Per-file cache as was done before
+      for (hash, poly) in &polys {
+         std::fs::write(
+            dir.join(hash.to_string()),
+            bitcode::serialize(poly).unwrap(),
+         )
+         .unwrap();
+      }
+      // Packed cache, written in two goes to test merging
+      let pack_path = dir.join("collisions.pack");
+      for chunk in polys.chunks(2) {
+         let mut pack = cache::PackedCache::open(&pack_path);
+         for (hash, poly) in chunk {
+            pack.insert(*hash.as_bytes(), bitcode::serialize(poly).unwrap());
+         }
+         pack.flush().unwrap();
+      }
+
+      let pack = cache::PackedCache::open(&pack_path);
+      for (hash, poly) in &polys {
+         let file = std::fs::read(dir.join(hash.to_string())).unwrap();
+         let file: SpinPolygon = bitcode::deserialize(&file).unwrap();
+         let packed: SpinPolygon =
+            bitcode::deserialize(pack.get(hash.as_bytes()).unwrap()).unwrap();
+         assert_eq!(&file, poly);
+         assert_eq!(file, packed);
+      }
+      assert!(pack.get(blake3::hash(b"missing").as_bytes()).is_none());
+
+      std::fs::remove_dir_all(&dir).unwrap();
+   }
+
+   /// Reference implementation testing every edge pair.
+   fn intersect_polygon_brute(
+      a: &Polygon,
+      b: &Polygon,
+      rel: Vector2<f64>,
+   ) -> ArrayVec<[Vector2<f64>; 2]> {
+      let mut hit = ArrayVec::new();
+      for (s1, e1) in a.points.iter().circular_tuple_windows() {
+         for (s2, e2) in b.points.iter().circular_tuple_windows() {
+            if let Some(h) = line_line(*s1, *e1, *s2 + rel, *e2 + rel).first() {
+               hit.push(*h);
+               if hit.is_full() {
+                  return hit;
+               }
+            }
+         }
+      }
+      let p_other = b.points[0] + rel;
+      if a.contains_point(p_other) {
+         hit.push(p_other);
+         return hit;
+      }
+      if b.contains_point(a.points[0] - rel) {
+         hit.push(a.points[0]);
+      }
+      hit
+   }
+
+   /// Simple LCG to have reproducible random numbers in [0, 1).
+   fn rng(mut seed: u64) -> impl FnMut() -> f64 {
+      move || {
+         seed = seed
+            .wrapping_mul(6364136223846793005)
+            .wrapping_add(1442695040888963407);
+         (seed >> 11) as f64 / (1u64 << 53) as f64
+      }
+   }
+
+   #[test]
+   fn polygon_polygon_broadphase() {
+      let a = SpinPolygon::from_image(&sprite_sheet(4, 4, 48), 4, 4);
+      let b = SpinPolygon::from_image(&sprite_sheet(3, 3, 32), 3, 3);
+      let mut rnd = rng(1337);
+      let mut hits = 0;
+      for _ in 0..2000 {
+         let pa = a.view(rnd() * std::f64::consts::TAU);
+         let pb = b.view(rnd() * std::f64::consts::TAU);
+         let rel = v(rnd() * 80.0 - 40.0, rnd() * 80.0 - 40.0);
+         let fast = pa.intersect_polygon(pb, rel);
+         let brute = intersect_polygon_brute(pa, pb, rel);
+         if rel.norm() > pa.radius + pb.radius {
+            assert!(fast.is_empty());
+         }
+         assert_eq!(fast, brute);
+         if !fast.is_empty() {
+            hits += 1;
+         }
+      }
+      // Make sure we are actually testing collisions
+      assert!(hits > 100);
+   }
+
+   /// Times collide_polygon_polygon against testing every edge pair on the polygons of real ships.
+   /// It uses the collision cache written by the game, so run the game once and then run:
+   ///
+   /// NAEV_COLLISION_PACK=<cache directory>/collisions.pack cargo test --release -p collide \
+   ///    polygon_polygon_bench -- --ignored --nocapture
+   #[test]
+   #[ignore]
+   fn polygon_polygon_bench() {
+      const PAIRS: usize = 100_000;
+      const REPS: usize = 5;
+
+      let path = std::env::var_os("NAEV_COLLISION_PACK")
+         .expect("NAEV_COLLISION_PACK has to be set to the collisions.pack of the game cache");
+      let pack = cache::PackedCache::open(path);
+      let polys: Vec<SpinPolygon> = pack
+         .mapped_values()
+         .filter_map(|d| bitcode::deserialize(d).ok())
+         .collect();
+      assert!(
+         !polys.is_empty(),
+         "no polygons found in the collision cache"
+      );
+
+      // Random pairs of views, up to 1.5 times as far as their bounding circles can touch, so
+      // there is a mix of broad-phase rejections and edge tests like with pilots and weapons
+      let mut rnd = rng(1337);
+      let pairs: Vec<(&Polygon, &Polygon, Vector2<f64>, Vector2<f64>)> = (0..PAIRS)
+         .map(|_| {
+            let a = &polys[(rnd() * polys.len() as f64) as usize];
+            let b = &polys[(rnd() * polys.len() as f64) as usize];
+            let pa = a.view(rnd() * std::f64::consts::TAU);
+            let pb = b.view(rnd() * std::f64::consts::TAU);
+            let ap = v(rnd() * 1e4, rnd() * 1e4);
+            let dist = rnd() * 1.5 * (pa.radius + pb.radius);
+            let dir = rnd() * std::f64::consts::TAU;
+            (pa, pb, ap, ap + v(dir.cos(), dir.sin()) * dist)
+         })
+         .collect();
+
+      let broadphase = |pa: &Polygon, ap: &Vector2<f64>, pb: &Polygon, bp: &Vector2<f64>| {
+         let mut crash = [Vector2::zeros(); 2];
+         collide_polygon_polygon(pa, ap, pb, bp, crash.as_mut_ptr()) as usize
+      };
+      let brute = |pa: &Polygon, ap: &Vector2<f64>, pb: &Polygon, bp: &Vector2<f64>| {
+         intersect_polygon_brute(pa, pb, *bp - *ap).len()
+      };
+
+      // Both have to agree before comparing times
+      let mut hits = 0;
+      for &(pa, pb, ap, bp) in &pairs {
+         let n = broadphase(pa, &ap, pb, &bp);
+         assert_eq!(n, brute(pa, &ap, pb, &bp));
+         hits += (n > 0) as usize;
+      }
+
+      let time = |f: &dyn Fn(&Polygon, &Vector2<f64>, &Polygon, &Vector2<f64>) -> usize| {
+         (0..REPS)
+            .map(|_| {
+               let start = std::time::Instant::now();
+               for &(pa, pb, ap, bp) in &pairs {
+                  std::hint::black_box(f(pa, &ap, pb, &bp));
+               }
+               start.elapsed().as_secs_f64() * 1e9 / PAIRS as f64
+            })
+            .fold(f64::INFINITY, f64::min)
+      };
+      let t_broadphase = time(&broadphase);
+      let t_brute = time(&brute);
+      println!(
+         "{} ship polygons, {PAIRS} pairs, {:.1}% colliding",
+         polys.len(),
+         100.0 * hits as f64 / PAIRS as f64
+      );
+      println!("every edge pair: {t_brute:.1} ns per test");
+      println!(
+         "broad-phase:     {t_broadphase:.1} ns per test ({:.1}x)",
+         t_brute / t_broadphase
+      );
+   }
 }
@@ -111,6 +111,14 @@ static void print_usage( void )
    LOG( _( "   -X, --scale           defines the scale factor" ) );
    LOG(
       _( "   --devmode             enables dev mode perks like the editors" ) );
+   LOG( _( "   --record f            records the session to f in the write "
+           "directory" ) );
+   LOG( _( "   --replay f            replays the recording f without rendering "
+           "and quits" ) );
+   LOG( _( "   --recordframes n      stops recording and quits after n "
+           "frames" ) );
+   LOG( _( "   --bench-lua f         runs the Lua benchmark f without rendering "
+           "and quits" ) );
    LOG( _( "   -h, --help            display this message and exit" ) );
    LOG( _( "   -v, --version         print the version and exit" ) );
 }
@@ -264,6 +272,10 @@ void conf_setVideoDefaults( void )
    conf.gamma_correction    = GAMMA_CORRECTION_DEFAULT;
    conf.low_memory          = LOW_MEMORY_DEFAULT;
    conf.max_3d_tex_size     = MAX_3D_TEX_SIZE;
+   conf.texture_cache       = TEXTURE_CACHE_DEFAULT;
+   conf.gfx_budget          = GFX_BUDGET_DEFAULT;
+   conf.sim_lod             = SIM_LOD_DEFAULT;
+   conf.outfit_batch        = OUTFIT_BATCH_DEFAULT;
 
    if ( cur_system )
       background_load( cur_system->background );
@@ -377,6 +389,10 @@ int conf_loadConfig( const char *file )
    conf_loadFloat( L, "gamma_correction", conf.gamma_correction );
    conf_loadBool( L, "low_memory", conf.low_memory );
    conf_loadInt( L, "max_3d_tex_size", conf.max_3d_tex_size );
+   conf_loadBool( L, "texture_cache", conf.texture_cache );
+   conf_loadInt( L, "gfx_budget", conf.gfx_budget );
+   conf_loadBool( L, "sim_lod", conf.sim_lod );
+   conf_loadBool( L, "outfit_batch", conf.outfit_batch );
    conf_loadBool( L, "disable_screen_shake", conf.disable_screen_shake );
 
    /* FPS */
@@ -605,6 +621,10 @@ int conf_parseCLI( int argc, char **argv )
       { "help", no_argument, 0, 'h' },
       { "version", no_argument, 0, 'v' },
       { "exitmainmenu", no_argument, 0, '\e' },
+      { "record", required_argument, 0, 'r' },
+      { "replay", required_argument, 0, 'R' },
+      { "recordframes", required_argument, 0, 'T' },
+      { "bench-lua", required_argument, 0, 'b' },
       { NULL, 0, 0, 0 } };
    int option_index = 1;
    int c            = 0;
@@ -671,6 +691,21 @@ int conf_parseCLI( int argc, char **argv )
       case '\e':
          conf.exit_main_menu = 1;
          break;
+      case 'r':
+         free( conf.record );
+         conf.record = strdup( optarg );
+         break;
+      case 'R':
+         free( conf.replay );
+         conf.replay = strdup( optarg );
+         break;
+      case 'T':
+         conf.record_frames = atoi( optarg );
+         break;
+      case 'b':
+         free( conf.bench_lua );
+         conf.bench_lua = strdup( optarg );
+         break;
 
       case 'v':
          /* by now it has already displayed the version */
@@ -1049,6 +1084,34 @@ int conf_saveConfig( const char *file )
    conf_saveInt( "max_3d_tex_size", conf.max_3d_tex_size, MAX_3D_TEX_SIZE );
    conf_saveEmptyLine();
 
+   conf_saveComment(
+      _( "Stores decoded textures in the cache directory so that they do not "
+         "have to be decoded again on start up. Uses more disk space, and "
+         "entries of changed or removed images are never pruned, so the "
+         "textures cache directory keeps growing as the data changes and may "
+         "have to be deleted by hand." ) );
+   conf_saveBool( "texture_cache", conf.texture_cache, TEXTURE_CACHE_DEFAULT );
+   conf_saveEmptyLine();
+
+   conf_saveComment(
+      _( "Memory budget in MiB for ship and outfit graphics. When exceeded, "
+         "the least recently used graphics are freed when entering a system "
+         "and loaded again when needed. 0 means unlimited." ) );
+   conf_saveInt( "gfx_budget", conf.gfx_budget, GFX_BUDGET_DEFAULT );
+   conf_saveEmptyLine();
+
+   conf_saveComment(
+      _( "Lets pilots far away from the player and outside of sensor range "
+         "think less often. Improves performance in crowded systems." ) );
+   conf_saveBool( "sim_lod", conf.sim_lod, SIM_LOD_DEFAULT );
+   conf_saveEmptyLine();
+
+   conf_saveComment(
+      _( "Runs the updates of outfits that support it for all the pilots at "
+         "once. Improves performance with many pilots." ) );
+   conf_saveBool( "outfit_batch", conf.outfit_batch, OUTFIT_BATCH_DEFAULT );
+   conf_saveEmptyLine();
+
    /* FPS */
    conf_saveComment( _( "Display a frame rate counter" ) );
    conf_saveBool( "showfps", conf.fps_show, FPS_SHOW_DEFAULT );
@@ -1377,6 +1440,9 @@ void conf_copy( PlayerConf_t *dest, const PlayerConf_t *src )
    STRDUP( joystick_nam );
    STRDUP( lastversion );
    STRDUP( dev_data_dir );
+   STRDUP( record );
+   STRDUP( replay );
+   STRDUP( bench_lua );
    if ( src->difficulty != NULL )
       STRDUP( difficulty );
 #undef STRDUP
@@ -1394,6 +1460,9 @@ void conf_free( PlayerConf_t *config )
    free( config->lastversion );
    free( config->dev_data_dir );
    free( config->difficulty );
+   free( config->record );
+   free( config->replay );
+   free( config->bench_lua );
 
    /* Clear memory. */
    memset( config, 0, sizeof( PlayerConf_t ) );
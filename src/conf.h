@@ -82,6 +82,10 @@
 #define FONT_SIZE_SMALL_DEFAULT 11   /**< Default small font size. */
 #define LOW_MEMORY_DEFAULT 0         /**< Default for low memory mode. */
 #define MAX_3D_TEX_SIZE 256          /**< Maximum 3D texture size. */
+#define TEXTURE_CACHE_DEFAULT 0      /**< Whether to cache decoded textures. */
+#define GFX_BUDGET_DEFAULT 0         /**< Graphics memory budget in MiB. */
+#define SIM_LOD_DEFAULT 1            /**< Reduced detail for distant pilots. */
+#define OUTFIT_BATCH_DEFAULT 1       /**< Batched outfit updates. */
 #define ALWAYS_RADAR_DEFAULT 0
 #define SHOW_VIEWPORT_DEFAULT 0
 #define DEVMODE_DEFAULT 0
@@ -148,6 +152,11 @@ typedef struct PlayerConf_s {
    int    low_memory;       /**< Low memory mode. */
    int max_3d_tex_size; /**< How large to make the textures in low memory mode.
                          */
+   int texture_cache; /**< Whether to cache decoded texture data on disk. */
+   int gfx_budget;   /**< Memory budget for ship and outfit graphics in MiB,
+                        0 is unlimited. */
+   int sim_lod;      /**< Whether to think distant pilots at a reduced rate. */
+   int outfit_batch; /**< Whether to batch outfit updates that support it. */
    int
       disable_screen_shake; /**< Disables effects like damage or afterburner. */
 
@@ -227,7 +236,11 @@ typedef struct PlayerConf_s {
    char *dev_data_dir; /**< Path where most data should be. */
 
    // Special
-   int exit_main_menu;
+   int   exit_main_menu;
+   char *record;        /**< File to record the session to. */
+   char *replay;        /**< Recording to replay. */
+   int   record_frames; /**< Frames to record before quitting, 0 for no limit. */
+   char *bench_lua;     /**< Lua benchmark to run headless. */
 } PlayerConf_t;
 extern PlayerConf_t conf; /**< Player configuration. */
 
@@ -14,6 +14,8 @@
 #include <lualib.h>
 #include <stdlib.h>
 
+#include "physfs.h"
+
 #include "naev.h"
 /** @endcond */
 
@@ -35,6 +37,7 @@
 #include "nlua_tex.h"
 #include "nlua_tk.h"
 #include "nluadef.h"
+#include "profiler.h"
 #include "toolkit.h"
 
 #define BUTTON_WIDTH 50  /**< Button width. */
@@ -72,8 +75,13 @@ static int    cli_max_lines  = 0;
  * CLI stuff.
  */
 static int            cli_script( lua_State *L );
+static int            cli_profiler( lua_State *L );
+static int            cli_profilerDump( lua_State *L );
 static const luaL_Reg cli_methods[] = {
-   { "script", cli_script }, { NULL, NULL } }; /**< Console only functions. */
+   { "script", cli_script },
+   { "profiler", cli_profiler },
+   { "profiler_dump", cli_profilerDump },
+   { NULL, NULL } }; /**< Console only functions. */
 
 /*
  * Prototypes.
@@ -173,6 +181,41 @@ static int cli_script( lua_State *L )
    return lua_gettop( L ) - n;
 }
 
+/**
+ * @brief Toggles the frame profiler and its overlay.
+ *
+ * Takes an optional boolean to set the state instead of toggling it, and
+ * returns whether or not the profiler is enabled.
+ */
+static int cli_profiler( lua_State *L )
+{
+   int enable = lua_isnoneornil( L, 1 ) ? !profiler_enabled
+                                        : lua_toboolean( L, 1 );
+   profiler_enable( enable );
+   lua_pushboolean( L, enable );
+   return 1;
+}
+
+/**
+ * @brief Dumps the frames recorded by the profiler to a CSV file.
+ *
+ * Takes an optional file name relative to the write directory, and returns
+ * the full path of the file written.
+ */
+static int cli_profilerDump( lua_State *L )
+{
+   const char *fname = luaL_optstring( L, 1, "profiler.csv" );
+   char        path[PATH_MAX];
+
+   if ( profiler_dump( fname ) != 0 )
+      return NLUA_ERROR( L, _( "Unable to dump profiler data to '%s'!" ),
+                         fname );
+
+   snprintf( path, sizeof( path ), "%s/%s", PHYSFS_getWriteDir(), fname );
+   lua_pushstring( L, path );
+   return 1;
+}
+
 /**
  * @brief Adds a message to the buffer.
  *
@@ -407,22 +407,28 @@ static void sysedit_editPntClose( unsigned int wid, const char *unused )
    if ( fabs( p->presence.base - fdata ) > 1e-5 ) {
       if ( uniedit_diffMode )
          sysedit_diffCreateSpobFloat( p, HUNK_TYPE_SPOB_PRESENCE_BASE, fdata );
-      else
+      else {
          p->presence.base = fdata;
+         space_presenceDirty( &p->presence );
+      }
    }
    fdata = atof( window_getInput( sysedit_widEdit, "inpPresenceBonus" ) );
    if ( fabs( p->presence.bonus - fdata ) > 1e-5 ) {
       if ( uniedit_diffMode )
          sysedit_diffCreateSpobFloat( p, HUNK_TYPE_SPOB_PRESENCE_BONUS, fdata );
-      else
+      else {
          p->presence.bonus = fdata;
+         space_presenceDirty( &p->presence );
+      }
    }
    data = atoi( window_getInput( sysedit_widEdit, "inpPresenceRange" ) );
    if ( data != p->presence.range ) {
       if ( uniedit_diffMode )
          sysedit_diffCreateSpobInt( p, HUNK_TYPE_SPOB_PRESENCE_RANGE, data );
-      else
+      else {
          p->presence.range = data;
+         space_presenceDirty( &p->presence );
+      }
    }
    fdata = atof( window_getInput( sysedit_widEdit, "inpHide" ) );
    if ( fabs( p->hide - fdata ) > 1e-5 ) {
@@ -438,7 +444,7 @@ static void sysedit_editPntClose( unsigned int wid, const char *unused )
    sysedit_tagslist = NULL;
 
    /* Have to recompute presences if stuff changed. */
-   space_reconstructPresences();
+   space_updatePresences();
 
    if ( !uniedit_diffMode ) {
       if ( conf.devautosave ) {
@@ -446,8 +452,6 @@ static void sysedit_editPntClose( unsigned int wid, const char *unused )
             uniedit_saveError();
       }
 
-      /* Clean up presences. */
-      space_reconstructPresences();
       safelanes_recalculate();
    }
 
@@ -253,6 +253,7 @@ void uniedit_open( unsigned int wid_unused, const char *unused )
          }
       }
    }
+   map_invalidate();
 
    /* Create the window. */
    wid = window_create( "wdwUniverseEditor", _( "Universe Editor" ), -1, -1, -1,
@@ -1799,6 +1800,7 @@ static void uniedit_renameSys( void )
 
          // sys->filename = newName;
          sys->name = name;
+         map_invalidate();
          dsys_saveSystem( sys );
 
          /* TODO probably have to reupdate stack?? */
@@ -1851,6 +1853,7 @@ static void uniedit_newSys( double x, double y )
    sys->pos.y     = y;
    sys->spacedust = DUST_DENSITY_DEFAULT;
    sys->radius    = RADIUS_DEFAULT;
+   map_invalidate();
 
    /* Set filename. */
    char *cleanname = uniedit_nameFilter( sys->name );
@@ -3127,6 +3130,7 @@ static void uniedit_diffSsysPos( StarSystem *s, double x, double y )
    if ( !uniedit_diffMode ) {
       s->pos.x = x;
       s->pos.y = y;
+      map_invalidate();
       return;
    }
 
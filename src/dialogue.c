@@ -30,6 +30,7 @@
 #include "menu.h"
 #include "ndata.h"
 #include "opengl.h"
+#include "replay.h"
 #include "toolkit.h"
 
 static int dialogue_open; /**< Number of dialogues open. */
@@ -1113,7 +1114,7 @@ static int toolkit_loop( int *loop_done, dialogue_update_t *du )
       /* Loop first so exit condition is checked before next iteration. */
       main_loop( 1 );
 
-      while ( !naev_isQuit() && SDL_PollEvent( &event ) ) { /* event loop */
+      while ( !naev_isQuit() && replay_pollEvent( &event ) ) { /* event loop */
          if ( event.type == SDL_EVENT_QUIT ) {
             if ( menu_askQuit() ) {
                naev_quit();    /* Quit is handled here */
@@ -50,6 +50,13 @@ static int  econ_queued      = 0; /**< Whether there are any queued updates. */
 static cs  *econ_G           = NULL; /**< Admittance matrix. */
 static int *econ_comm        = NULL; /**< Commodities to calculate. */
 
+/*
+ * Summaries of the prices known by the player.
+ */
+static unsigned int econ_knownGen =
+   1; /**< Incremented whenever the known prices may have changed. */
+static EconomyKnownPrices econ_known; /**< Known prices of a commodity. */
+
 /*
  * Prototypes.
  */
@@ -486,6 +493,7 @@ int economy_init( void )
 void economy_addQueuedUpdate( void )
 {
    econ_queued++;
+   econ_knownGen++;
 }
 
 /**
@@ -617,6 +625,13 @@ void economy_destroy( void )
    cs_spfree( econ_G );
    econ_G = NULL;
 
+   /* Clean up the known prices. */
+   free( econ_known.cnt );
+   free( econ_known.min );
+   free( econ_known.max );
+   free( econ_known.mean );
+   memset( &econ_known, 0, sizeof( EconomyKnownPrices ) );
+
    /* Economy is now deinitialized. */
    econ_initialized = 0;
 }
@@ -904,6 +919,8 @@ static void economy_calcUpdatedCommodityPrice( StarSystem *sys )
  */
 void economy_initialiseCommodityPrices( void )
 {
+   econ_knownGen++;
+
    /* First use spob attributes to set prices and variability */
    for ( int k = 0; k < array_size( systems_stack ); k++ ) {
       StarSystem *sys = &systems_stack[k];
@@ -945,14 +962,75 @@ void economy_initialiseCommodityPrices( void )
  */
 void economy_initialiseSingleSystem( StarSystem *sys, Spob *spob )
 {
+   econ_knownGen++;
    for ( int i = 0; i < array_size( spob->commodities ); i++ )
       economy_calcPrice( spob, spob->commodities[i], &spob->commodityPrice[i] );
    economy_modifySystemCommodityPrice( sys );
 }
 
+/**
+ * @brief Gets a summary of the prices of a commodity known by the player in
+ * every system.
+ *
+ * The summary is only recomputed when the commodity or the known prices
+ * change, so it can be used every frame when rendering the map.
+ *
+ *    @param com Commodity to get the known prices of.
+ *    @return The known prices, indexed by system ID.
+ */
+const EconomyKnownPrices *economy_getKnownPrices( CommodityRef com )
+{
+   EconomyKnownPrices *kp = &econ_known;
+   int                 n  = array_size( systems_stack );
+
+   if ( ( kp->com == com ) && ( kp->gen == econ_knownGen ) && ( kp->n == n ) )
+      return kp;
+
+   if ( kp->n != n ) {
+      kp->cnt  = realloc( kp->cnt, MAX( 1, n ) * sizeof( int ) );
+      kp->min  = realloc( kp->min, MAX( 1, n ) * sizeof( double ) );
+      kp->max  = realloc( kp->max, MAX( 1, n ) * sizeof( double ) );
+      kp->mean = realloc( kp->mean, MAX( 1, n ) * sizeof( double ) );
+      kp->n    = n;
+   }
+   kp->com = com;
+   kp->gen = econ_knownGen;
+
+   for ( int i = 0; i < n; i++ ) {
+      const StarSystem *sys = &systems_stack[i];
+      double            min = HUGE_VAL;
+      double            max = 0.;
+      double            sum = 0.;
+      int               cnt = 0;
+      for ( int j = 0; j < array_size( sys->spobs ); j++ ) {
+         const Spob *p = sys->spobs[j];
+         for ( int k = 0; k < array_size( p->commodities ); k++ ) {
+            const CommodityPrice *cp = &p->commodityPrice[k];
+            double                price;
+            if ( p->commodities[k] != com )
+               continue;
+            if ( cp->cnt <= 0 ) /* commodity is not known about */
+               continue;
+            price = cp->sum / cp->cnt;
+            min   = MIN( min, price );
+            max   = MAX( max, price );
+            sum += price;
+            cnt++;
+            break;
+         }
+      }
+      kp->cnt[i]  = cnt;
+      kp->min[i]  = ( cnt > 0 ) ? min : 0.;
+      kp->max[i]  = max;
+      kp->mean[i] = ( cnt > 0 ) ? sum / cnt : 0.;
+   }
+   return kp;
+}
+
 void economy_averageSeenPrices( const Spob *p )
 {
    ntime_t t = ntime_get();
+   econ_knownGen++;
    for ( int i = 0; i < array_size( p->commodities ); i++ ) {
       CommodityRef    c  = p->commodities[i];
       CommodityPrice *cp = &p->commodityPrice[i];
@@ -972,6 +1050,7 @@ void economy_averageSeenPrices( const Spob *p )
 void economy_averageSeenPricesAtTime( const Spob *p, const ntime_t tupdate )
 {
    ntime_t t = ntime_get();
+   econ_knownGen++;
    for ( int i = 0; i < array_size( p->commodities ); i++ ) {
       CommodityRef    c  = p->commodities[i];
       CommodityPrice *cp = &p->commodityPrice[i];
@@ -1010,6 +1089,7 @@ void economy_clearKnown( void )
  */
 void economy_clearSingleSpob( Spob *p )
 {
+   econ_knownGen++;
    for ( int k = 0; k < array_size( p->commodityPrice ); k++ ) {
       CommodityPrice *cp = &p->commodityPrice[k];
       cp->cnt            = 0;
@@ -1092,6 +1172,7 @@ int economy_sysLoad( xmlNodePtr parent )
          } while ( xml_nextNode( cur ) );
       }
    } while ( xml_nextNode( node ) );
+   econ_knownGen++;
    return 0;
 }
 
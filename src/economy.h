@@ -5,6 +5,22 @@
 
 #include "space.h"
 
+/**
+ * @brief Prices of a commodity known by the player in all the systems, stored
+ * by column and indexed by system ID.
+ *
+ * The prices are the means of what the player has seen at each spob.
+ */
+typedef struct EconomyKnownPrices_ {
+   CommodityRef com;  /**< Commodity the prices are of. */
+   unsigned int gen;  /**< Generation of the known prices when computed. */
+   int          n;    /**< Number of systems. */
+   int         *cnt;  /**< Number of spobs with known prices. */
+   double      *min;  /**< Lowest known spob price. */
+   double      *max;  /**< Highest known spob price. */
+   double      *mean; /**< Mean of the known spob prices. */
+} EconomyKnownPrices;
+
 /*
  * Economy stuff.
  */
@@ -22,6 +38,7 @@ void economy_clearSingleSpob( Spob *p );
  */
 int  economy_getAverageSpobPrice( CommodityRef com, const Spob *p,
                                   credits_t *mean, double *std );
+const EconomyKnownPrices *economy_getKnownPrices( CommodityRef com );
 void economy_averageSeenPrices( const Spob *p );
 void economy_averageSeenPricesAtTime( const Spob *p, const ntime_t tupdate );
 credits_t economy_getPrice( CommodityRef com, const StarSystem *sys,
@@ -76,6 +76,7 @@ static int           ship_mode          = 0; /**< Ship mode. */
 static iar_data_t iar_data[OUTFIT_TABS];  /**< Stored image array positions. */
 static Outfit **iar_outfits[OUTFIT_TABS]; /**< Outfits associated with the image
                                              array cells. */
+static OutfitAltCache eq_altCache; /**< Alt texts of the outfit list. */
 static nlua_env *autoequip_env        = NULL;
 static int       equipment_outfitMode = 0; /**< Outfit mode for filtering. */
 
@@ -389,6 +390,7 @@ void equipment_open( unsigned int wid )
       array_free( iar_outfits[i] );
    }
    memset( iar_outfits, 0, sizeof( Outfit ** ) * OUTFIT_TABS );
+   outfits_altCacheClear( &eq_altCache );
 
    /* Safe defaults. */
    equipment_lastick = SDL_GetTicks();
@@ -1984,9 +1986,9 @@ static void equipment_genOutfitList( unsigned int wid )
    /* Get the outfits. */
    noutfits = player_getOutfitsFiltered( (const Outfit ***)&iar_outfits[active],
                                          tabfilters[active], filtertext );
-   coutfits =
-      outfits_imageArrayCells( (const Outfit **)iar_outfits[active], &noutfits,
-                               ( p == NULL ) ? player.p : p, 0 );
+   coutfits = outfits_imageArrayCellsCached(
+      (const Outfit **)iar_outfits[active], &noutfits,
+      ( p == NULL ) ? player.p : p, 0, &eq_altCache );
 
    /* Create the actual image array. */
    iw       = ow - 6;
@@ -2881,6 +2883,7 @@ void equipment_cleanup( void )
    for ( int i = 0; i < OUTFIT_TABS; i++ )
       array_free( iar_outfits[i] );
    memset( iar_outfits, 0, sizeof( Outfit ** ) * OUTFIT_TABS );
+   outfits_altCacheClear( &eq_altCache );
 
    equipment_slotDeselect( &eq_wgt );
 }
@@ -534,6 +534,8 @@ impl Faction {
             HookParam::Nil,
          ];
          run_param_deferred("standing", &hparam);
+         // Map colours depend on standing
+         unsafe { naevc::map_invalidate() };
       }
    }
 
@@ -545,6 +547,8 @@ impl Faction {
    pub fn set_override(&self, std: Option<f32>) {
       let mut standing = self.standing.write().unwrap();
       standing.p_override = std;
+      // Map colours depend on standing
+      unsafe { naevc::map_invalidate() };
    }
 
    pub fn known(&self) -> bool {
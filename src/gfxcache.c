@@ -0,0 +1,281 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file gfxcache.c
+ *
+ * @brief Manages the lifetime of ship and outfit graphics.
+ *
+ * Ship and outfit store graphics are loaded on demand the first time they are
+ * used. This module keeps track of the ships that each faction spawns, so that
+ * when entering a system the ships expected from its faction presences can be
+ * preloaded in a single parallel batch instead of one at a time as pilots
+ * spawn. It also enforces an optional memory budget by freeing the least
+ * recently used graphics that are not currently in use.
+ */
+/** @cond */
+#include <SDL3/SDL_timer.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "naev.h"
+/** @endcond */
+
+#include "gfxcache.h"
+
+#include "array.h"
+#include "conf.h"
+#include "log.h"
+#include "outfit.h"
+#include "pilot.h"
+#include "player.h"
+
+#define GFXCACHE_SHIPS_PER_FACTION                                             \
+   16 /**< Maximum number of ships remembered per faction. */
+
+/**
+ * @brief Ships recently spawned by a faction.
+ */
+typedef struct GfxFactionShips_ {
+   FactionRef faction; /**< Faction the ships belong to. */
+   int       *ships;   /**< Array (array.h): Indices in the ship stack, most
+                            recent first. */
+} GfxFactionShips;
+
+/**
+ * @brief Graphics that can be evicted.
+ */
+typedef struct GfxCandidate_ {
+   Ship    *ship;   /**< Ship to free graphics of, or NULL if outfit. */
+   Outfit  *outfit; /**< Outfit to free store graphics of, or NULL if ship. */
+   uint64_t used;   /**< Last time the graphics were used. */
+   size_t   mem;    /**< Estimated memory usage in bytes. */
+} GfxCandidate;
+
+static GfxFactionShips *gfxcache_factions =
+   NULL; /**< Array (array.h): Ships spawned per faction. */
+
+/**
+ * @brief Gets the spawn record of a faction.
+ */
+static GfxFactionShips *gfxcache_getFaction( FactionRef faction )
+{
+   for ( int i = 0; i < array_size( gfxcache_factions ); i++ )
+      if ( gfxcache_factions[i].faction == faction )
+         return &gfxcache_factions[i];
+   return NULL;
+}
+
+/**
+ * @brief Records that a faction spawned a ship, so that it can be preloaded
+ * the next time the faction is present in a system.
+ *
+ *    @param faction Faction of the pilot that was spawned.
+ *    @param ship Ship of the pilot that was spawned.
+ */
+void gfxcache_recordSpawn( FactionRef faction, const Ship *ship )
+{
+   GfxFactionShips *fs;
+   int              id = ship - ship_getAll();
+
+   if ( gfxcache_factions == NULL )
+      gfxcache_factions = array_create( GfxFactionShips );
+
+   fs = gfxcache_getFaction( faction );
+   if ( fs == NULL ) {
+      fs          = &array_grow( &gfxcache_factions );
+      fs->faction = faction;
+      fs->ships   = array_create_size( int, 1 );
+   }
+
+   /* Already the most recent one, which is the common case. */
+   if ( ( array_size( fs->ships ) > 0 ) && ( fs->ships[0] == id ) )
+      return;
+
+   /* Remove if already there, or drop the oldest one if full. */
+   for ( int i = 0; i < array_size( fs->ships ); i++ ) {
+      if ( fs->ships[i] == id ) {
+         array_erase( &fs->ships, &fs->ships[i], &fs->ships[i + 1] );
+         break;
+      }
+   }
+   if ( array_size( fs->ships ) >= GFXCACHE_SHIPS_PER_FACTION )
+      array_erase( &fs->ships, array_end( fs->ships ) - 1,
+                   array_end( fs->ships ) );
+
+   /* Add as most recent. */
+   array_push_back( &fs->ships, id );
+   memmove( &fs->ships[1], &fs->ships[0],
+            ( array_size( fs->ships ) - 1 ) * sizeof( int ) );
+   fs->ships[0] = id;
+}
+
+/**
+ * @brief Loads the graphics of the ships that are expected to spawn in a
+ * system.
+ *
+ * The ships are those previously spawned by the factions with presence in the
+ * system. All the graphics are loaded together right away so that 3D models
+ * can be loaded in parallel, which is why this should be called when entering
+ * the system.
+ *
+ *    @param sys System to preload ship graphics for.
+ */
+void gfxcache_preload( const StarSystem *sys )
+{
+   Ship    *ship_stack = ship_getAll();
+   uint64_t now        = SDL_GetTicks();
+   int      n          = 0;
+
+   for ( int i = 0; i < array_size( sys->presence ); i++ ) {
+      const SystemPresence  *sp = &sys->presence[i];
+      const GfxFactionShips *fs;
+      if ( sp->value <= 0. )
+         continue;
+      fs = gfxcache_getFaction( sp->faction );
+      if ( fs == NULL )
+         continue;
+      for ( int j = 0; j < array_size( fs->ships ); j++ ) {
+         Ship *s     = &ship_stack[fs->ships[j]];
+         s->gfx_used = now;
+         if ( ship_gfxLoaded( s ) )
+            continue;
+         ship_setFlag( s, SHIP_NEEDSGFX );
+         n++;
+      }
+   }
+
+   if ( n > 0 ) {
+      ship_gfxLoadNeeded();
+      DEBUG( n_( "Preloaded graphics of %d ship in %.3f s",
+                 "Preloaded graphics of %d ships in %.3f s", n ),
+             n, ( SDL_GetTicks() - now ) / 1000. );
+   }
+}
+
+/**
+ * @brief Compares eviction candidates so that the least recently used are
+ * first.
+ */
+static int gfxcache_cmp( const void *p1, const void *p2 )
+{
+   const GfxCandidate *c1 = p1;
+   const GfxCandidate *c2 = p2;
+   if ( c1->used < c2->used )
+      return -1;
+   else if ( c1->used > c2->used )
+      return +1;
+   return 0;
+}
+
+/**
+ * @brief Marks a ship as being in use.
+ */
+static void gfxcache_markUsed( int *inuse, const Pilot *p )
+{
+   const Ship *ship_stack = ship_getAll();
+   if ( ( p == NULL ) || ( p->ship == NULL ) )
+      return;
+   inuse[p->ship - ship_stack] = 1;
+}
+
+/**
+ * @brief Frees the least recently used graphics until memory usage is below
+ * the budget.
+ *
+ * Graphics of ships used by pilots or the player's fleet are never freed.
+ * Freed graphics are loaded again on demand.
+ */
+void gfxcache_evict( void )
+{
+   Ship               *ship_stack;
+   Outfit             *outfit_stack;
+   const PlayerShip_t *pships;
+   GfxCandidate       *candidates;
+   Pilot *const       *pilot_stack;
+   int                *inuse;
+   size_t              budget, total, freed;
+   uint64_t            now;
+   int                 n;
+
+   if ( conf.gfx_budget <= 0 )
+      return;
+   budget = (size_t)conf.gfx_budget * 1024 * 1024;
+   now    = SDL_GetTicks();
+
+   /* Mark ships that are in use. */
+   ship_stack  = ship_getAll();
+   inuse       = calloc( array_size( ship_stack ), sizeof( int ) );
+   pilot_stack = pilot_getAll();
+   for ( int i = 0; i < array_size( pilot_stack ); i++ )
+      gfxcache_markUsed( inuse, pilot_stack[i] );
+   gfxcache_markUsed( inuse, player.ps.p );
+   pships = player_getShipStack();
+   for ( int i = 0; i < array_size( pships ); i++ )
+      gfxcache_markUsed( inuse, pships[i].p );
+
+   /* Gather all the loaded graphics. */
+   total      = 0;
+   candidates = array_create( GfxCandidate );
+   for ( int i = 0; i < array_size( ship_stack ); i++ ) {
+      Ship  *s = &ship_stack[i];
+      size_t mem;
+      if ( !ship_gfxLoaded( s ) )
+         continue;
+      mem = ship_gfxMemory( s );
+      total += mem;
+      if ( inuse[i] ) {
+         s->gfx_used = now;
+         continue;
+      }
+      GfxCandidate c = { .ship = s, .used = s->gfx_used, .mem = mem };
+      array_push_back( &candidates, c );
+   }
+   outfit_stack = outfit_getAll_rust();
+   for ( int i = 0; i < array_size( outfit_stack ); i++ ) {
+      Outfit *o = &outfit_stack[i];
+      size_t  mem;
+      if ( !outfit_gfxStoreLoaded( o ) )
+         continue;
+      mem = tex_memory( o->gfx_store );
+      total += mem;
+      GfxCandidate c = { .outfit = o, .used = o->gfx_store_used, .mem = mem };
+      array_push_back( &candidates, c );
+   }
+   free( inuse );
+
+   /* Free the least recently used until we are under budget. */
+   qsort( candidates, array_size( candidates ), sizeof( GfxCandidate ),
+          gfxcache_cmp );
+   n     = 0;
+   freed = 0;
+   for ( int i = 0; ( i < array_size( candidates ) ) && ( total > budget );
+         i++ ) {
+      const GfxCandidate *c = &candidates[i];
+      if ( c->ship != NULL )
+         ship_gfxFree( c->ship );
+      else
+         outfit_gfxStoreFree( c->outfit );
+      total -= c->mem;
+      freed += c->mem;
+      n++;
+   }
+   array_free( candidates );
+
+   if ( n > 0 )
+      DEBUG( n_( "Evicted %d graphic (%.1f MiB), %.1f MiB in use",
+                 "Evicted %d graphics (%.1f MiB), %.1f MiB in use", n ),
+             n, (double)freed / ( 1024. * 1024. ),
+             (double)total / ( 1024. * 1024. ) );
+}
+
+/**
+ * @brief Cleans up the graphics cache.
+ */
+void gfxcache_exit( void )
+{
+   for ( int i = 0; i < array_size( gfxcache_factions ); i++ )
+      array_free( gfxcache_factions[i].ships );
+   array_free( gfxcache_factions );
+   gfxcache_factions = NULL;
+}
@@ -0,0 +1,13 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+#include "faction.h"
+#include "ship.h"
+#include "space.h"
+
+void gfxcache_recordSpawn( FactionRef faction, const Ship *ship );
+void gfxcache_preload( const StarSystem *sys );
+void gfxcache_evict( void );
+void gfxcache_exit( void );
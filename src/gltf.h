@@ -74,3 +74,4 @@ vec3         gltf_trailPosition( const GltfObject *obj, int id );
 unsigned int gltf_numMounts( const GltfObject *obj );
 unsigned int gltf_mountIndex( const GltfObject *obj, int id );
 vec3         gltf_mountPosition( const GltfObject *obj, int id );
+size_t       gltf_memory( const GltfObject *obj );
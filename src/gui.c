@@ -57,6 +57,35 @@ static double animation_dt = 0.; /**< Used for animations. */
 /* for VBO. */
 static gl_vbo *gui_radar_select_vbo = NULL;
 
+/**
+ * @brief Instance data of a batched radar marker.
+ */
+typedef struct RadarMarker_ {
+   GLfloat marker[4]; /**< Position, size and rotation. */
+   GLfloat colour[4]; /**< Colour of the marker. */
+} RadarMarker;
+
+/**
+ * @brief Instanced version of a radar marker shader.
+ */
+typedef struct RadarBatch_ {
+   GLuint       program;       /**< Program compiled with RADAR_BATCH. */
+   GLint        projection;    /**< Projection uniform. */
+   GLint        radar_radius;  /**< Circle clipping radius uniform. */
+   GLint        vertex;        /**< Vertex attribute. */
+   GLint        marker;        /**< Marker instance attribute. */
+   GLint        marker_colour; /**< Colour instance attribute. */
+   RadarMarker *markers;       /**< Markers pending to draw (array.h). */
+} RadarBatch;
+
+static RadarBatch radar_batch_pilot;    /**< Batched pilot markers. */
+static RadarBatch radar_batch_asteroid; /**< Batched asteroid markers. */
+static gl_vbo    *radar_batch_vbo = NULL; /**< Instance VBO for markers. */
+static size_t     radar_batch_vbo_size = 0; /**< Size of the instance VBO. */
+static int        radar_batching = 0; /**< Whether markers are being batched. */
+static double     radar_batch_radius =
+   0.; /**< Circle clipping radius or 0. for none. */
+
 static int gui_getMessage =
    1; /**< Whether or not the player should receive messages. */
 static char   *gui_name = NULL; /**< Name of the GUI (for errors and such). */
@@ -162,6 +191,11 @@ static void gui_renderRadarOutOfRange( RadarShape sh, int w, int h, int cx,
 static void gui_blink( double cx, double cy, double vr, const glColour *col,
                        double blinkInterval, double blinkVar );
 static const glColour *gui_getPilotColour( const Pilot *p );
+static void            gui_radarBatchInit( RadarBatch *b, const char *frag );
+static void            gui_radarBatchFree( RadarBatch *b );
+static void gui_radarBatchAdd( RadarBatch *b, double x, double y, double size,
+                               double dir, const glColour *col );
+static void gui_radarBatchFlush( RadarBatch *b );
 /* Lua GUI. */
 static int gui_doFunc( int func_ref, const char *func_name );
 static int gui_prepFunc( int func_ref, const char *func_name );
@@ -811,8 +845,9 @@ void gui_radarRender( double x, double y )
    gui_radar.y = y;
 
    /* TODO: modifying gl_view_matrix like this is a bit of a hack */
-   /* TODO: use stencil test for RADAR_CIRCLE */
-   view_matrix_prev = gl_view_matrix;
+   /* Batched markers get clipped to the circle in the shader. */
+   view_matrix_prev   = gl_view_matrix;
+   radar_batch_radius = ( radar->shape == RADAR_CIRCLE ) ? radar->w : 0.;
    if ( radar->shape == RADAR_RECT ) {
       gl_clipRect( x, y, radar->w, radar->h );
       mat4_translate_xy( &gl_view_matrix, x + radar->w / 2.,
@@ -854,8 +889,9 @@ void gui_radarRender( double x, double y )
    weapon_minimap( radar->res, radar->w, radar->h, radar->shape, 1. );
 
    /* render the pilot */
-   pilot_stack = pilot_getAll();
-   f           = 0;
+   pilot_stack    = pilot_getAll();
+   f              = 0;
+   radar_batching = 1;
    for ( int i = 1; i < array_size( pilot_stack ); i++ ) { /* skip the player */
       if ( pilot_stack[i]->id == player.p->target )
          f = i;
@@ -863,6 +899,8 @@ void gui_radarRender( double x, double y )
          gui_renderPilot( pilot_stack[i], radar->shape, radar->w, radar->h,
                           radar->res, 0 );
    }
+   radar_batching = 0;
+   gui_radarBatchFlush( &radar_batch_pilot );
    /* render the targeted pilot */
    if ( f != 0 )
       gui_renderPilot( pilot_stack[f], radar->shape, radar->w, radar->h,
@@ -871,6 +909,7 @@ void gui_radarRender( double x, double y )
    /* Render the asteroids */
    const double render_limit =
       radar->shape == RADAR_CIRCLE ? radar->w : INFINITY;
+   radar_batching = 1;
    for ( int i = 0; i < array_size( cur_system->asteroids ); i++ ) {
       AsteroidAnchor *ast = &cur_system->asteroids[i];
       double range = CTS.EW_ASTEROID_DIST *
@@ -887,6 +926,8 @@ void gui_radarRender( double x, double y )
                              0 );
       }
    }
+   radar_batching = 0;
+   gui_radarBatchFlush( &radar_batch_asteroid );
 
    /* Render the viewport frame */
    gui_renderViewportFrame( radar->res, render_limit, 0 );
@@ -1129,9 +1170,13 @@ void gui_renderPilot( const Pilot *p, RadarShape shape, double w, double h,
       hilight = 1;
    }
 
-   glUseProgram( shaders.pilotmarker.program );
-   gl_renderShader( x, y, scale, scale, p->solid.dir, &shaders.pilotmarker, col,
-                    1 );
+   if ( radar_batching )
+      gui_radarBatchAdd( &radar_batch_pilot, x, y, scale, p->solid.dir, col );
+   else {
+      glUseProgram( shaders.pilotmarker.program );
+      gl_renderShader( x, y, scale, scale, p->solid.dir, &shaders.pilotmarker,
+                       col, 1 );
+   }
 
    /* Draw selection if targeted. */
    if ( p->id == player.p->target )
@@ -1234,8 +1279,12 @@ void gui_renderAsteroid( const Asteroid *a, double w, double h, double res,
       col = &cGrey70;
 
    // gl_renderRect( px, py, MIN( 2*sx, w-px ), MIN( 2*sy, h-py ), col );
-   glUseProgram( shaders.asteroidmarker.program );
-   gl_renderShader( px, py, r, r, 0., &shaders.asteroidmarker, col, 1 );
+   if ( radar_batching )
+      gui_radarBatchAdd( &radar_batch_asteroid, px, py, r, 0., col );
+   else {
+      glUseProgram( shaders.asteroidmarker.program );
+      gl_renderShader( px, py, r, r, 0., &shaders.asteroidmarker, col, 1 );
+   }
 
    if ( targeted )
       gui_blink( px, py, MAX( 7., 2.0 * r ), col, RADAR_BLINK_PILOT,
@@ -1358,6 +1407,99 @@ void gui_forceBlink( void )
    blink_spob  = 0.;
 }
 
+/**
+ * @brief Loads the instanced version of a radar marker shader.
+ */
+static void gui_radarBatchInit( RadarBatch *b, const char *frag )
+{
+   b->program = gl_program_backend( "radarmarker.vert", frag,
+                                    "#define RADAR_BATCH 1\n" );
+   b->projection    = glGetUniformLocation( b->program, "projection" );
+   b->radar_radius  = glGetUniformLocation( b->program, "radar_radius" );
+   b->vertex        = glGetAttribLocation( b->program, "vertex" );
+   b->marker        = glGetAttribLocation( b->program, "marker" );
+   b->marker_colour = glGetAttribLocation( b->program, "marker_colour" );
+   b->markers       = array_create( RadarMarker );
+}
+
+/**
+ * @brief Frees an instanced radar marker shader.
+ */
+static void gui_radarBatchFree( RadarBatch *b )
+{
+   glDeleteProgram( b->program );
+   array_free( b->markers );
+   memset( b, 0, sizeof( RadarBatch ) );
+}
+
+/**
+ * @brief Adds a marker to a radar batch, parameters are the same as
+ * gl_renderShader() with a centred square.
+ */
+static void gui_radarBatchAdd( RadarBatch *b, double x, double y, double size,
+                               double dir, const glColour *col )
+{
+   RadarMarker *m = &array_grow( &b->markers );
+   m->marker[0]   = x;
+   m->marker[1]   = y;
+   m->marker[2]   = size;
+   m->marker[3]   = dir;
+   m->colour[0]   = col->r;
+   m->colour[1]   = col->g;
+   m->colour[2]   = col->b;
+   m->colour[3]   = col->a;
+}
+
+/**
+ * @brief Draws all the markers of a radar batch with a single instanced draw.
+ */
+static void gui_radarBatchFlush( RadarBatch *b )
+{
+   size_t n    = array_size( b->markers );
+   size_t size = n * sizeof( RadarMarker );
+   if ( n == 0 )
+      return;
+
+   /* Upload, only reallocating when it doesn't fit. */
+   if ( radar_batch_vbo == NULL ) {
+      radar_batch_vbo      = gl_vboCreateStream( size, b->markers );
+      radar_batch_vbo_size = size;
+      gl_vboLabel( radar_batch_vbo, "GUI Radar Marker VBO" );
+   } else if ( size > radar_batch_vbo_size ) {
+      gl_vboData( radar_batch_vbo, size, b->markers );
+      radar_batch_vbo_size = size;
+   } else
+      gl_vboSubData( radar_batch_vbo, 0, size, b->markers );
+
+   glUseProgram( b->program );
+   gl_uniformMat4( b->projection, &gl_view_matrix );
+   glUniform1f( b->radar_radius, radar_batch_radius );
+   glEnableVertexAttribArray( b->vertex );
+   gl_vboActivateAttribOffset( gl_circleVBO, b->vertex, 0, 2, GL_FLOAT, 0 );
+   glEnableVertexAttribArray( b->marker );
+   gl_vboActivateAttribOffset( radar_batch_vbo, b->marker,
+                               offsetof( RadarMarker, marker ), 4, GL_FLOAT,
+                               sizeof( RadarMarker ) );
+   glVertexAttribDivisor( b->marker, 1 );
+   glEnableVertexAttribArray( b->marker_colour );
+   gl_vboActivateAttribOffset( radar_batch_vbo, b->marker_colour,
+                               offsetof( RadarMarker, colour ), 4, GL_FLOAT,
+                               sizeof( RadarMarker ) );
+   glVertexAttribDivisor( b->marker_colour, 1 );
+
+   glDrawArraysInstanced( GL_TRIANGLE_STRIP, 0, 4, n );
+
+   glVertexAttribDivisor( b->marker, 0 );
+   glVertexAttribDivisor( b->marker_colour, 0 );
+   glDisableVertexAttribArray( b->vertex );
+   glDisableVertexAttribArray( b->marker );
+   glDisableVertexAttribArray( b->marker_colour );
+   glUseProgram( 0 );
+   gl_checkErr();
+
+   array_resize( &b->markers, 0 );
+}
+
 /**
  * @brief Renders the spob blink around a position on the minimap.
  */
@@ -1668,6 +1810,12 @@ int gui_init( void )
    /* Quadtrees. */
    il_create( &gui_qtquery, 1 );
 
+   /* Batched radar markers. */
+   if ( radar_batch_pilot.markers == NULL ) {
+      gui_radarBatchInit( &radar_batch_pilot, "pilotmarker.frag" );
+      gui_radarBatchInit( &radar_batch_asteroid, "asteroidmarker.frag" );
+   }
+
    return 0;
 }
 
@@ -2009,6 +2157,11 @@ void gui_free( void )
 
    gl_vboDestroy( gui_radar_select_vbo );
    gui_radar_select_vbo = NULL;
+   gui_radarBatchFree( &radar_batch_pilot );
+   gui_radarBatchFree( &radar_batch_asteroid );
+   gl_vboDestroy( radar_batch_vbo );
+   radar_batch_vbo      = NULL;
+   radar_batch_vbo_size = 0;
 
    osd_exit();
 
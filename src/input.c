@@ -35,6 +35,7 @@
 #include "pilot.h"
 #include "player.h"
 #include "player_autonav.h"
+#include "replay.h"
 #include "save.h"
 #include "toolkit.h"
 
@@ -769,7 +770,7 @@ void input_update( double dt )
          return;
 
       /* Get time. */
-      t = SDL_GetTicks();
+      t = replay_getTicks();
 
       /* Should be repeating. */
       if ( repeat_keyTimer + conf.repeat_delay +
@@ -835,7 +836,7 @@ static void input_key( KeySemanticType keynum, double value, double kabs,
    if ( conf.repeat_delay != 0 ) {
       if ( ( value == KEY_PRESS ) && !repeat ) {
          repeat_key        = keynum;
-         repeat_keyTimer   = SDL_GetTicks();
+         repeat_keyTimer   = replay_getTicks();
          repeat_keyCounter = 0;
       } else if ( value == KEY_RELEASE ) {
          repeat_key        = -1;
@@ -846,7 +847,7 @@ static void input_key( KeySemanticType keynum, double value, double kabs,
 
    /* Detect if double tap. */
    if ( value == KEY_PRESS ) {
-      unsigned int t = SDL_GetTicks();
+      unsigned int t = replay_getTicks();
       if ( ( keynum == doubletap_key ) &&
            ( t - doubletap_t <= conf.doubletap_sens ) )
          isdoubletap = 1;
@@ -1793,7 +1794,7 @@ void input_clicked( const void *clicked )
       return;
 
    input_lastClicked    = clicked;
-   input_mouseClickLast = SDL_GetTicks();
+   input_mouseClickLast = replay_getTicks();
 }
 
 /**
@@ -1809,7 +1810,7 @@ int input_isDoubleClick( const void *clicked )
    unsigned int threshold =
       input_mouseClickLast + (int)floor( conf.mouse_doubleclick * 1000. );
 
-   if ( ( SDL_GetTicks() <= threshold ) && ( clicked == input_lastClicked ) )
+   if ( ( replay_getTicks() <= threshold ) && ( clicked == input_lastClicked ) )
       return 1;
 
    return 0;
@@ -1825,7 +1826,7 @@ static int input_doubleClickTest( unsigned int *time, const void **last,
 
    /* Most recent time that constitutes a valid double-click. */
    threshold = *time + (int)floor( conf.mouse_doubleclick * 1000. );
-   ticks     = SDL_GetTicks();
+   ticks     = replay_getTicks();
 
    if ( ( ticks <= threshold ) && ( *last == clicked ) )
       return 1;
@@ -91,6 +91,24 @@ Spob                *land_spob    = NULL;      /**< Spob player landed at. */
 static glTexture    *gfx_exterior =
    NULL; /**< Exterior graphic of the landed spob. */
 
+/*
+ * Preparation while landing.
+ */
+/**
+ * @brief Stages of preparing the landing screens, one is run each frame.
+ */
+typedef enum LandPrepareStage_ {
+   LAND_PREPARE_EXTERIOR, /**< Load the exterior graphic. */
+   LAND_PREPARE_OUTFITS,  /**< Generate the outfitter catalogue. */
+   LAND_PREPARE_SHIPYARD, /**< Load the shipyard graphics. */
+   LAND_PREPARE_DONE,     /**< Nothing left to do. */
+} LandPrepareStage;
+static const Spob      *land_prepSpob = NULL; /**< Spob being prepared. */
+static LandPrepareStage land_prepStage =
+   LAND_PREPARE_DONE; /**< Next preparation stage to run. */
+static glTexture *land_prepExterior =
+   NULL; /**< Exterior graphic loaded while landing. */
+
 /*
  * mission computer stack
  */
@@ -1426,6 +1444,65 @@ int land_setWindow( int window )
    return 0;
 }
 
+/**
+ * @brief Starts preparing the landing screens while the player lands.
+ *
+ * Only data that does not depend on what happens when landing, such as hooks
+ * or missions, is prepared, the rest is still generated by land().
+ *
+ *    @param p Spob the player is landing on.
+ */
+void land_prepare( const Spob *p )
+{
+   land_prepareClear();
+   land_prepSpob  = p;
+   land_prepStage = LAND_PREPARE_EXTERIOR;
+}
+
+/**
+ * @brief Runs the next stage of preparing the landing screens.
+ *
+ * Spread out over the frames of the landing animation to not stall.
+ */
+void land_prepareUpdate( void )
+{
+   if ( ( land_prepSpob == NULL ) || ( land_prepStage == LAND_PREPARE_DONE ) )
+      return;
+
+   NTracingZone( _ctx, 1 );
+
+   switch ( land_prepStage ) {
+   case LAND_PREPARE_EXTERIOR:
+      if ( land_prepSpob->gfx_exterior != NULL )
+         land_prepExterior = gl_newImage( land_prepSpob->gfx_exterior, 0 );
+      break;
+   case LAND_PREPARE_OUTFITS:
+      if ( spob_hasService( land_prepSpob, SPOB_SERVICE_OUTFITS ) )
+         outfits_prepare( land_prepSpob );
+      break;
+   case LAND_PREPARE_SHIPYARD:
+      if ( spob_hasService( land_prepSpob, SPOB_SERVICE_SHIPYARD ) )
+         shipyard_prepare( land_prepSpob );
+      break;
+   case LAND_PREPARE_DONE:
+      break;
+   }
+   land_prepStage++;
+
+   NTracingZoneEnd( _ctx );
+}
+
+/**
+ * @brief Releases anything prepared while landing.
+ */
+void land_prepareClear( void )
+{
+   gl_freeTexture( land_prepExterior );
+   land_prepExterior = NULL;
+   land_prepSpob     = NULL;
+   land_prepStage    = LAND_PREPARE_DONE;
+}
+
 /**
  * @brief Opens up all the land dialogue stuff.
  *    @param p Spob to open stuff for.
@@ -1480,9 +1557,11 @@ void land( Spob *p, int load )
    gui_setNav();
    cam_vel( 0., 0. );
 
-   /* Load stuff */
+   /* Load stuff, the exterior graphic is only a reference if it was prepared
+    * while landing. */
    land_spob    = p;
    gfx_exterior = gl_newImage( p->gfx_exterior, 0 );
+   land_prepareClear();
 
    /* Run outfits as necessary. */
    pilot_outfitLOnland( player.p );
@@ -2004,6 +2083,7 @@ void land_cleanup( void )
    if ( gfx_exterior != NULL )
       gl_freeTexture( gfx_exterior );
    gfx_exterior = NULL;
+   land_prepareClear();
 
    /* Remove computer markers just in case. */
    space_clearComputerMarkers();
@@ -73,6 +73,9 @@ void land_needsTakeoff( int delay );
 int  land_canSave( void );
 int  land_doneLoading( void );
 void land( Spob *p, int load );
+void land_prepare( const Spob *p );
+void land_prepareUpdate( void );
+void land_prepareClear( void );
 void land_genWindows( int load );
 void takeoff( int delay, int nosave );
 void land_cleanup( void );
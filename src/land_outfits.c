@@ -34,6 +34,7 @@
 #include "player_gui.h"
 #include "slots.h"
 #include "space.h"
+#include "tech.h"
 #include "toolkit.h"
 #include "utf8.h"
 
@@ -57,6 +58,13 @@ static Outfit *
 static int             outfit_Mode = 0; /**< Outfit mode for filtering. */
 static PlayerOutfit_t *outfits_sold =
    NULL; /**< List of the outfits the player sold so they can buy them back. */
+static Outfit **outfits_catalogue =
+   NULL; /**< Cached outfits sold at the landed spob. */
+static const Spob *outfits_catalogueSpob =
+   NULL; /**< Spob the catalogue was generated for. */
+static unsigned int outfits_catalogueGen =
+   0; /**< Tech generation the catalogue was generated with. */
+static OutfitAltCache outfits_altCache; /**< Alt texts of the outfitter. */
 
 /* Modifier for buying and selling quantity. */
 static int outfits_mod = 1;
@@ -73,6 +81,11 @@ static void outfits_rmouse( unsigned int wid, const char *widget_name );
 static void outfits_naevpedia( unsigned int wid, const char *str );
 static void outfit_Popdown( unsigned int wid, const char *str );
 static void outfits_genList( unsigned int wid );
+static const Outfit **outfits_getCatalogue( const Spob *spob );
+static int            outfits_altCacheMatches( const OutfitAltCache *cache,
+                                               const Pilot          *p );
+static void           outfits_altCacheCheck( OutfitAltCache *cache,
+                                             const Pilot    *p );
 static void outfits_changeTab( unsigned int wid, const char *wgt, int old,
                                int tab );
 static void outfits_onClose( unsigned int wid, const char *str );
@@ -168,6 +181,9 @@ void outfits_open( unsigned int wid, const Outfit **outfits, int blackmarket )
    array_free( outfits_sold );
    outfits_sold = NULL;
 
+   /* Start with fresh alt texts, the Lua descriptions may have changed. */
+   outfits_altCacheClear( &outfits_altCache );
+
    /* initialize the outfit mode. */
    outfit_Mode       = 0;
    data              = malloc( sizeof( LandOutfitData ) );
@@ -176,9 +192,16 @@ void outfits_open( unsigned int wid, const Outfit **outfits, int blackmarket )
    window_setData( wid, data );
    window_onClose( wid, outfits_onClose );
 
-   /* Mark as generated. */
-   if ( outfits == NULL )
+   /* Mark as generated. Availability conditionals are Lua checks on the game
+    * state, so the catalogue of a spob that has them is regenerated every time
+    * the outfitter is opened. */
+   if ( outfits == NULL ) {
       land_tabGenerate( LAND_WINDOW_OUTFITS );
+      if ( ( land_spob != NULL ) && tech_isConditional( land_spob->tech ) ) {
+         array_free( outfits_catalogue );
+         outfits_catalogue = NULL;
+      }
+   }
 
    /* Get dimensions. */
    outfits_getSize( wid, &w, &h, &iw, &ih, &bw, &bh );
@@ -459,15 +482,17 @@ static void outfits_genList( unsigned int wid )
              sizeof( Outfit * ), outfit_compareTech );
    } else {
       /* Use custom list; default to landed outfits. */
-      iar_outfits[active] = ( data->outfits != NULL )
-                               ? array_copy( Outfit *, data->outfits )
-                               : tech_getOutfit( land_spob->tech, 0 );
+      iar_outfits[active] =
+         ( data->outfits != NULL )
+            ? array_copy( Outfit *, data->outfits )
+            : array_copy( Outfit *, outfits_getCatalogue( land_spob ) );
    }
    noutfits = outfits_filter( (const Outfit **)iar_outfits[active],
                               array_size( iar_outfits[active] ),
                               tabfilters[active], filtertext );
-   coutfits = outfits_imageArrayCells( (const Outfit **)iar_outfits[active],
-                                       &noutfits, player.p, 1 );
+   coutfits = outfits_imageArrayCellsCached(
+      (const Outfit **)iar_outfits[active], &noutfits, player.p, 1,
+      &outfits_altCache );
 
    iconsize = 128;
    if ( !conf.big_icons ) {
@@ -486,6 +511,54 @@ static void outfits_genList( unsigned int wid )
    outfits_update( wid, NULL );
 }
 
+/**
+ * @brief Gets the outfits sold at a spob.
+ *
+ * The list is only regenerated when the spob or the tech groups change, the
+ * filtered views are all copies of it. Spobs with availability conditionals
+ * also get it regenerated in outfits_open().
+ *
+ *    @param spob Spob to get the outfits of.
+ *    @return Array (array.h): Sorted outfits sold at the spob.
+ */
+static const Outfit **outfits_getCatalogue( const Spob *spob )
+{
+   if ( spob == NULL )
+      return NULL;
+
+   if ( ( outfits_catalogue == NULL ) || ( outfits_catalogueSpob != spob ) ||
+        ( outfits_catalogueGen != tech_generation() ) ) {
+      array_free( outfits_catalogue );
+      outfits_catalogue     = tech_getOutfit( spob->tech, 0 );
+      outfits_catalogueSpob = spob;
+      outfits_catalogueGen  = tech_generation();
+   }
+   return (const Outfit **)outfits_catalogue;
+}
+
+/**
+ * @brief Prepares the outfitter of a spob the player is landing on.
+ *
+ * Generates the catalogue and loads the store graphics, so that opening the
+ * outfitter when landing only has to create the widgets.
+ *
+ *    @param spob Spob the player is landing on.
+ */
+void outfits_prepare( const Spob *spob )
+{
+   int needsgfx = 0;
+   outfits_getCatalogue( spob );
+   for ( int i = 0; i < array_size( outfits_catalogue ); i++ ) {
+      Outfit *o = outfits_catalogue[i];
+      if ( !outfit_gfxStoreLoaded( o ) ) {
+         outfit_setProp( o, OUTFIT_PROP_NEEDSGFX );
+         needsgfx = 1;
+      }
+   }
+   if ( needsgfx )
+      outfit_gfxStoreLoadNeeded();
+}
+
 /**
  * @brief Updates the outfits in the outfit window.
  *    @param wid Window to update the outfits in.
@@ -739,11 +812,97 @@ int outfit_altText( char *buf, int n, const Outfit *o, const Pilot *plt,
    return 0;
 }
 
+/**
+ * @brief Frees the alt texts stored in an alt text cache.
+ *
+ *    @param cache Cache to clear.
+ */
+void outfits_altCacheClear( OutfitAltCache *cache )
+{
+   if ( cache->alt != NULL ) {
+      int n = array_size( outfit_getAll_rust() );
+      for ( int i = 0; i < n; i++ )
+         free( cache->alt[i] );
+      free( cache->alt );
+   }
+   array_free( cache->outfits );
+   memset( cache, 0, sizeof( OutfitAltCache ) );
+}
+
+/**
+ * @brief Checks to see if a pilot is in the same state as when an alt text
+ * cache was generated.
+ *
+ * The descriptions can depend on the outfits, stats and mass of the pilot.
+ *
+ *    @param cache Cache to check.
+ *    @param p Pilot to compare with.
+ *    @return 1 if the alt texts are still valid for the pilot.
+ */
+static int outfits_altCacheMatches( const OutfitAltCache *cache,
+                                    const Pilot          *p )
+{
+   if ( cache->mass != p->solid.mass )
+      return 0;
+   if ( array_size( cache->outfits ) != array_size( p->outfits ) )
+      return 0;
+   for ( int i = 0; i < array_size( p->outfits ); i++ )
+      if ( cache->outfits[i] != p->outfits[i]->outfit )
+         return 0;
+   return ( memcmp( &cache->stats, &p->stats, sizeof( ShipStats ) ) == 0 );
+}
+
+/**
+ * @brief Makes sure an alt text cache matches a pilot, clearing it otherwise.
+ *
+ *    @param cache Cache to check.
+ *    @param p Pilot the alt texts are being generated for.
+ */
+static void outfits_altCacheCheck( OutfitAltCache *cache, const Pilot *p )
+{
+   if ( ( cache->alt != NULL ) && ( cache->p == p ) &&
+        ( cache->tech == tech_generation() ) &&
+        ( ( p == NULL ) || outfits_altCacheMatches( cache, p ) ) )
+      return;
+
+   outfits_altCacheClear( cache );
+   cache->p    = p;
+   cache->tech = tech_generation();
+   if ( p != NULL ) {
+      cache->stats   = p->stats;
+      cache->mass    = p->solid.mass;
+      cache->outfits = array_create_size( const Outfit *,
+                                          MAX( 1, array_size( p->outfits ) ) );
+      for ( int i = 0; i < array_size( p->outfits ); i++ )
+         array_push_back( &cache->outfits, p->outfits[i]->outfit );
+   }
+   cache->alt =
+      calloc( MAX( 1, array_size( outfit_getAll_rust() ) ), sizeof( char * ) );
+}
+
 /**
  * @brief Generates image array cells corresponding to outfits.
  */
 ImageArrayCell *outfits_imageArrayCells( const Outfit **outfits, int *noutfits,
                                          const Pilot *p, int store )
+{
+   return outfits_imageArrayCellsCached( outfits, noutfits, p, store, NULL );
+}
+
+/**
+ * @brief Generates image array cells corresponding to outfits, reusing the
+ * alt texts stored in a cache.
+ *
+ *    @param outfits Outfits to generate cells for.
+ *    @param[in, out] noutfits Number of outfits, set to number of cells.
+ *    @param p Pilot to generate the alt texts for.
+ *    @param store Whether or not the cells are for a store.
+ *    @param cache Cache of the alt texts or NULL to not use one.
+ *    @return The generated image array cells.
+ */
+ImageArrayCell *outfits_imageArrayCellsCached( const Outfit **outfits,
+                                               int *noutfits, const Pilot *p,
+                                               int store, OutfitAltCache *cache )
 {
    ImageArrayCell *coutfits =
       calloc( MAX( 1, *noutfits ), sizeof( ImageArrayCell ) );
@@ -766,6 +925,8 @@ ImageArrayCell *outfits_imageArrayCells( const Outfit **outfits, int *noutfits,
          outfit_gfxStoreLoadNeeded();
       /* Just to be safe, we assume some ships could potentially be duplicated.
        */
+      if ( cache != NULL )
+         outfits_altCacheCheck( cache, p );
 
       /* Set alt text. */
       for ( int i = 0; i < *noutfits; i++ ) {
@@ -788,7 +949,13 @@ ImageArrayCell *outfits_imageArrayCells( const Outfit **outfits, int *noutfits,
          col_blend( &coutfits[i].bg, c, &cGrey70, 1 );
 
          /* Short description. */
-         coutfits[i].alt = strdup( pilot_outfitSummary( p, o, 1, NULL ) );
+         if ( cache != NULL ) {
+            int id = o - outfit_getAll_rust();
+            if ( cache->alt[id] == NULL )
+               cache->alt[id] = strdup( pilot_outfitSummary( p, o, 1, NULL ) );
+            coutfits[i].alt = strdup( cache->alt[id] );
+         } else
+            coutfits[i].alt = strdup( pilot_outfitSummary( p, o, 1, NULL ) );
 
          /* Slot type. */
          if ( ( strcmp( outfit_slotName( o ), "N/A" ) != 0 ) &&
@@ -1264,4 +1431,10 @@ void outfits_cleanup( void )
    for ( int i = 0; i < OUTFITS_NTABS; i++ )
       array_free( iar_outfits[i] );
    memset( iar_outfits, 0, sizeof( Outfit ** ) * OUTFITS_NTABS );
+
+   /* Free cached lists. */
+   array_free( outfits_catalogue );
+   outfits_catalogue     = NULL;
+   outfits_catalogueSpob = NULL;
+   outfits_altCacheClear( &outfits_altCache );
 }
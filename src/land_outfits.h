@@ -5,12 +5,29 @@
 
 #include "outfit.h"
 #include "pilot.h"
+#include "space.h"
 #include "tk/widget/imagearray.h"
 
+/**
+ * @brief Cache of the outfit alt texts generated for a pilot.
+ *
+ * Generating the alt text can run the outfit Lua descriptions, so it is kept
+ * around until the pilot, its outfits or stats, or the tech change.
+ */
+typedef struct OutfitAltCache_ {
+   const Pilot   *p;       /**< Pilot the alt texts were generated for. */
+   const Outfit **outfits; /**< Outfits of the pilot by slot (array.h). */
+   ShipStats      stats;   /**< Stats of the pilot when generated. */
+   double         mass;    /**< Mass of the pilot when generated. */
+   unsigned int   tech;    /**< Tech generation when generated. */
+   char         **alt; /**< Alt texts indexed by outfit ID, NULL if missing. */
+} OutfitAltCache;
+
 int outfit_altText( char *buf, int n, const Outfit *o, const Pilot *plt,
                     PilotOutfitSlot *pos );
 
 void outfits_open( unsigned int wid, const Outfit **outfits, int blackmarket );
+void outfits_prepare( const Spob *spob );
 void outfits_regenList( unsigned int wid, const char *str );
 void outfits_update( unsigned int wid, const char *str );
 void outfits_updateEquipmentOutfits( void );
@@ -18,6 +35,10 @@ int  outfits_filter( const Outfit **outfits, int                     n,
                      int ( *filter )( const Outfit *o ), const char *name );
 ImageArrayCell *outfits_imageArrayCells( const Outfit **outfits, int *noutfits,
                                          const Pilot *p, int store );
+ImageArrayCell *outfits_imageArrayCellsCached( const Outfit **outfits,
+                                               int *noutfits, const Pilot *p,
+                                               int store, OutfitAltCache *cache );
+void            outfits_altCacheClear( OutfitAltCache *cache );
 int             outfit_canBuy( const Outfit *outfit, int blackmarket );
 int             outfit_canSell( const Outfit *outfit );
 void            outfits_cleanup( void );
@@ -434,6 +434,29 @@ void shipyard_update( unsigned int wid, const char *str )
       window_enableButton( wid, "btnTradeShip" );
 }
 
+/**
+ * @brief Prepares the shipyard of a spob the player is landing on.
+ *
+ * Loads the graphics of the ships for sale, so that opening the shipyard when
+ * landing only has to render the store images.
+ *
+ *    @param spob Spob the player is landing on.
+ */
+void shipyard_prepare( const Spob *spob )
+{
+   Ship **ships    = tech_getShip( spob->tech, 0 );
+   int    needsgfx = 0;
+   for ( int i = 0; i < array_size( ships ); i++ ) {
+      if ( !ship_gfxLoaded( ships[i] ) ) {
+         ships[i]->flags |= SHIP_NEEDSGFX;
+         needsgfx = 1;
+      }
+   }
+   if ( needsgfx )
+      ship_gfxLoadNeeded();
+   array_free( ships );
+}
+
 /**
  * @brief Cleans up shipyard data.
  */
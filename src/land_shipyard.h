@@ -10,6 +10,7 @@
  * Window stuff.
  */
 void shipyard_open( unsigned int wid );
+void shipyard_prepare( const Spob *spob );
 void shipyard_update( unsigned int wid, const char *str );
 void shipyard_cleanup( void );
 
@@ -3,8 +3,11 @@
  */
 /** @cond */
 #include <math.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "naev.h"
 /** @endcond */
@@ -16,6 +19,7 @@
 #include "conf.h"
 #include "constants.h"
 #include "dialogue.h"
+#include "economy.h"
 #include "faction.h"
 #include "gui.h"
 #include "log.h"
@@ -112,6 +116,83 @@ static double map_my           = 0.; /**< Y mouse position */
 static char   map_show_notes   = 0;  /**< Boolean for showing system notes */
 static double map_max_presence = 0.; /**< Maximum presence in a system. */
 
+/**
+ * @brief Vertex of the retained jump lane geometry.
+ */
+typedef struct MapLaneVertex_ {
+   GLfloat centre[2];  /**< Centre of the lane in map coordinates. */
+   GLfloat dir[2];     /**< Direction of the lane. */
+   GLfloat vertex[2];  /**< Local coordinates in [-1,1]. */
+   GLfloat size[2];    /**< Half length in map units and half width in pixels. */
+   GLfloat colour[4];  /**< Colour at the origin system. */
+   GLfloat colour2[4]; /**< Colour at the target system. */
+} MapLaneVertex;
+
+/**
+ * @brief Vertex of the retained system geometry.
+ */
+typedef struct MapSysVertex_ {
+   GLfloat centre[2]; /**< Centre of the system in map coordinates. */
+   GLfloat vertex[2]; /**< Local coordinates in [-1,1]. */
+   GLfloat size;      /**< Size relative to the system radius. */
+   GLfloat filled;    /**< Whether or not the circle is filled. */
+   GLfloat colour[4]; /**< Colour of the circle. */
+} MapSysVertex;
+
+/**
+ * @brief Retained system name.
+ */
+typedef struct MapLabel_ {
+   int id;      /**< ID of the system. */
+   int w_def;   /**< Width with the default font. */
+   int w_small; /**< Width with the small font. */
+} MapLabel;
+
+/**
+ * @brief Vertices of a single system in the retained system geometry.
+ */
+typedef struct MapSysRange_ {
+   int id;    /**< ID of the system. */
+   int first; /**< First vertex. */
+   int n;     /**< Number of vertices. */
+} MapSysRange;
+
+/**
+ * @brief Retained geometry of part of the starmap.
+ *
+ * It's all in map coordinates so that panning and zooming only changes the
+ * uniforms, and only gets rebuilt when map_invalidate() is called or it is
+ * drawn with a different mode.
+ */
+typedef struct MapBatch_ {
+   unsigned int gen; /**< Generation it was built at, 0 if not built. */
+   int          key; /**< Mode it was built for. */
+   gl_vbo      *vbo; /**< Vertex buffer. */
+   int          n;   /**< Number of vertices. */
+} MapBatch;
+
+/**
+ * @brief Retained state of a view of the starmap.
+ *
+ * The map and the universe editor each have their own, so that they don't
+ * keep rebuilding each other's.
+ */
+typedef struct MapView_ {
+   MapBatch     lanes;      /**< Jump lanes. */
+   MapBatch     systems;    /**< System circles. */
+   MapSysRange *sysranges;  /**< Array (array.h): Vertices of each system. */
+   MapLabel    *labels;     /**< Array (array.h): System names. */
+   unsigned int labels_gen; /**< Generation the names were built at. */
+} MapView;
+
+static MapView map_views[2]; /**< Retained views, the second is the editor's. */
+static unsigned int map_gen =
+   1; /**< Generation of the state the retained views are built from. */
+static GLint *map_draw_first =
+   NULL; /**< Array (array.h): First vertex of the visible systems. */
+static GLsizei *map_draw_count =
+   NULL; /**< Array (array.h): Vertices of the visible systems. */
+
 /*
  * extern
  */
@@ -189,6 +270,19 @@ void map_exit( void )
       decorator_stack = NULL;
    }
 
+   for ( int i = 0; i < 2; i++ ) {
+      MapView *view = &map_views[i];
+      gl_vboDestroy( view->lanes.vbo );
+      gl_vboDestroy( view->systems.vbo );
+      array_free( view->sysranges );
+      array_free( view->labels );
+      memset( view, 0, sizeof( MapView ) );
+   }
+   array_free( map_draw_first );
+   array_free( map_draw_count );
+   map_draw_first = NULL;
+   map_draw_count = NULL;
+
    ovr_exit();
 }
 
@@ -282,6 +376,22 @@ static void map_setup( void )
 
    /* mark systems as needed */
    mission_sysMark();
+
+   /* Faction standings and such may have changed. */
+   map_invalidate();
+}
+
+/**
+ * @brief Marks the retained starmap geometry as out of date.
+ *
+ * Has to be called when anything the starmap draws changes, such as the
+ * systems, jumps, their flags or faction standings.
+ */
+void map_invalidate( void )
+{
+   map_gen++;
+   if ( map_gen == 0 ) /* 0 means never built. */
+      map_gen = 1;
 }
 
 /**
@@ -506,8 +616,9 @@ static void map_update_commod_av_price( void )
 
    c = commod_known[cur_commod];
    if ( cur_commod_mode == 0 ) {
-      double totPrice    = 0;
-      int    totPriceCnt = 0;
+      const EconomyKnownPrices *known       = economy_getKnownPrices( c );
+      double                    totPrice    = 0;
+      int                       totPriceCnt = 0;
       for ( int i = 0; i < array_size( systems_stack ); i++ ) {
          const StarSystem *sys = system_getIndex( i );
 
@@ -517,29 +628,10 @@ static void map_update_commod_av_price( void )
                 !sys_isFlag( sys, SYSTEM_MARKED | SYSTEM_CMARKED ) &&
                 !space_sysReachable( sys ) ) )
             continue;
-         if ( ( sys_isKnown( sys ) ) && ( system_hasSpob( sys ) ) ) {
-            double sumPrice = 0;
-            int    sumCnt   = 0;
-            double thisPrice;
-            for ( int j = 0; j < array_size( sys->spobs ); j++ ) {
-               const Spob *p = sys->spobs[j];
-               for ( int k = 0; k < array_size( p->commodities ); k++ ) {
-                  if ( p->commodities[k] == c ) {
-                     if ( p->commodityPrice[k].cnt >
-                          0 ) { /*commodity is known about*/
-                        thisPrice =
-                           p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
-                        sumPrice += thisPrice;
-                        sumCnt += 1;
-                        break;
-                     }
-                  }
-               }
-            }
-            if ( sumCnt > 0 ) {
-               totPrice += sumPrice / sumCnt;
-               totPriceCnt++;
-            }
+         if ( ( sys_isKnown( sys ) ) && ( system_hasSpob( sys ) ) &&
+              ( known->cnt[i] > 0 ) ) {
+            totPrice += known->mean[i];
+            totPriceCnt++;
          }
       }
       if ( totPriceCnt > 0 )
@@ -1356,24 +1448,78 @@ void map_renderSystemEnvironment( double x, double y, double zoom, int editor,
 }
 
 /**
- * @brief Renders the jump routes between systems.
+ * @brief Checks to see if a retained batch is up to date.
+ *
+ *    @param batch Batch to check.
+ *    @param key Mode it has to have been built for.
  */
-void map_renderJumps( double x, double y, double zoom, double radius,
-                      int editor )
+static int map_batchValid( const MapBatch *batch, int key )
 {
-   gl_debugGroupStart();
+   return ( batch->gen == map_gen ) && ( batch->key == key );
+}
+
+/**
+ * @brief Uploads the vertices of a retained batch.
+ */
+static void map_batchUpload( MapBatch *batch, const void *data, int n,
+                             size_t size, const char *name )
+{
+   batch->n = n;
+   if ( n <= 0 )
+      return;
+   if ( batch->vbo == NULL ) {
+      batch->vbo = gl_vboCreateStatic( n * size, data );
+      gl_vboLabel( batch->vbo, name );
+   } else
+      gl_vboData( batch->vbo, n * size, data );
+}
+
+/**
+ * @brief Adds a quad as two triangles to the lane vertices.
+ */
+static void map_batchLaneQuad( MapLaneVertex **verts, const MapLaneVertex *v )
+{
+   static const GLfloat quad[6][2] = { { -1., -1. }, { 1., -1. }, { -1., 1. },
+                                       { -1., 1. },  { 1., -1. }, { 1., 1. } };
+   for ( int i = 0; i < 6; i++ ) {
+      MapLaneVertex *o = &array_grow( verts );
+      *o               = *v;
+      o->vertex[0]     = quad[i][0];
+      o->vertex[1]     = quad[i][1];
+   }
+}
+
+/**
+ * @brief Adds a quad as two triangles to the system vertices.
+ */
+static void map_batchSysQuad( MapSysVertex **verts, const MapSysVertex *v )
+{
+   static const GLfloat quad[6][2] = { { -1., -1. }, { 1., -1. }, { -1., 1. },
+                                       { -1., 1. },  { 1., -1. }, { 1., 1. } };
+   for ( int i = 0; i < 6; i++ ) {
+      MapSysVertex *o = &array_grow( verts );
+      *o              = *v;
+      o->vertex[0]    = quad[i][0];
+      o->vertex[1]    = quad[i][1];
+   }
+}
+
+/**
+ * @brief Rebuilds the jump lane geometry.
+ */
+static void map_batchBuildJumps( MapBatch *batch, int editor )
+{
+   MapLaneVertex *verts = array_create( MapLaneVertex );
+
    for ( int i = 0; i < array_size( systems_stack ); i++ ) {
-      double            x1, y1;
       const StarSystem *sys = system_getIndex( i );
 
       if ( !map_shouldRenderSys( sys, editor ) )
          continue; /* we don't draw hyperspace lines */
 
-      x1 = x + sys->pos.x * zoom;
-      y1 = y + sys->pos.y * zoom;
-
       for ( int j = 0; j < array_size( sys->jumps ); j++ ) {
-         double            x2, y2, rx, ry, r, rw, rh;
+         MapLaneVertex     v;
+         double            rx, ry, d;
          const glColour   *col, *cole;
          const StarSystem *jsys = sys->jumps[j].target;
          if ( sys_isFlag( jsys, SYSTEM_HIDDEN ) )
@@ -1399,39 +1545,115 @@ void map_renderJumps( double x, double y, double zoom, double radius,
          else
             col = &cAquaBlue;
 
-         x2 = x + jsys->pos.x * zoom;
-         y2 = y + jsys->pos.y * zoom;
-         rx = x2 - x1;
-         ry = y2 - y1;
-         r  = atan2( ry, rx );
-         rw = MOD( rx, ry ) / 2.;
+         rx = jsys->pos.x - sys->pos.x;
+         ry = jsys->pos.y - sys->pos.y;
+         d  = MOD( rx, ry );
+         if ( d <= 0. )
+            continue;
 
+         v.centre[0] = ( sys->pos.x + jsys->pos.x ) / 2.;
+         v.centre[1] = ( sys->pos.y + jsys->pos.y ) / 2.;
+         v.dir[0]    = rx / d;
+         v.dir[1]    = ry / d;
+         v.size[0]   = d / 2.;
          if ( sys->jumps[j].hide <= 0. ) {
-            col = &cGreen;
-            rh  = 2.5;
+            col       = &cGreen;
+            v.size[1] = 2.5;
          } else {
-            rh = 1.5;
+            v.size[1] = 1.5;
          }
-
-         glUseProgram( shaders.jumplane.program );
-         gl_uniformColour( shaders.jumplane.paramv, cole );
-         glUniform1f( shaders.jumplane.paramf, radius );
-         gl_renderShader( ( x1 + x2 ) / 2., ( y1 + y2 ) / 2., rw, rh, r,
-                          &shaders.jumplane, col, 1 );
+         memcpy( v.colour, col, sizeof( v.colour ) );
+         memcpy( v.colour2, cole, sizeof( v.colour2 ) );
+         map_batchLaneQuad( &verts, &v );
       }
    }
-   gl_debugGroupEnd();
+
+   map_batchUpload( batch, verts, array_size( verts ), sizeof( MapLaneVertex ),
+                    "Map Lanes VBO" );
+   batch->gen = map_gen;
+   batch->key = editor;
+   array_free( verts );
 }
 
 /**
- * @brief Renders the systems.
+ * @brief Renders the jump routes between systems.
  */
-void map_renderSystems( double bx, double by, double x, double y, double zoom,
-                        double w, double h, double r, MapMode mode )
+void map_renderJumps( double x, double y, double zoom, double radius,
+                      int editor )
 {
+   mat4      projection;
+   MapBatch *batch = &map_views[editor != 0].lanes;
+
+   if ( !map_batchValid( batch, editor ) )
+      map_batchBuildJumps( batch, editor );
+   if ( batch->n <= 0 )
+      return;
+
    gl_debugGroupStart();
+   projection = gl_view_matrix;
+   mat4_translate_xy( &projection, x, y );
+
+   glUseProgram( shaders.maplanes.program );
+   gl_uniformMat4( shaders.maplanes.projection, &projection );
+   glUniform1f( shaders.maplanes.zoom, zoom );
+   glUniform1f( shaders.maplanes.radius, radius );
+
+   glEnableVertexAttribArray( shaders.maplanes.centre );
+   glEnableVertexAttribArray( shaders.maplanes.dir );
+   glEnableVertexAttribArray( shaders.maplanes.vertex );
+   glEnableVertexAttribArray( shaders.maplanes.size );
+   glEnableVertexAttribArray( shaders.maplanes.colour_start );
+   glEnableVertexAttribArray( shaders.maplanes.colour_end );
+   gl_vboActivateAttribOffset(
+      batch->vbo, shaders.maplanes.centre,
+      offsetof( MapLaneVertex, centre ), 2, GL_FLOAT, sizeof( MapLaneVertex ) );
+   gl_vboActivateAttribOffset(
+      batch->vbo, shaders.maplanes.dir, offsetof( MapLaneVertex, dir ),
+      2, GL_FLOAT, sizeof( MapLaneVertex ) );
+   gl_vboActivateAttribOffset(
+      batch->vbo, shaders.maplanes.vertex,
+      offsetof( MapLaneVertex, vertex ), 2, GL_FLOAT, sizeof( MapLaneVertex ) );
+   gl_vboActivateAttribOffset(
+      batch->vbo, shaders.maplanes.size,
+      offsetof( MapLaneVertex, size ), 2, GL_FLOAT, sizeof( MapLaneVertex ) );
+   gl_vboActivateAttribOffset(
+      batch->vbo, shaders.maplanes.colour_start,
+      offsetof( MapLaneVertex, colour ), 4, GL_FLOAT, sizeof( MapLaneVertex ) );
+   gl_vboActivateAttribOffset(
+      batch->vbo, shaders.maplanes.colour_end,
+      offsetof( MapLaneVertex, colour2 ), 4, GL_FLOAT, sizeof( MapLaneVertex ) );
+
+   glDrawArrays( GL_TRIANGLES, 0, batch->n );
+
+   glDisableVertexAttribArray( shaders.maplanes.centre );
+   glDisableVertexAttribArray( shaders.maplanes.dir );
+   glDisableVertexAttribArray( shaders.maplanes.vertex );
+   glDisableVertexAttribArray( shaders.maplanes.size );
+   glDisableVertexAttribArray( shaders.maplanes.colour_start );
+   glDisableVertexAttribArray( shaders.maplanes.colour_end );
+   glUseProgram( 0 );
+   gl_checkErr();
+   gl_debugGroupEnd();
+}
+
+/**
+ * @brief Rebuilds the system geometry.
+ *
+ * The vertices of each system are kept together so that the systems that are
+ * out of bounds can be skipped when drawing.
+ */
+static void map_batchBuildSystems( MapView *view, MapMode mode )
+{
+   MapSysVertex *verts = array_create( MapSysVertex );
+   int           n;
+
+   if ( view->sysranges == NULL )
+      view->sysranges = array_create( MapSysRange );
+   array_resize( &view->sysranges, 0 );
+
    for ( int i = 0; i < array_size( systems_stack ); i++ ) {
-      double            tx, ty;
+      MapSysVertex      v;
+      MapSysRange      *range;
       const StarSystem *sys = system_getIndex( i );
 
       if ( sys_isFlag( sys, SYSTEM_HIDDEN ) )
@@ -1444,17 +1666,20 @@ void map_renderSystems( double bx, double by, double x, double y, double zoom,
            !space_sysReachable( sys ) )
          continue;
 
-      tx = x + sys->pos.x * zoom;
-      ty = y + sys->pos.y * zoom;
-
-      /* Skip if out of bounds. */
-      if ( !rectOverlap( tx - r, ty - r, 2. * r, 2. * r, bx, by, w, h ) )
-         continue;
+      range        = &array_grow( &view->sysranges );
+      range->id    = i;
+      range->first = array_size( verts );
+      v.centre[0]  = sys->pos.x;
+      v.centre[1]  = sys->pos.y;
 
       /* Draw an outer ring. */
       if ( mode == MAPMODE_EDITOR || mode == MAPMODE_TRAVEL ||
-           mode == MAPMODE_TRADE )
-         gl_renderCircle( tx, ty, r, &cInert, 0 );
+           mode == MAPMODE_TRADE ) {
+         v.size   = 1.;
+         v.filled = 0.;
+         memcpy( v.colour, &cInert, sizeof( v.colour ) );
+         map_batchSysQuad( &verts, &v );
+      }
 
       /* Ignore not known systems when not in the editor. */
       if ( mode != MAPMODE_EDITOR && !sys_isKnown( sys ) )
@@ -1492,20 +1717,130 @@ void map_renderSystems( double bx, double by, double x, double y, double zoom,
          else
             col = &cNeutral;
 
-         double size;
          if ( !sys_isFlag( sys, SYSTEM_HAS_INHABITED ) )
-            size = 0.3;
+            v.size = 0.3;
          else
-            size = 0.65;
-
-         gl_renderCircle( tx, ty, size * r, col, 1 );
+            v.size = 0.65;
+         v.filled = 1.;
+         memcpy( v.colour, col, sizeof( v.colour ) );
+         map_batchSysQuad( &verts, &v );
 
       } else if ( mode == MAPMODE_DISCOVER ) {
-         gl_renderCircle( tx, ty, r, &cInert, 0 );
-         if ( sys_isFlag( sys, SYSTEM_DISCOVERED ) )
-            gl_renderCircle( tx, ty, 0.65 * r, &cGreen, 1 );
+         v.size   = 1.;
+         v.filled = 0.;
+         memcpy( v.colour, &cInert, sizeof( v.colour ) );
+         map_batchSysQuad( &verts, &v );
+         if ( sys_isFlag( sys, SYSTEM_DISCOVERED ) ) {
+            v.size   = 0.65;
+            v.filled = 1.;
+            memcpy( v.colour, &cGreen, sizeof( v.colour ) );
+            map_batchSysQuad( &verts, &v );
+         }
       }
    }
+
+   /* Count the vertices of each system, dropping the ones without any. */
+   n = 0;
+   for ( int i = 0; i < array_size( view->sysranges ); i++ ) {
+      MapSysRange range = view->sysranges[i];
+      int         end   = ( i + 1 < array_size( view->sysranges ) )
+                             ? view->sysranges[i + 1].first
+                             : array_size( verts );
+      range.n           = end - range.first;
+      if ( range.n > 0 )
+         view->sysranges[n++] = range;
+   }
+   array_resize( &view->sysranges, n );
+
+   map_batchUpload( &view->systems, verts, array_size( verts ),
+                    sizeof( MapSysVertex ), "Map Systems VBO" );
+   view->systems.gen = map_gen;
+   view->systems.key = mode;
+   array_free( verts );
+}
+
+/**
+ * @brief Renders the systems.
+ */
+void map_renderSystems( double bx, double by, double x, double y, double zoom,
+                        double w, double h, double r, MapMode mode )
+{
+   mat4     projection;
+   MapView *view = &map_views[mode == MAPMODE_EDITOR];
+
+   if ( !map_batchValid( &view->systems, mode ) )
+      map_batchBuildSystems( view, mode );
+
+   /* Only draw the systems in bounds, merging the ones that are next to each
+    * other in the buffer. */
+   if ( map_draw_first == NULL ) {
+      map_draw_first = array_create( GLint );
+      map_draw_count = array_create( GLsizei );
+   }
+   array_resize( &map_draw_first, 0 );
+   array_resize( &map_draw_count, 0 );
+   for ( int i = 0; i < array_size( view->sysranges ); i++ ) {
+      const MapSysRange *range = &view->sysranges[i];
+      const StarSystem  *sys   = system_getIndex( range->id );
+      double             tx    = x + sys->pos.x * zoom;
+      double             ty    = y + sys->pos.y * zoom;
+      int                last  = array_size( map_draw_first ) - 1;
+
+      /* Skip if out of bounds. */
+      if ( !rectOverlap( tx - r, ty - r, 2. * r, 2. * r, bx, by, w, h ) )
+         continue;
+
+      if ( ( last >= 0 ) &&
+           ( map_draw_first[last] + map_draw_count[last] == range->first ) )
+         map_draw_count[last] += range->n;
+      else {
+         array_push_back( &map_draw_first, range->first );
+         array_push_back( &map_draw_count, range->n );
+      }
+   }
+   if ( array_size( map_draw_first ) <= 0 )
+      return;
+
+   gl_debugGroupStart();
+   projection = gl_view_matrix;
+   mat4_translate_xy( &projection, x, y );
+
+   glUseProgram( shaders.mapsystems.program );
+   gl_uniformMat4( shaders.mapsystems.projection, &projection );
+   glUniform1f( shaders.mapsystems.zoom, zoom );
+   glUniform1f( shaders.mapsystems.radius, r );
+
+   glEnableVertexAttribArray( shaders.mapsystems.centre );
+   glEnableVertexAttribArray( shaders.mapsystems.vertex );
+   glEnableVertexAttribArray( shaders.mapsystems.size );
+   glEnableVertexAttribArray( shaders.mapsystems.filled );
+   glEnableVertexAttribArray( shaders.mapsystems.vertex_colour );
+   gl_vboActivateAttribOffset(
+      view->systems.vbo, shaders.mapsystems.centre,
+      offsetof( MapSysVertex, centre ), 2, GL_FLOAT, sizeof( MapSysVertex ) );
+   gl_vboActivateAttribOffset(
+      view->systems.vbo, shaders.mapsystems.vertex,
+      offsetof( MapSysVertex, vertex ), 2, GL_FLOAT, sizeof( MapSysVertex ) );
+   gl_vboActivateAttribOffset(
+      view->systems.vbo, shaders.mapsystems.size,
+      offsetof( MapSysVertex, size ), 1, GL_FLOAT, sizeof( MapSysVertex ) );
+   gl_vboActivateAttribOffset(
+      view->systems.vbo, shaders.mapsystems.filled,
+      offsetof( MapSysVertex, filled ), 1, GL_FLOAT, sizeof( MapSysVertex ) );
+   gl_vboActivateAttribOffset(
+      view->systems.vbo, shaders.mapsystems.vertex_colour,
+      offsetof( MapSysVertex, colour ), 4, GL_FLOAT, sizeof( MapSysVertex ) );
+
+   glMultiDrawArrays( GL_TRIANGLES, map_draw_first, map_draw_count,
+                      array_size( map_draw_first ) );
+
+   glDisableVertexAttribArray( shaders.mapsystems.centre );
+   glDisableVertexAttribArray( shaders.mapsystems.vertex );
+   glDisableVertexAttribArray( shaders.mapsystems.size );
+   glDisableVertexAttribArray( shaders.mapsystems.filled );
+   glDisableVertexAttribArray( shaders.mapsystems.vertex_colour );
+   glUseProgram( 0 );
+   gl_checkErr();
    gl_debugGroupEnd();
 }
 
@@ -1637,21 +1972,42 @@ void map_renderNames( double bx, double by, double x, double y, double zoom,
    char     buf[32];
    glColour col;
    glFont  *font;
+   MapView *view = &map_views[editor != 0];
 
    if ( zoom <= 0.5 )
       return;
 
-   gl_debugGroupStart();
-   for ( int i = 0; i < array_size( systems_stack ); i++ ) {
-      const StarSystem *sys = system_getIndex( i );
+   /* Only recompute the list of names and their widths when needed. */
+   if ( ( view->labels == NULL ) || ( view->labels_gen != map_gen ) ) {
+      if ( view->labels == NULL )
+         view->labels = array_create( MapLabel );
+      array_resize( &view->labels, 0 );
+      for ( int i = 0; i < array_size( systems_stack ); i++ ) {
+         MapLabel         *l;
+         const StarSystem *sys = system_getIndex( i );
 
-      /* Skip system. */
-      if ( !map_shouldRenderSys( sys, editor ) && !sys_isKnown( sys ) )
-         continue;
+         /* Skip system. */
+         if ( !map_shouldRenderSys( sys, editor ) && !sys_isKnown( sys ) )
+            continue;
 
-      font = ( zoom >= 1.5 ) ? &gl_defFont : &gl_smallFont;
+         l          = &array_grow( &view->labels );
+         l->id      = i;
+         l->w_def   = gl_printWidthRaw( &gl_defFont, system_name( sys ) );
+         l->w_small = gl_printWidthRaw( &gl_smallFont, system_name( sys ) );
+      }
+      view->labels_gen = map_gen;
+   }
+
+   font  = ( zoom >= 1.5 ) ? &gl_defFont : &gl_smallFont;
+   col   = cWhite;
+   col.a = alpha;
+
+   gl_debugGroupStart();
+   for ( int i = 0; i < array_size( view->labels ); i++ ) {
+      const MapLabel   *l   = &view->labels[i];
+      const StarSystem *sys = system_getIndex( l->id );
 
-      textw = gl_printWidthRaw( font, system_name( sys ) );
+      textw = ( font == &gl_defFont ) ? l->w_def : l->w_small;
       tx    = x + ( sys->pos.x + 12. ) * zoom;
       ty    = y + ( sys->pos.y ) * zoom - font->h * 0.5;
 
@@ -1659,8 +2015,6 @@ void map_renderNames( double bx, double by, double x, double y, double zoom,
       if ( !rectOverlap( tx, ty, textw, font->h, bx, by, w, h ) )
          continue;
 
-      col   = cWhite;
-      col.a = alpha;
       gl_printRaw( font, tx, ty, &col, -1, system_name( sys ) );
    }
    gl_debugGroupEnd();
@@ -1794,8 +2148,9 @@ static void map_renderSysBlack( double bx, double by, double x, double y,
 void map_renderCommod( double bx, double by, double x, double y, double zoom,
                        double w, double h, double r, int editor, double a )
 {
-   CommodityRef c;
-   glColour     ccol;
+   CommodityRef              c;
+   glColour                  ccol;
+   const EconomyKnownPrices *known;
 
    /* If not plotting commodities, return */
    if ( ( cur_commod == -1 ) || ( map_selected == -1 ) ||
@@ -1810,6 +2165,7 @@ void map_renderCommod( double bx, double by, double x, double y, double zoom,
          system, and if landed, then get price of commodity where we are */
       curMaxPrice = 0.;
       curMinPrice = 0.;
+      known = economy_getKnownPrices( c );
       if ( sys == cur_system && landed ) {
          int k;
          for ( k = 0; k < array_size( land_spob->commodities ); k++ ) {
@@ -1832,31 +2188,13 @@ void map_renderCommod( double bx, double by, double x, double y, double zoom,
          /* not currently landed, so get max and min price in the selected
           * system. */
          if ( ( sys_isKnown( sys ) ) && ( system_hasSpob( sys ) ) ) {
-            double minPrice = HUGE_VAL;
-            double maxPrice = 0;
-            for ( int j = 0; j < array_size( sys->spobs ); j++ ) {
-               Spob *p = sys->spobs[j];
-               for ( int k = 0; k < array_size( p->commodities ); k++ ) {
-                  double thisPrice;
-                  if ( p->commodities[k] != c )
-                     continue;
-                  if ( p->commodityPrice[k].cnt <=
-                       0 ) /* commodity is not known about */
-                     continue;
-                  thisPrice =
-                     p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
-                  maxPrice = MAX( thisPrice, maxPrice );
-                  minPrice = MIN( thisPrice, minPrice );
-                  break;
-               }
-            }
-            if ( maxPrice == 0 ) { /* no prices are known here */
+            if ( known->cnt[map_selected] <= 0 ) { /* no prices are known here */
                map_renderCommodIgnorance( x, y, zoom, sys, c, a );
                map_renderSysBlack( bx, by, x, y, zoom, w, h, r, editor );
                return;
             }
-            curMaxPrice = maxPrice;
-            curMinPrice = minPrice;
+            curMaxPrice = known->max[map_selected];
+            curMinPrice = known->min[map_selected];
          } else {
             map_renderCommodIgnorance( x, y, zoom, sys, c, a );
             map_renderSysBlack( bx, by, x, y, zoom, w, h, r, editor );
@@ -1887,30 +2225,11 @@ void map_renderCommod( double bx, double by, double x, double y, double zoom,
 
          /* If system is known fill it. */
          if ( ( sys_isKnown( sys ) ) && ( system_hasSpob( sys ) ) ) {
-            double minPrice = HUGE_VAL;
-            double maxPrice = 0;
-            for ( int j = 0; j < array_size( sys->spobs ); j++ ) {
-               Spob *p = sys->spobs[j];
-               for ( int k = 0; k < array_size( p->commodities ); k++ ) {
-                  double thisPrice;
-                  if ( p->commodities[k] != c )
-                     continue;
-                  if ( p->commodityPrice[k].cnt <=
-                       0 ) /*commodity is not known about */
-                     continue;
-                  thisPrice =
-                     p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
-                  maxPrice = MAX( thisPrice, maxPrice );
-                  minPrice = MIN( thisPrice, minPrice );
-                  break;
-               }
-            }
-
             /* Calculate best and worst profits */
-            if ( maxPrice > 0 ) {
+            if ( known->cnt[i] > 0 ) {
                /* Commodity sold at this system */
-               double best  = maxPrice - curMinPrice;
-               double worst = minPrice - curMaxPrice;
+               double best  = known->max[i] - curMinPrice;
+               double worst = known->min[i] - curMaxPrice;
                if ( best >= 0 ) { /* draw circle above */
                   ccol   = cLightBlue;
                   ccol.a = a;
@@ -1946,6 +2265,7 @@ void map_renderCommod( double bx, double by, double x, double y, double zoom,
       /* First calculate av price in all systems
        * This has already been done in map_update_commod_av_price
        * Now display the costs */
+      known = economy_getKnownPrices( c );
       for ( int i = 0; i < array_size( systems_stack ); i++ ) {
          double      tx, ty;
          StarSystem *sys = system_getIndex( i );
@@ -1970,30 +2290,11 @@ void map_renderCommod( double bx, double by, double x, double y, double zoom,
 
          /* If system is known fill it. */
          if ( ( sys_isKnown( sys ) ) && ( system_hasSpob( sys ) ) ) {
-            double sumPrice = 0;
-            int    sumCnt   = 0;
-            for ( int j = 0; j < array_size( sys->spobs ); j++ ) {
-               Spob *p = sys->spobs[j];
-               for ( int k = 0; k < array_size( p->commodities ); k++ ) {
-                  double thisPrice;
-                  if ( p->commodities[k] != c )
-                     continue;
-                  if ( p->commodityPrice[k].cnt <=
-                       0 ) /* commodity is not known about */
-                     continue;
-                  thisPrice =
-                     p->commodityPrice[k].sum / p->commodityPrice[k].cnt;
-                  sumPrice += thisPrice;
-                  sumCnt += 1;
-                  break;
-               }
-            }
-
-            if ( sumCnt > 0 ) {
+            if ( known->cnt[i] > 0 ) {
                /* Commodity sold at this system */
                /* Colour as a % of global average */
                double frac;
-               sumPrice /= sumCnt;
+               double sumPrice = known->mean[i];
                if ( sumPrice < commod_av_gal_price ) {
                   frac = tanh( 5 * ( commod_av_gal_price / sumPrice - 1 ) );
                   col_blend( &ccol, &cFontOrange, &cFontYellow, frac );
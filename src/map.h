@@ -52,6 +52,7 @@ void               map_toggleNotes( void );
 void               map_cleanup( void );
 void               map_clear( void );
 void               map_jump( void );
+void               map_invalidate( void );
 
 /* manipulate universe stuff */
 StarSystem **map_getJumpPath( StarSystem *sysstart, const vec2 *posstart,
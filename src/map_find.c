@@ -17,10 +17,34 @@
 #include "space.h"
 #include "tech.h"
 #include "toolkit.h"
+#include "utf8.h"
 
 #define BUTTON_WIDTH 120 /**< Map button width. */
 #define BUTTON_HEIGHT 30 /**< Map button height. */
 
+#define MAP_FIND_NGRAM 3 /**< Length of the n-grams used for fuzzy search. */
+#define MAP_FIND_NGRAM_BUCKETS                                                 \
+   4096 /**< Number of n-gram buckets, must be a power of 2. */
+
+/**
+ * @brief N-gram index used to speed up fuzzy searching of outfits and ships.
+ *
+ * The searchable text of each item is lower-cased and split into n-grams that
+ * are hashed into buckets. Searches only have to check the items in the
+ * smallest bucket of the n-grams of the search string.
+ *
+ * Only ASCII is lower-cased, so the n-grams only work for ASCII search
+ * strings. Other search strings fall back to SDL_strcasestr on every item.
+ */
+typedef struct map_findIndex_s {
+   const char **names; /**< Array (array.h): Internal names of the items. */
+   char       **text;  /**< Array (array.h): Lower-cased searchable text. */
+   int *buckets[MAP_FIND_NGRAM_BUCKETS]; /**< Arrays (array.h) of the items
+                                            containing n-grams per bucket. */
+   int *folded; /**< Array (array.h): Items with characters that case fold
+                   to ASCII, which have to always be checked. */
+} map_findIndex_t;
+
 /* Stored checkbox values. */
 static int map_find_systems = 1; /**< Systems checkbox value. */
 static int map_find_spobs   = 0; /**< Spobs checkbox value. */
@@ -39,6 +63,10 @@ static tech_group_t **map_known_techs =
    NULL; /**< Array (array.h) of known techs. */
 static Spob **map_known_spobs =
    NULL; /**< Array (array.h) of known spobs with techs. */
+static map_findIndex_t *map_outfit_index =
+   NULL; /**< Fuzzy search index of the known outfits. */
+static map_findIndex_t *map_ship_index =
+   NULL; /**< Fuzzy search index of the known ships. */
 
 /*
  * Prototypes.
@@ -72,10 +100,15 @@ static void map_sortFound( map_find_t *found, int n );
 static char map_getSpobColourChar( Spob *p );
 static const char *map_getSpobSymbol( Spob *p );
 /* Fuzzy outfit/ship stuff. */
-static char **map_fuzzyOutfits( Outfit **o, const char *name );
-static char **map_outfitsMatch( const char *name );
-static char **map_fuzzyShips( Ship **o, const char *name );
-static char **map_shipsMatch( const char *name );
+static map_findIndex_t *map_indexCreate( void );
+static void map_indexAdd( map_findIndex_t *idx, const char *name,
+                          const char **fields, int nfields );
+static void map_indexFree( map_findIndex_t *idx );
+static char **map_indexMatch( const map_findIndex_t *idx, const char *name );
+static map_findIndex_t *map_indexOutfits( Outfit **o );
+static char           **map_outfitsMatch( const char *name );
+static map_findIndex_t *map_indexShips( Ship **s );
+static char           **map_shipsMatch( const char *name );
 
 /**
  * @brief Initializes stuff the pilot knows.
@@ -115,6 +148,10 @@ static void map_knownClean( void )
    map_known_techs = NULL;
    array_free( map_known_spobs );
    map_known_spobs = NULL;
+   map_indexFree( map_outfit_index );
+   map_outfit_index = NULL;
+   map_indexFree( map_ship_index );
+   map_ship_index = NULL;
 }
 
 /**
@@ -529,44 +566,231 @@ static const char *map_getSpobSymbol( Spob *p )
 }
 
 /**
- * @brief Does fuzzy name matching for outfits in an Array. Searches translated
- * names but returns internal names.
+ * @brief Hashes an n-gram into its bucket.
  */
-static char **map_fuzzyOutfits( Outfit **o, const char *name )
+static int map_indexBucket( const char *str )
 {
-   char **names = array_create( char * );
+   unsigned int h = 0;
+   for ( int i = 0; i < MAP_FIND_NGRAM; i++ )
+      h = h * 31 + (unsigned char)str[i];
+   return h & ( MAP_FIND_NGRAM_BUCKETS - 1 );
+}
 
-   /* Do fuzzy search. */
-   for ( int i = 0; i < array_size( o ); i++ ) {
-      if ( SDL_strcasestr( outfit_name( o[i] ), name ) != NULL )
-         array_push_back( &names, (char *)outfit_rawname( o[i] ) );
-      else if ( SDL_strcasestr( outfit_getType( o[i] ), name ) != NULL )
-         array_push_back( &names, (char *)outfit_rawname( o[i] ) );
-      else if ( ( outfit_condstr( o[i] ) != NULL ) &&
-                SDL_strcasestr( outfit_condstr( o[i] ), name ) != NULL )
-         array_push_back( &names, (char *)outfit_rawname( o[i] ) );
-      else if ( SDL_strcasestr( outfit_description( o[i] ), name ) != NULL )
-         array_push_back( &names, (char *)outfit_rawname( o[i] ) );
-      else if ( SDL_strcasestr( outfit_summary( o[i], 0 ), name ) != NULL )
-         array_push_back( &names, (char *)outfit_rawname( o[i] ) );
+/**
+ * @brief Lower-cases the ASCII characters of a string in place.
+ */
+static void map_indexLower( char *str )
+{
+   for ( char *c = str; *c != '\0'; c++ )
+      *c = SDL_tolower( (unsigned char)*c );
+}
+
+/**
+ * @brief Checks to see if a string only has ASCII characters.
+ */
+static int map_indexIsASCII( const char *str )
+{
+   for ( const char *c = str; *c != '\0'; c++ )
+      if ( (unsigned char)*c >= 0x80 )
+         return 0;
+   return 1;
+}
+
+/**
+ * @brief Checks to see if a string has characters that case fold to ASCII,
+ * like the Kelvin sign or the "fi" ligature.
+ *
+ * These match ASCII search strings without sharing any n-grams with them.
+ */
+static int map_indexFoldsToASCII( const char *str )
+{
+   size_t   i = 0;
+   uint32_t ch;
+   while ( ( ch = u8_nextchar( str, &i ) ) ) {
+      if ( ( ch == 0x00DF ) || ( ch == 0x0130 ) || ( ch == 0x0149 ) ||
+           ( ch == 0x017F ) || ( ch == 0x01F0 ) ||
+           ( ( ch >= 0x1E96 ) && ( ch <= 0x1E9A ) ) || ( ch == 0x1E9E ) ||
+           ( ch == 0x212A ) || ( ( ch >= 0xFB00 ) && ( ch <= 0xFB06 ) ) )
+         return 1;
+   }
+   return 0;
+}
+
+/**
+ * @brief Creates an empty fuzzy search index.
+ */
+static map_findIndex_t *map_indexCreate( void )
+{
+   map_findIndex_t *idx = calloc( 1, sizeof( map_findIndex_t ) );
+   idx->names           = array_create( const char * );
+   idx->text            = array_create( char * );
+   idx->folded          = array_create( int );
+   return idx;
+}
+
+/**
+ * @brief Adds an item to a fuzzy search index.
+ *
+ *    @param idx Index to add to.
+ *    @param name Internal name of the item.
+ *    @param fields Searchable strings of the item, NULL entries are ignored.
+ *    @param nfields Number of fields.
+ */
+static void map_indexAdd( map_findIndex_t *idx, const char *name,
+                          const char **fields, int nfields )
+{
+   int   id = array_size( idx->names );
+   char *text;
+   int   l = 0;
+
+   /* Fields are separated by newlines so no match can span two of them. */
+   for ( int i = 0; i < nfields; i++ )
+      if ( fields[i] != NULL )
+         l += strlen( fields[i] ) + 1;
+   text = malloc( l + 1 );
+   l    = 0;
+   for ( int i = 0; i < nfields; i++ ) {
+      int n;
+      if ( fields[i] == NULL )
+         continue;
+      n = strlen( fields[i] );
+      memcpy( &text[l], fields[i], n );
+      l += n;
+      text[l++] = '\n';
+   }
+   text[l] = '\0';
+   map_indexLower( text );
+
+   array_push_back( &idx->names, name );
+   array_push_back( &idx->text, text );
+   if ( !map_indexIsASCII( text ) && map_indexFoldsToASCII( text ) ) {
+      array_push_back( &idx->folded, id );
+      return;
+   }
+
+   for ( int i = 0; i + MAP_FIND_NGRAM <= l; i++ ) {
+      int **b;
+      if ( memchr( &text[i], '\n', MAP_FIND_NGRAM ) != NULL )
+         continue;
+      b = &idx->buckets[map_indexBucket( &text[i] )];
+      if ( *b == NULL )
+         *b = array_create( int );
+      else if ( array_back( *b ) == id )
+         continue;
+      array_push_back( b, id );
    }
+}
 
+/**
+ * @brief Frees a fuzzy search index.
+ */
+static void map_indexFree( map_findIndex_t *idx )
+{
+   if ( idx == NULL )
+      return;
+   for ( int i = 0; i < array_size( idx->text ); i++ )
+      free( idx->text[i] );
+   array_free( idx->text );
+   array_free( idx->names );
+   array_free( idx->folded );
+   for ( int i = 0; i < MAP_FIND_NGRAM_BUCKETS; i++ )
+      array_free( idx->buckets[i] );
+   free( idx );
+}
+
+/**
+ * @brief Gets the internal names of the items matching a string.
+ *
+ * Equivalent to checking each field with SDL_strcasestr, but for ASCII search
+ * strings only the items sharing the least common n-gram with the search
+ * string are checked.
+ */
+static char **map_indexMatch( const map_findIndex_t *idx, const char *name )
+{
+   char     **names = array_create( char * );
+   char      *lower = strdup( ( name != NULL ) ? name : "" );
+   int        l     = strlen( lower );
+   const int *cand  = NULL;
+   int        ncand = array_size( idx->names );
+
+   /* Characters outside of ASCII need proper case folding, and search strings
+    * shorter than an n-gram can't use the buckets. */
+   if ( ( l < MAP_FIND_NGRAM ) || !map_indexIsASCII( lower ) ) {
+      for ( int i = 0; i < ncand; i++ )
+         if ( SDL_strcasestr( idx->text[i], lower ) != NULL )
+            array_push_back( &names, (char *)idx->names[i] );
+      free( lower );
+      return names;
+   }
+
+   map_indexLower( lower );
+
+   /* Items that aren't in the n-gram buckets. */
+   for ( int i = 0; i < array_size( idx->folded ); i++ ) {
+      int id = idx->folded[i];
+      if ( SDL_strcasestr( idx->text[id], lower ) != NULL )
+         array_push_back( &names, (char *)idx->names[id] );
+   }
+
+   /* Find the smallest bucket, an empty one means no matches. */
+   for ( int i = 0; i + MAP_FIND_NGRAM <= l; i++ ) {
+      const int *b = idx->buckets[map_indexBucket( &lower[i] )];
+      if ( array_size( b ) <= ncand ) {
+         cand  = b;
+         ncand = array_size( b );
+      }
+      if ( ncand == 0 )
+         break;
+   }
+
+   for ( int i = 0; i < ncand; i++ ) {
+      int id = cand[i];
+      if ( strstr( idx->text[id], lower ) != NULL )
+         array_push_back( &names, (char *)idx->names[id] );
+   }
+
+   free( lower );
    return names;
 }
 
+/**
+ * @brief Creates the fuzzy search index for outfits in an Array. Searches
+ * translated names but returns internal names.
+ */
+static map_findIndex_t *map_indexOutfits( Outfit **o )
+{
+   map_findIndex_t *idx = map_indexCreate();
+   for ( int i = 0; i < array_size( o ); i++ ) {
+      char       *desc = strdup( outfit_description( o[i] ) );
+      const char *fields[5];
+      fields[0] = outfit_name( o[i] );
+      fields[1] = outfit_getType( o[i] );
+      fields[2] = outfit_condstr( o[i] );
+      fields[3] = desc;
+      fields[4] = outfit_summary( o[i], 0 );
+      map_indexAdd( idx, outfit_rawname( o[i] ), fields, 5 );
+      free( desc );
+   }
+   return idx;
+}
+
 /**
  * @brief Gets the possible names the outfit name matches.
  */
 static char **map_outfitsMatch( const char *name )
 {
-   Outfit **o;
-   char   **names;
+   char **names;
+
+   /* Index the known outfits on first search. */
+   if ( map_outfit_index == NULL ) {
+      Outfit **o = tech_getOutfitArray( map_known_techs,
+                                        array_size( map_known_techs ), 1 );
+      map_outfit_index = map_indexOutfits( o );
+      array_free( o );
+   }
 
-   /* Get outfits and names. */
-   o = tech_getOutfitArray( map_known_techs, array_size( map_known_techs ), 1 );
-   names = map_fuzzyOutfits( o, name );
+   names = map_indexMatch( map_outfit_index, name );
    qsort( names, array_size( names ), sizeof( char * ), strsort );
-   array_free( o );
 
    return names;
 }
@@ -749,17 +973,11 @@ static int map_findSearchOutfits( unsigned int wid_map_find, const char *name )
    n     = 0;
    len   = array_size( map_known_techs );
    for ( int i = 0; i < len; i++ ) {
-      /* Try to find the outfit in the spob. */
-      int         j;
       Spob       *spob;
       StarSystem *sys;
-      Outfit    **olist = tech_getOutfit( map_known_techs[i], 1 );
-      for ( j = array_size( olist ) - 1; j >= 0; j-- )
-         if ( olist[j] == o )
-            break;
-      array_free( olist );
-      olist = NULL;
-      if ( j < 0 )
+
+      /* Try to find the outfit in the spob. */
+      if ( !tech_hasOutfit( map_known_techs[i], o, 1 ) )
          continue;
       spob = map_known_spobs[i];
 
@@ -792,43 +1010,40 @@ static int map_findSearchOutfits( unsigned int wid_map_find, const char *name )
 }
 
 /**
- * @brief Does fuzzy name matching for ships in an Array. Searches translated
- * names but returns internal names.
+ * @brief Creates the fuzzy search index for ships in an Array. Searches
+ * translated names but returns internal names.
  */
-static char **map_fuzzyShips( Ship **s, const char *name )
+static map_findIndex_t *map_indexShips( Ship **s )
 {
-   char **names = array_create( char * );
-
-   /* Do fuzzy search. */
+   map_findIndex_t *idx = map_indexCreate();
    for ( int i = 0; i < array_size( s ); i++ ) {
-      if ( SDL_strcasestr( ship_name( s[i] ), name ) != NULL )
-         array_push_back( &names, s[i]->name );
-      else if ( ( s[i]->license != NULL ) &&
-                SDL_strcasestr( _( s[i]->license ), name ) != NULL )
-         array_push_back( &names, s[i]->name );
-      else if ( SDL_strcasestr( _( ship_classDisplay( s[i] ) ), name ) != NULL )
-         array_push_back( &names, s[i]->name );
-      else if ( SDL_strcasestr( _( s[i]->fabricator ), name ) != NULL )
-         array_push_back( &names, s[i]->name );
-      else if ( SDL_strcasestr( _( s[i]->description ), name ) != NULL )
-         array_push_back( &names, s[i]->name );
+      const char *fields[5];
+      fields[0] = ship_name( s[i] );
+      fields[1] = ( s[i]->license != NULL ) ? _( s[i]->license ) : NULL;
+      fields[2] = _( ship_classDisplay( s[i] ) );
+      fields[3] = _( s[i]->fabricator );
+      fields[4] = _( s[i]->description );
+      map_indexAdd( idx, s[i]->name, fields, 5 );
    }
-
-   return names;
+   return idx;
 }
 /**
  * @brief Gets the possible names the ship name matches.
  */
 static char **map_shipsMatch( const char *name )
 {
-   Ship **s;
    char **names;
 
-   /* Get ships and names. */
-   s = tech_getShipArray( map_known_techs, array_size( map_known_techs ), 1 );
-   names = map_fuzzyShips( s, name );
+   /* Index the known ships on first search. */
+   if ( map_ship_index == NULL ) {
+      Ship **s = tech_getShipArray( map_known_techs,
+                                    array_size( map_known_techs ), 1 );
+      map_ship_index = map_indexShips( s );
+      array_free( s );
+   }
+
+   names = map_indexMatch( map_ship_index, name );
    qsort( names, array_size( names ), sizeof( char * ), strsort );
-   array_free( s );
 
    return names;
 }
@@ -849,7 +1064,6 @@ static int map_findSearchShips( unsigned int wid_map_find, const char *name )
    const char *sname, *sysname;
    char      **list;
    const Ship *s;
-   Ship      **slist;
 
    /* Match spob first. */
    s     = NULL;
@@ -890,16 +1104,8 @@ static int map_findSearchShips( unsigned int wid_map_find, const char *name )
    n     = 0;
    len   = array_size( map_known_techs );
    for ( int i = 0; i < len; i++ ) {
-      int j;
-
       /* Try to find the ship in the spob. */
-      slist = tech_getShip( map_known_techs[i], 1 );
-      for ( j = array_size( slist ) - 1; j >= 0; j-- )
-         if ( slist[j] == s )
-            break;
-      array_free( slist );
-      slist = NULL;
-      if ( j < 0 )
+      if ( !tech_hasShip( map_known_techs[i], s, 1 ) )
          continue;
       spob = map_known_spobs[i];
 
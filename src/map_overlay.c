@@ -19,6 +19,7 @@
 #include "opengl.h"
 #include "pilot.h"
 #include "player.h"
+#include "replay.h"
 #include "safelanes.h"
 #include "space.h"
 
@@ -696,10 +697,10 @@ void ovr_key( int type )
 
          /* Refresh overlay size. */
          ovr_refresh();
-         ovr_opened = SDL_GetTicks();
+         ovr_opened = replay_getTicks();
       }
    } else if ( type < 0 ) {
-      if ( SDL_GetTicks() - ovr_opened > 300 )
+      if ( replay_getTicks() - ovr_opened > 300 )
          ovr_setOpen( 0 );
    }
 }
@@ -27,6 +27,7 @@
 
 #include "ai.h"
 #include "background.h"
+#include "bench.h"
 #include "camera.h"
 #include "cond.h"
 #include "conf.h"
@@ -38,6 +39,7 @@
 #include "event.h"
 #include "faction.h"
 #include "font.h"
+#include "gfxcache.h"
 #include "gui.h"
 #include "hook.h"
 #include "input.h"
@@ -73,13 +75,16 @@
 #include "player.h"
 #include "player_autonav.h"
 #include "plugin.h"
+#include "profiler.h"
 #include "render.h"
+#include "replay.h"
 #include "safelanes.h"
 #include "ship.h"
 #include "sound.h"
 #include "space.h"
 #include "spfx.h"
 #include "tech.h"
+#include "threadpool.h"
 #include "toolkit.h"
 #include "unidiff.h"
 #include "weapon.h"
@@ -152,6 +157,10 @@ int naev_main_setup( void )
       exit( 0 );
    }
 
+   /* Benchmarks replace the main menu and don't need the notes below. */
+   if ( bench_start() != 0 )
+      return 0;
+
    /* Incomplete translation note (shows once if we pick an incomplete
     * translation based on user's locale). */
    if ( !conf.translation_warning_seen && conf.language == NULL ) {
@@ -227,7 +236,7 @@ int naev_event_resize( Uint32 type )
 int naev_main_events( void )
 {
    SDL_Event event;
-   while ( !quit && SDL_PollEvent( &event ) ) { /* event loop */
+   while ( !quit && replay_pollEvent( &event ) ) { /* event loop */
       if ( event.type == SDL_EVENT_QUIT ) {
          SDL_FlushEvent( SDL_EVENT_QUIT ); /* flush event to prevent it from
                                           quitting when lagging a bit. */
@@ -255,6 +264,7 @@ int naev_main_cleanup( void )
    gl_freeFont( &gl_defFontMono );
 
    /* exit subsystems */
+   replay_exit();     /* Finishes writing the recording. */
    cli_exit();        /* Clean up the console. */
    map_system_exit(); /* Destroys the solar system map. */
    map_exit();        /* Destroys the map. */
@@ -270,7 +280,8 @@ int naev_main_cleanup( void )
    music_exit();      /* Kills Lua state. */
    lua_exit();        /* Closes Lua state, and invalidates all Lua. */
    // sound_exit();      /* Kills the sound */
-   gl_exit(); /* Kills video output */
+   threadpool_exit(); /* Stops the worker threads. */
+   gl_exit();         /* Kills video output */
 
    /* Has to be run last or it will mess up sound settings. */
    conf_cleanup(); /* Free some memory the configuration allocated. */
@@ -431,6 +442,8 @@ void unload_all( void )
    economy_destroy(); /* must be called before space_exit */
    space_exit();      /* cleans up the universe itself */
    tech_free();       /* Frees tech stuff. */
+   gfxcache_exit();   /* Frees the graphics cache records. */
+   profiler_exit();   /* Frees the profiler data. */
    ships_free();
    outfit_free();
    spfx_free(); /* gets rid of the special effect */
@@ -454,7 +467,9 @@ void main_loop( int nested )
       Uint64 t = SDL_GetPerformanceCounter();
       double dt =
          (double)( t - last_t ) / (double)SDL_GetPerformanceFrequency();
-      last_t  = t;
+      last_t = t;
+      replay_frame( &dt ); /* Recorded dt is used when replaying. */
+      bench_frame( &dt );  /* Benchmarks use a fixed dt. */
       real_dt = dt;
       game_dt = real_dt * dt_mod; /* Apply the modifier. */
    }
@@ -475,8 +490,10 @@ void main_loop( int nested )
 
    /* Safe hook should be run every frame regardless of whether game is paused
     * or not. */
-   if ( !nested )
+   if ( !nested ) {
       hooks_run( "safe" );
+      bench_update();
+   }
 
    /* Checks to see if we want to land. */
    space_checkLand();
@@ -484,7 +501,10 @@ void main_loop( int nested )
    /*
     * Handle render.
     */
-   if ( !quit ) { /* So if update sets up a nested main loop, we can end up in a
+   if ( !quit && ( replay_isPlaying() || bench_isRunning() ) ) {
+      /* Replays and benchmarks are run headless and as fast as possible. */
+      NTracingFrameMark;
+   } else if ( !quit ) { /* So if update sets up a nested main loop, we can end up in a
                      state where things are corrupted when trying to exit the
                      game. Avoid rendering when quitting just in case. */
       /* Clear buffer. */
@@ -604,9 +624,14 @@ void fps_display( double dt )
         !player_isFlag( PLAYER_CREATING ) ) {
       dt_mod_base = player_dt_default();
    }
-   if ( dt_mod != dt_mod_base )
+   if ( dt_mod != dt_mod_base ) {
       gl_print( &gl_defFontMono, x, y, &cFontWhite, "%3.1fx",
                 dt_mod / dt_mod_base );
+      y -= gl_defFontMono.h + 5.;
+   }
+
+   /* Profiler overlay. */
+   profiler_render( x, y );
 
    if ( !paused || !player_paused || !conf.pause_show )
       return;
@@ -734,6 +759,9 @@ void update_routine( double dt, int dohooks )
    /* Update the elapsed time, should be with all the modifications and such. */
    elapsed_time_mod += dt;
 
+   /* Record or verify the state for replays. */
+   replay_tick();
+
    NTracingZoneEnd( _ctx );
 }
 
@@ -37,6 +37,7 @@ mod slots;
 mod spfx;
 mod spob;
 mod system;
+mod threadpool;
 mod lua {
    pub mod ryaml;
 }
@@ -176,7 +177,7 @@ fn setup_conf_and_ndata() -> Result<(PathBuf, Option<nlog::WorkerGuard>)> {
    // Load the data and plugins.
    let guard = ndata::setup()?;
    // Create some useful cache stuf once
-   if let Err(e) = fs::create_dir_all(ndata::cache_dir().join("collisions/")) {
+   if let Err(e) = fs::create_dir_all(ndata::cache_dir()) {
       warn_err!(e);
    }
 
@@ -369,6 +370,11 @@ fn naevmain() -> Result<()> {
    // Load game data
    load_all(&sdlctx, load_env)?;
 
+   // Write out any collision polygons we had to generate
+   if let Err(e) = collide::cache::flush() {
+      warn_err!(e);
+   }
+
    unsafe {
       // Detect size changes that occurred during load.
       naevc::naev_resize();
@@ -400,12 +406,16 @@ fn naevmain() -> Result<()> {
          }
       }
 
+      // Start recording or replaying, has to be before anything uses the RNG
+      naevc::replay_init();
+
       // Start menu
       naevc::menu_main();
 
       if naevc::conf.devmode != 0 {
          let elapsed = start.elapsed().as_secs_f32();
          infox!(gettext("Reached main menu in {:.3} s"), elapsed);
+         renderer::texcache::report();
       } else {
          info!("{}", gettext("Reached main menu"));
       }
@@ -442,6 +452,11 @@ fn naevmain() -> Result<()> {
       naevc::naev_main_cleanup();
    }
 
+   // Ships loaded on demand may have added new collision polygons
+   if let Err(e) = collide::cache::flush() {
+      warn_err!(e);
+   }
+
    nlog::close_file(guard);
 
    Ok(())
@@ -635,6 +635,9 @@ static int naevL_conf( lua_State *L )
    PUSH_STRING( L, "dev_data_dir", conf.dev_data_dir );
    PUSH_BOOL( L, "puzzle_skip", conf.puzzle_skip );
    PUSH_BOOL( L, "disable_screen_shake", conf.disable_screen_shake );
+   PUSH_BOOL( L, "sim_lod", conf.sim_lod );
+   PUSH_BOOL( L, "outfit_batch", conf.outfit_batch );
+   PUSH_STRING( L, "bench_lua", conf.bench_lua );
    return 1;
 }
 #undef PUSH_STRING
@@ -645,15 +648,27 @@ static int naevL_conf( lua_State *L )
 /**
  * @brief Sets configuration variables. Note that not all are supported.
  *
+ * Currently only the simulation settings that benchmarks compare are
+ * supported, which are "sim_lod" and "outfit_batch".
+ *
+ * @usage naev.confSet( "sim_lod", false )
+ *
  *    @luatparam string name Configuration variable name.
- *    @luatparam number|string value Value to set to.
+ *    @luatparam boolean|number|string value Value to set to.
  * @luafunc confSet
  */
 static int naevL_confSet( lua_State *L )
 {
-   (void)L;
-   /* TODO implement. */
-   return NLUA_ERROR( L, _( "unimplemented" ) );
+   const char *name = luaL_checkstring( L, 1 );
+   if ( strcmp( name, "sim_lod" ) == 0 )
+      conf.sim_lod = lua_toboolean( L, 2 );
+   else if ( strcmp( name, "outfit_batch" ) == 0 )
+      conf.outfit_batch = lua_toboolean( L, 2 );
+   else
+      return NLUA_ERROR(
+         L, _( "Setting configuration variable '%s' is not supported." ),
+         name );
+   return 0;
 }
 
 /**
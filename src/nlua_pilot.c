@@ -49,9 +49,24 @@
  */
 extern Pilot *cur_pilot;
 
+/**
+ * @brief Actual data stored in the pilot userdata.
+ *
+ * The id must be the first member so the userdata can be read as a LuaPilot.
+ */
+typedef struct LuaPilotData_ {
+   LuaPilot id;   /**< ID of the pilot. */
+   int      hint; /**< Last known position in the pilot stack. */
+} LuaPilotData;
+
+static int pilot_lua_mt = LUA_NOREF; /**< Reference to the pilot metatable. */
+static int pilot_lua_cache =
+   LUA_NOREF; /**< Reference to the weak table of pilot userdata by ID. */
+
 /*
  * Prototypes.
  */
+static int   pilotL_refs( lua_State *L );
 static int   pilotL_getFriendOrFoe( lua_State *L, int friend );
 static Task *pilotL_newtask( lua_State *L, Pilot *p, const char *task );
 static int   outfit_compareActive( const void *slot1, const void *slot2 );
@@ -494,6 +509,7 @@ static const luaL_Reg pilotL_methods[] = {
 int nlua_loadPilot( nlua_env *env )
 {
    nlua_register( env, PILOT_METATABLE, pilotL_methods, 1 );
+   pilotL_refs( naevL );
 
    /* Pilot always loads ship and asteroid. */
    nlua_loadShip( env );
@@ -502,6 +518,36 @@ int nlua_loadPilot( nlua_env *env )
    return 0;
 }
 
+/**
+ * @brief Sets up the cached pilot metatable and userdata cache references.
+ *
+ *    @param L Lua state to use.
+ *    @return 1 if the references are available, 0 if the pilot metatable has
+ * not been registered yet.
+ */
+static int pilotL_refs( lua_State *L )
+{
+   if ( pilot_lua_mt != LUA_NOREF )
+      return 1;
+
+   luaL_getmetatable( L, PILOT_METATABLE );
+   if ( lua_isnil( L, -1 ) ) {
+      lua_pop( L, 1 );
+      return 0;
+   }
+   pilot_lua_mt = luaL_ref( L, LUA_REGISTRYINDEX );
+
+   /* Pilots are interned per ID, values are weak so unused ones get
+    * collected. */
+   lua_newtable( L );                /* c */
+   lua_newtable( L );                /* c, mt */
+   lua_pushstring( L, "v" );         /* c, mt, "v" */
+   lua_setfield( L, -2, "__mode" );  /* c, mt */
+   lua_setmetatable( L, -2 );        /* c */
+   pilot_lua_cache = luaL_ref( L, LUA_REGISTRYINDEX );
+   return 1;
+}
+
 /**
  * @brief Wrapper to simplify flag setting stuff.
  */
@@ -572,7 +618,14 @@ LuaPilot luaL_checkpilot( lua_State *L, int ind )
  */
 Pilot *luaL_validpilot( lua_State *L, int ind )
 {
-   Pilot *p = pilot_get( luaL_checkpilot( L, ind ) );
+   LuaPilotData *lp;
+   Pilot        *p;
+   if ( !lua_ispilot( L, ind ) ) {
+      luaL_typerror( L, ind, PILOT_METATABLE );
+      return NULL;
+   }
+   lp = (LuaPilotData *)lua_touserdata( L, ind );
+   p  = pilot_getHint( lp->id, &lp->hint );
    if ( p == NULL ) {
       NLUA_ERROR( L, _( "Pilot is invalid." ) );
       return NULL;
@@ -582,17 +635,44 @@ Pilot *luaL_validpilot( lua_State *L, int ind )
 /**
  * @brief Pushes a pilot on the stack.
  *
+ * Pilots are interned, so pushing the same pilot again reuses the existing
+ * userdata as long as it has not been garbage collected.
+ *
  *    @param L Lua state to push pilot into.
  *    @param pilot Pilot to push.
- *    @return Newly pushed pilot.
+ *    @return Pushed pilot.
  */
 LuaPilot *lua_pushpilot( lua_State *L, LuaPilot pilot )
 {
-   LuaPilot *p = (LuaPilot *)lua_newuserdata( L, sizeof( LuaPilot ) );
-   *p          = pilot;
-   luaL_getmetatable( L, PILOT_METATABLE );
-   lua_setmetatable( L, -2 );
-   return p;
+   LuaPilotData *lp;
+
+   /* Shouldn't happen, but fall back to uncached pilots. */
+   if ( !pilotL_refs( L ) ) {
+      lp       = (LuaPilotData *)lua_newuserdata( L, sizeof( LuaPilotData ) );
+      lp->id   = pilot;
+      lp->hint = -1;
+      luaL_getmetatable( L, PILOT_METATABLE );
+      lua_setmetatable( L, -2 );
+      return &lp->id;
+   }
+
+   lua_rawgeti( L, LUA_REGISTRYINDEX, pilot_lua_cache ); /* c */
+   lua_rawgeti( L, -1, pilot );                           /* c, p */
+   if ( !lua_isnil( L, -1 ) ) {
+      lua_remove( L, -2 ); /* p */
+      return (LuaPilot *)lua_touserdata( L, -1 );
+   }
+   lua_pop( L, 1 ); /* c */
+
+   lp       = (LuaPilotData *)lua_newuserdata( L, sizeof( LuaPilotData ) );
+   lp->id   = pilot;
+   lp->hint = -1;
+   lua_rawgeti( L, LUA_REGISTRYINDEX, pilot_lua_mt ); /* c, p, mt */
+   lua_setmetatable( L, -2 );                         /* c, p */
+   lua_pushvalue( L, -1 );                            /* c, p, p */
+   lua_rawseti( L, -3, pilot );                       /* c, p */
+   lua_remove( L, -2 );                               /* p */
+   return &lp->id;
 }
 /**
  * @brief Checks to see if ind is a pilot.
@@ -607,7 +687,10 @@ int lua_ispilot( lua_State *L, int ind )
 
    if ( lua_getmetatable( L, ind ) == 0 )
       return 0;
-   lua_getfield( L, LUA_REGISTRYINDEX, PILOT_METATABLE );
+   if ( pilot_lua_mt != LUA_NOREF )
+      lua_rawgeti( L, LUA_REGISTRYINDEX, pilot_lua_mt );
+   else
+      lua_getfield( L, LUA_REGISTRYINDEX, PILOT_METATABLE );
 
    ret = 0;
    if ( lua_rawequal( L, -1, -2 ) ) /* does it have the correct mt? */
@@ -1000,6 +1083,9 @@ static int pilotL_canSpawn( lua_State *L )
 
 static void toggleSpawn( FactionRef f, int b )
 {
+   /* Timers of the enabled factions have to be up to date. */
+   space_schedulerFlush();
+
    /* Find the faction and set. */
    for ( int i = 0; i < array_size( cur_system->presence ); i++ ) {
       if ( cur_system->presence[i].faction != f )
@@ -5093,14 +5179,29 @@ static int pilotL_jamLockons( lua_State *L )
    return 0;
 }
 
+/*
+ * When stat is NULL the value is set in the table at the top of the stack,
+ * otherwise only the matching stat is pushed. The value is only evaluated when
+ * it is used.
+ */
 #define PUSH_DOUBLE( L, name, value )                                          \
-   lua_pushstring( L, name );                                                  \
-   lua_pushnumber( L, value );                                                 \
-   lua_rawset( L, -3 )
+   if ( stat == NULL ) {                                                       \
+      lua_pushstring( L, name );                                               \
+      lua_pushnumber( L, value );                                              \
+      lua_rawset( L, -3 );                                                     \
+   } else if ( strcmp( stat, name ) == 0 ) {                                   \
+      lua_pushnumber( L, value );                                              \
+      return 1;                                                                \
+   }
 #define PUSH_INT( L, name, value )                                             \
-   lua_pushstring( L, name );                                                  \
-   lua_pushinteger( L, value );                                                \
-   lua_rawset( L, -3 )
+   if ( stat == NULL ) {                                                       \
+      lua_pushstring( L, name );                                               \
+      lua_pushinteger( L, value );                                             \
+      lua_rawset( L, -3 );                                                     \
+   } else if ( strcmp( stat, name ) == 0 ) {                                   \
+      lua_pushinteger( L, value );                                             \
+      return 1;                                                                \
+   }
 /**
  * @brief Gets stats of the pilot.
  *
@@ -5128,17 +5229,31 @@ static int pilotL_jamLockons( lua_State *L )
  *  <li> jumps </li>
  * </ul>
  *
+ * Scripts that query stats often should either get a single stat by name or
+ * pass a table to be reused, which avoids creating a new table each call.
+ *
  * @usage stats = p:stats() print(stats.armour)
+ * @usage armour = p:stats("armour") -- Only gets the armour
+ * @usage p:stats( mem.stats ) -- Updates the stats in mem.stats
  *
  *    @luatparam Pilot p Pilot to get stats of.
- *    @luatreturn table A table containing the stats of p.
+ *    @luatparam[opt=nil] string|table stat Name of a single stat to get, or
+ * table to set the stats in instead of creating a new one.
+ *    @luatreturn table|number A table containing the stats of p, or the value
+ * of the stat if a name was specified.
  * @luafunc stats
  */
 static int pilotL_getStats( lua_State *L )
 {
-   const Pilot *p = luaL_validpilot( L, 1 );
-   /* Create table with information. */
-   lua_newtable( L );
+   const Pilot *p    = luaL_validpilot( L, 1 );
+   const char  *stat = NULL;
+   if ( lua_type( L, 2 ) == LUA_TSTRING )
+      stat = lua_tostring( L, 2 );
+   else if ( lua_istable( L, 2 ) )
+      lua_pushvalue( L, 2 );
+   else
+      /* Create table with information. */
+      lua_newtable( L );
    /* Core. */
    PUSH_INT( L, "cpu", p->cpu );
    PUSH_INT( L, "cpu_max", p->cpu_max );
@@ -5169,6 +5284,8 @@ static int pilotL_getStats( lua_State *L )
                 ntime_convertSeconds( pilot_hyperspaceDelay( p ) ) );
    PUSH_INT( L, "jumps", pilot_getJumps( p ) );
 
+   if ( stat != NULL )
+      return NLUA_ERROR( L, _( "Unknown pilot stat '%s'!" ), stat );
    return 1;
 }
 #undef PUSH_DOUBLE
@@ -5180,11 +5297,15 @@ static int pilotL_getStats( lua_State *L )
  *
  * @usage local mod = p:shipstat("tur_damage",true) -- Gets turret damage
  * bonus with internal representation
+ * @usage p:shipstat( nil, false, mem.shipstats ) -- Updates all the ship stats
+ * in mem.shipstats
  *
  *    @luatparam Pilot p Pilot to get ship stat of.
  *    @luatparam[opt=nil] string name Name of the ship stat to get.
  *    @luatparam[opt=false] boolean internal Whether or not to use the
  * internal representation.
+ *    @luatparam[opt=nil] table t Table to set the ship stats in instead of
+ * creating a new one when name is not specified.
  *    @luareturn Value of the ship stat or a table containing all the ship
  * stats if name is not specified.
  * @luafunc shipstat
@@ -5194,6 +5315,11 @@ static int pilotL_getShipStat( lua_State *L )
    const Pilot *p        = luaL_validpilot( L, 1 );
    const char  *str      = luaL_optstring( L, 2, NULL );
    int          internal = lua_toboolean( L, 3 );
+   if ( ( str == NULL ) && lua_istable( L, 4 ) ) {
+      lua_pushvalue( L, 4 );
+      ss_statsSetLuaTable( L, &p->stats, internal );
+      return 1;
+   }
    ss_statsGetLua( L, &p->stats, str, internal );
    return 1;
 }
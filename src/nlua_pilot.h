@@ -18,8 +18,8 @@
 /**
  * @brief Lua Pilot wrapper.
  *
- * TODO probably wrap pilots with id + index, so we can try the index look-up
- * first and fall back to bsearch otherwise.
+ * The userdata also stores the last known stack position of the pilot, which
+ * is tried before falling back to the binary search.
  */
 typedef unsigned int LuaPilot; /**< Wrapper for a Pilot. */
 
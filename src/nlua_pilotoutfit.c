@@ -334,6 +334,7 @@ static int poL_set( lua_State *L )
    double           value = luaL_checknumber( L, 3 );
    po->lua_stats =
       ss_statsSetList( po->lua_stats, ss_typeFromName( name ), value, 1, 0 );
+   po->stats_dirty      = 1;
    pilotoutfit_modified = 1;
    return 0;
 }
@@ -347,8 +348,10 @@ static int poL_set( lua_State *L )
 static int poL_clear( lua_State *L )
 {
    PilotOutfitSlot *po = luaL_validpilotoutfit( L, 1 );
-   if ( po->lua_stats != NULL )
+   if ( po->lua_stats != NULL ) {
+      po->stats_dirty      = 1;
       pilotoutfit_modified = 1;
+   }
    ss_free( po->lua_stats );
    po->lua_stats = NULL;
    return 0;
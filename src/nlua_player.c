@@ -2529,6 +2529,7 @@ static int playerL_teleport( lua_State *L )
    pnt = NULL;
 
    pilot_rmFlag( player.p, PILOT_LANDING );
+   land_prepareClear();
 
    /* Get a system. */
    if ( lua_issystem( L, 1 ) ) {
@@ -65,12 +65,17 @@ ALWAYS_INLINE static inline void *nrealloc( void *ptr, size_t size )
 #define NTracingPlotF( name, val ) TracyCPlotF( name, val )
 #define NTracingPlotI( name, val ) TracyCPlotI( name, val )
 #else /* HAVE_TRACY */
-#define NTracingFrameMark
+/* Without Tracy, zones are recorded by the built-in profiler (profiler.h). */
+#include "profiler.h"
+#define NTracingFrameMark profiler_frameMark()
 #define NTracingFrameMarkStart( name )
 #define NTracingFrameMarkEnd( name )
-#define NTracingZone( ctx, active )
-#define NTracingZoneName( ctx, name, active )
-#define NTracingZoneEnd( ctx )
+#define NTracingZone( ctx, active )                                            \
+   NTracingZoneName( ctx, __func__, active )
+#define NTracingZoneName( ctx, zname, active )                                 \
+   static ProfilerZone ctx##_zone = { .name = zname, .id = -1 };              \
+   ProfilerCtx         ctx        = profiler_zoneBegin( &ctx##_zone, active )
+#define NTracingZoneEnd( ctx ) profiler_zoneEnd( ctx )
 #define NTracingAlloc( ptr, size )
 #define NTracingFree( ptr )
 #define nmalloc( size ) malloc( size )
@@ -95,6 +95,7 @@ double      tex_sy( const glTexture *tex );
 double      tex_srw( const glTexture *tex );
 double      tex_srh( const glTexture *tex );
 int         tex_isSDF( const glTexture *tex );
+size_t      tex_memory( const glTexture *tex );
 int         tex_hasTrans( const glTexture *tex );
 GLuint      tex_tex( const glTexture *tex );
 GLuint      tex_sampler( const glTexture *tex );
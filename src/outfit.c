@@ -233,6 +233,16 @@ int outfit_gfxStoreLoad( Outfit *o )
    return 0;
 }
 
+/**
+ * @brief Frees the store graphics for the outfit. They will be loaded again
+ * on demand.
+ */
+void outfit_gfxStoreFree( Outfit *o )
+{
+   gl_freeTexture( o->gfx_store );
+   o->gfx_store = NULL;
+}
+
 /**
  * @brief Gets an outfit by name.
  *
@@ -896,7 +906,10 @@ const OutfitGFX *outfit_gfx( const Outfit *o )
 }
 const glTexture *outfit_gfxStore( const Outfit *o )
 {
-   outfit_gfxStoreLoad( (Outfit *)o );
+   /* Loading changes the outfit, so use the writable one from the stack. */
+   Outfit *ow         = &outfit_stack[o - outfit_stack];
+   ow->gfx_store_used = SDL_GetTicks();
+   outfit_gfxStoreLoad( ow );
    return o->gfx_store;
 }
 const glTexture **outfit_gfxOverlays( const Outfit *o )
@@ -917,6 +930,10 @@ const ShipStatList *outfit_stats( const Outfit *o )
 {
    return o->stats;
 }
+const ShipStatsPacked *outfit_statsPacked( const Outfit *o )
+{
+   return o->stats_packed;
+}
 /**
  * @brief Gets the outfit's sound effect.
  *    @param o Outfit to get information from.
@@ -1603,6 +1620,27 @@ nlua_env *outfit_luaEnv( const Outfit *o )
 {
    return o->lua_env;
 }
+/**
+ * @brief Sets the "mem" table of the outfit's Lua environment.
+ *
+ * The table that is currently set is tracked, so nothing is done if it is
+ * already set.
+ *
+ *    @param o Outfit to set memory of.
+ *    @param mem Lua reference to the memory table.
+ */
+void outfit_luaSetMem( const Outfit *o, int mem )
+{
+   const void *ptr;
+   lua_rawgeti( naevL, LUA_REGISTRYINDEX, mem ); /* mem */
+   ptr = lua_topointer( naevL, -1 );
+   if ( ( ptr != NULL ) && ( ptr == o->lua_mem_cur ) ) {
+      lua_pop( naevL, 1 ); /* */
+      return;
+   }
+   nlua_setenv( naevL, o->lua_env, "mem" ); /* */
+   ( (Outfit *)o )->lua_mem_cur = ptr;
+}
 int outfit_luaDescextra( const Outfit *o )
 {
    return o->lua_descextra;
@@ -1631,6 +1669,10 @@ int outfit_luaUpdate( const Outfit *o )
 {
    return o->lua_update;
 }
+int outfit_luaUpdateBatch( const Outfit *o )
+{
+   return o->lua_update_batch;
+}
 int outfit_luaOntoggle( const Outfit *o )
 {
    return o->lua_ontoggle;
@@ -3266,6 +3308,7 @@ static int outfit_parse( Outfit *temp, const char *file )
    temp->lua_init           = LUA_NOREF;
    temp->lua_cleanup        = LUA_NOREF;
    temp->lua_update         = LUA_NOREF;
+   temp->lua_update_batch   = LUA_NOREF;
    temp->lua_ontoggle       = LUA_NOREF;
    temp->lua_onshoot        = LUA_NOREF;
    temp->lua_onhit          = LUA_NOREF;
@@ -3530,6 +3573,9 @@ static int outfit_parse( Outfit *temp, const char *file )
    MELEMENT( ( temp->cond == NULL ) && ( temp->condstr != NULL ), "cond" );
 #undef MELEMENT
 
+   /* Compile the stats now that they won't change. */
+   temp->stats_packed = ss_pack( temp->stats );
+
    xmlFreeDoc( doc );
 
    return 0;
@@ -3668,7 +3714,8 @@ int outfit_load( void )
       }
 
       env = nlua_newEnv( ( o->lua_file == NULL ) ? o->filename : o->lua_file );
-      o->lua_env = env;
+      o->lua_env     = env;
+      o->lua_mem_cur = NULL;
       /* TODO limit libraries here. */
       nlua_loadStandard( env );
       nlua_loadGFX( env );
@@ -3698,6 +3745,8 @@ int outfit_load( void )
       o->lua_init        = nlua_refenvtype( env, "init", LUA_TFUNCTION );
       o->lua_cleanup     = nlua_refenvtype( env, "cleanup", LUA_TFUNCTION );
       o->lua_update      = nlua_refenvtype( env, "update", LUA_TFUNCTION );
+      o->lua_update_batch =
+         nlua_refenvtype( env, "update_batch", LUA_TFUNCTION );
       o->lua_ontoggle    = nlua_refenvtype( env, "ontoggle", LUA_TFUNCTION );
       o->lua_onshoot     = nlua_refenvtype( env, "onshoot", LUA_TFUNCTION );
       o->lua_onhit       = nlua_refenvtype( env, "onhit", LUA_TFUNCTION );
@@ -3990,6 +4039,7 @@ void outfit_free( void )
 
       /* Free stats. */
       ss_free( o->stats );
+      ss_packFree( o->stats_packed );
 
       /* Free illegality. */
       array_free( o->illegalto );
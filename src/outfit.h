@@ -369,12 +369,14 @@ typedef struct Outfit {
 
    char       *gfx_store_path; /**< Store graphic path. */
    glTexture  *gfx_store;      /**< Store graphic. */
+   uint64_t    gfx_store_used; /**< Last time the store graphic was used. */
    glTexture **gfx_overlays;   /**< Array (array.h): Store overlay graphics. */
 
    unsigned int properties; /**< Properties stored bitwise. */
 
    /* Stats. */
-   ShipStatList *stats; /**< Stat list. */
+   ShipStatList    *stats;        /**< Stat list. */
+   ShipStatsPacked *stats_packed; /**< Compiled stat list. */
 
    /* Tags. */
    char **tags; /**< Outfit tags. */
@@ -384,6 +386,10 @@ typedef struct Outfit {
    char *lua_inline; /**< Inline Lua. */
    nlua_env *
       lua_env; /**< Lua environment. Shared for each outfit to allow globals. */
+   const void *lua_mem_cur;   /**< Table currently set as "mem" in the Lua
+                                 environment, used to avoid setting it again. */
+   int         lua_mem_depth; /**< Number of slot callbacks currently running in
+                                 the Lua environment. */
    int lua_descextra; /**< Run to get the extra description status. */
    int lua_onadd; /**< Run when added to a pilot or player adds this outfit. */
    int lua_onremove; /**< Run when removed to a pilot or when player removes
@@ -393,6 +399,7 @@ typedef struct Outfit {
    int lua_init;           /**< Run when pilot enters a system. */
    int lua_cleanup;        /**< Run when the pilot is erased. */
    int lua_update;         /**< Run periodically. */
+   int lua_update_batch;   /**< Run periodically for many pilots at once. */
    int lua_ontoggle;       /**< Run when toggled. */
    int lua_onshoot;        /**< Run when shooting. */
    int lua_onhit;          /**< Run when pilot takes damage. */
@@ -441,6 +448,7 @@ typedef struct Outfit {
 int            outfit_gfxStoreLoaded( const Outfit *o );
 int            outfit_gfxStoreLoadNeeded( void );
 int            outfit_gfxStoreLoad( Outfit *o );
+void           outfit_gfxStoreFree( Outfit *o );
 const Outfit  *outfit_get( const char *name );
 const Outfit  *outfit_getW( const char *name );
 const Outfit **outfit_getAll( void );
@@ -499,6 +507,7 @@ char          *outfit_descRaw( const Outfit *o );
 char          *outfit_summaryRaw( const Outfit *o );
 /* Lua stuff. */
 nlua_env *outfit_luaEnv( const Outfit *o );
+void      outfit_luaSetMem( const Outfit *o, int mem );
 int       outfit_luaDescextra( const Outfit *o );
 int       outfit_luaOnadd( const Outfit *o );
 int       outfit_luaOnremove( const Outfit *o );
@@ -506,6 +515,7 @@ int       outfit_luaOnoutfitchange( const Outfit *o );
 int       outfit_luaInit( const Outfit *o );
 int       outfit_luaCleanup( const Outfit *o );
 int       outfit_luaUpdate( const Outfit *o );
+int       outfit_luaUpdateBatch( const Outfit *o );
 int       outfit_luaOntoggle( const Outfit *o );
 int       outfit_luaOnshoot( const Outfit *o );
 int       outfit_luaOnhit( const Outfit *o );
@@ -562,6 +572,7 @@ const glTexture    *outfit_gfxStore( const Outfit *o );
 const glTexture   **outfit_gfxOverlays( const Outfit *o );
 const CollPoly     *outfit_plg( const Outfit *o );
 const ShipStatList *outfit_stats( const Outfit *o );
+const ShipStatsPacked *outfit_statsPacked( const Outfit *o );
 int                 outfit_spfxArmour( const Outfit *o );
 int                 outfit_spfxShield( const Outfit *o );
 const Damage       *outfit_damage( const Outfit *o );
@@ -421,9 +421,34 @@ pub fn open_vec2(lua: &mlua::Lua) -> anyhow::Result<mlua::AnyUserData> {
 }
 
 use mlua::ffi;
+use std::ffi::CStr;
 use std::os::raw::{c_char, c_int};
+use std::sync::atomic::{AtomicI32, Ordering};
 static_assertions::assert_eq_size!(Vec2, naevc::vec2);
 
+/// Registry reference to the "push_vector" function.
+static PUSH_VECTOR_REF: AtomicI32 = AtomicI32::new(ffi::LUA_NOREF);
+/// Registry reference to the "get_vector" function.
+static GET_VECTOR_REF: AtomicI32 = AtomicI32::new(ffi::LUA_NOREF);
+
+/// Pushes a named registry value, caching an integer reference to it to avoid the string-keyed
+/// lookup on subsequent calls. Only used from the C API, which always uses the main Naev state.
+#[allow(non_snake_case)]
+unsafe fn push_registry_cached(L: *mut mlua::lua_State, cache: &AtomicI32, name: &CStr) {
+   unsafe {
+      let r = cache.load(Ordering::Relaxed);
+      if r != ffi::LUA_NOREF {
+         ffi::lua_rawgeti(L, ffi::LUA_REGISTRYINDEX, r.into());
+         return;
+      }
+      ffi::lua_getfield(L, ffi::LUA_REGISTRYINDEX, name.as_ptr());
+      if ffi::lua_isnil(L, -1) == 0 {
+         ffi::lua_pushvalue(L, -1);
+         cache.store(ffi::luaL_ref(L, ffi::LUA_REGISTRYINDEX), Ordering::Relaxed);
+      }
+   }
+}
+
 #[allow(non_snake_case)]
 #[unsafe(no_mangle)]
 pub extern "C-unwind" fn luaL_checkvector(L: *mut mlua::lua_State, idx: c_int) -> *mut Vec2 {
@@ -446,7 +471,7 @@ pub extern "C-unwind" fn lua_isvector(L: *mut mlua::lua_State, idx: c_int) -> c_
 #[unsafe(no_mangle)]
 pub extern "C-unwind" fn lua_pushvector(L: *mut mlua::lua_State, vec: naevc::vec2) {
    unsafe {
-      ffi::lua_getfield(L, ffi::LUA_REGISTRYINDEX, c"push_vector".as_ptr());
+      push_registry_cached(L, &PUSH_VECTOR_REF, c"push_vector");
       ffi::lua_pushnumber(L, vec.x);
       ffi::lua_pushnumber(L, vec.y);
       ffi::lua_call(L, 2, 1);
@@ -458,7 +483,7 @@ pub extern "C-unwind" fn lua_pushvector(L: *mut mlua::lua_State, vec: naevc::vec
 pub extern "C-unwind" fn lua_tovector(L: *mut mlua::lua_State, idx: c_int) -> *mut Vec2 {
    unsafe {
       let idx = ffi::lua_absindex(L, idx);
-      ffi::lua_getfield(L, ffi::LUA_REGISTRYINDEX, c"get_vector".as_ptr());
+      push_registry_cached(L, &GET_VECTOR_REF, c"get_vector");
       ffi::lua_pushvalue(L, idx);
       let vec = match ffi::lua_pcall(L, 1, 1, 0) {
          ffi::LUA_OK => ffi::lua_touserdata(L, -1) as *mut Vec2,
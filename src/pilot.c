@@ -27,6 +27,7 @@
 #include "explosion.h"
 #include "faction.h"
 #include "font.h"
+#include "gfxcache.h"
 #include "gui.h"
 #include "hook.h"
 #include "log.h"
@@ -43,6 +44,9 @@
 #include "sound.h"
 
 #define PILOT_SIZE_MIN 128 /**< Minimum chunks to increment pilot_stack by */
+#define PILOT_LOD_TICKS                                                        \
+   4 /**< Pilots simulated at reduced detail think once every this many ticks. \
+      */
 
 /* ID Generators. */
 static unsigned int pilot_id =
@@ -59,6 +63,8 @@ static int      qt_init = 0;
  * parameters. */
 static int qt_max_elem = 2;
 static int qt_depth    = 5;
+static unsigned int pilot_lod_tick =
+   0; /**< Update counter used to stagger the reduced detail thinking. */
 
 /* misc */
 static const double pilot_commTimeout =
@@ -79,6 +85,8 @@ static void pilot_init( Pilot *dest, const Ship *ship, const char *name,
 static void pilot_hyperspace( Pilot *pilot, double dt );
 static void pilot_refuel( Pilot *p, double dt );
 static void pilot_updateSolid( Pilot *p, double dt );
+static int  pilot_checkLOD( const Pilot *p );
+static int  pilot_isLODTick( const Pilot *p );
 /* Clean up. */
 static void pilot_erase( Pilot *p );
 /* Misc. */
@@ -653,6 +661,33 @@ Pilot *pilot_get( unsigned int id )
    return *pp;
 }
 
+/**
+ * @brief Gets a pilot by id using a stack position hint.
+ *
+ * The hint is checked first and only falls back to the binary search if the
+ * pilot has moved in the stack, in which case the hint is updated.
+ *
+ *    @param id ID of the pilot to get.
+ *    @param[in,out] hint Last known position of the pilot in the stack.
+ *    @return The actual pilot or NULL if not found.
+ */
+Pilot *pilot_getHint( unsigned int id, int *hint )
+{
+   Pilot *p;
+   int    pos = *hint;
+   if ( ( pos < 0 ) || ( pos >= array_size( pilot_stack ) ) ||
+        ( pilot_stack[pos]->id != id ) ) {
+      pos = pilot_getStackPos( id );
+      if ( pos < 0 )
+         return NULL;
+      *hint = pos;
+   }
+   p = pilot_stack[pos];
+   if ( pilot_isFlag( p, PILOT_DELETE ) )
+      return NULL;
+   return p;
+}
+
 /**
  * @brief Gets the target of a pilot using a fancy caching system.
  */
@@ -1525,8 +1560,7 @@ double pilot_hit( Pilot *p, const Solid *w, const Pilot *pshooter,
 
    /* On hit weapon effects. */
    if ( ( outfit != NULL ) && ( outfit_luaOnImpact( outfit ) != LUA_NOREF ) ) {
-      lua_rawgeti( naevL, LUA_REGISTRYINDEX, lua_mem );     /* mem */
-      nlua_setenv( naevL, outfit_luaEnv( outfit ), "mem" ); /* */
+      outfit_luaSetMem( outfit, lua_mem );
 
       /* Set up the function: onimpact( pshooter, p ) */
       lua_rawgeti( naevL, LUA_REGISTRYINDEX,
@@ -2501,8 +2535,12 @@ void pilot_update( Pilot *pilot, double dt )
       pilot_lockUpdateSlot( pilot, pos, target, &wt, &a, dt );
    }
 
-   /* Update electronic warfare. */
-   pilot_ewUpdateDynamic( pilot, dt );
+   /* Update electronic warfare. Nobody can see pilots in LOD, so they only
+    * update along with their thinking. */
+   if ( !pilot_isFlag( pilot, PILOT_LOD ) )
+      pilot_ewUpdateDynamic( pilot, dt );
+   else if ( pilot_isLODTick( pilot ) )
+      pilot_ewUpdateDynamic( pilot, dt * PILOT_LOD_TICKS );
 
    /* Update stress. */
    if ( !pilot_isFlag( pilot,
@@ -2624,8 +2662,9 @@ void pilot_update( Pilot *pilot, double dt )
                                   pilot->commodities[i].quantity, 1 );
             }
          }
-         /* reset random explosion timer */
-         else if ( pilot->timer[1] <= 0. ) {
+         /* reset random explosion timer, nobody can see them in LOD */
+         else if ( ( pilot->timer[1] <= 0. ) &&
+                   !pilot_isFlag( pilot, PILOT_LOD ) ) {
             unsigned int l;
 
             pilot->timer[1] =
@@ -2689,7 +2728,10 @@ void pilot_update( Pilot *pilot, double dt )
 
    /* Healing and energy usage is only done if not disabled. */
    if ( !pilot_isDisabled( pilot ) ) {
-      pilot_ewUpdateStealth( pilot, dt );
+      if ( !pilot_isFlag( pilot, PILOT_LOD ) )
+         pilot_ewUpdateStealth( pilot, dt );
+      else if ( pilot_isLODTick( pilot ) )
+         pilot_ewUpdateStealth( pilot, dt * PILOT_LOD_TICKS );
 
       /* Pilot is still alive */
       pilot->armour += pilot->armour_regen * dt;
@@ -2901,6 +2943,10 @@ void pilot_sample_trails( Pilot *p, int none )
    if ( p->trail == NULL )
       return;
 
+   /* Can't be seen. */
+   if ( pilot_isFlag( p, PILOT_LOD ) )
+      return;
+
    /* Skip if far away (pretty heuristic-based but seems to work). */
    cam_getPos( &cx, &cy );
    d2 = pow2( cx - p->solid.pos.x ) + pow2( cy - p->solid.pos.y );
@@ -3661,6 +3707,7 @@ Pilot *pilot_create( const Ship *ship, const char *name, FactionRef faction,
 
    /* Load ship graphics. */
    ship_gfxLoad( (Ship *)ship ); /* TODO no casting. */
+   gfxcache_recordSpawn( faction, ship );
 
    /* Set the ID, has to be set before pilot_init as escort stuff may do
     * pilot_get in pilot_init. */
@@ -4142,6 +4189,7 @@ void pilots_free( void )
       /* Handle Lua outfits. */
       pilot_outfitLCleanup( pilot_stack[i] );
    }
+   pilot_outfitLUpdateBatchFree();
 
    /* Free pilots. */
    for ( int i = 0; i < array_size( pilot_stack ); i++ )
@@ -4332,6 +4380,58 @@ void pilots_updatePurge( void )
    NTracingZoneEnd( _ctx );
 }
 
+/**
+ * @brief Checks to see if a pilot can be simulated at a reduced level of
+ * detail.
+ *
+ * Pilots that are well off screen, outside of the player's sensor range and
+ * not interacting with the player can't be observed, so they only have to
+ * think and update their electronic warfare and stealth every PILOT_LOD_TICKS
+ * updates. Their movement is still updated every tick.
+ *
+ *    @param p Pilot to check.
+ *    @return 1 if the pilot can be simulated at a reduced level of detail.
+ */
+static int pilot_checkLOD( const Pilot *p )
+{
+   double cx, cy, d2;
+
+   if ( !conf.sim_lod || ( player.p == NULL ) || space_isSimulation() )
+      return 0;
+
+   /* Pilots controlled by scripts or doing things with the player. */
+   if ( pilot_isFlag( p, PILOT_PLAYER ) ||
+        pilot_isFlag( p, PILOT_MANUAL_CONTROL ) ||
+        pilot_isFlag( p, PILOT_HAILING ) )
+      return 0;
+   if ( ( p->target == PLAYER_ID ) || ( p->parent == PLAYER_ID ) ||
+        ( player.p->target == p->id ) )
+      return 0;
+
+   /* Must be far off screen, same heuristic as the trails. */
+   cam_getPos( &cx, &cy );
+   d2 = pow2( cx - p->solid.pos.x ) + pow2( cy - p->solid.pos.y );
+   if ( d2 <= pow2( MAX( SCREEN_W, SCREEN_H ) / conf.zoom_far * 2. ) )
+      return 0;
+
+   /* Must not be visible on the radar either. */
+   if ( pilot_inRangePilot( player.p, p, NULL ) != 0 )
+      return 0;
+
+   return 1;
+}
+
+/**
+ * @brief Checks to see if a pilot in LOD gets its reduced rate updates this
+ * tick.
+ *
+ * Staggered by ID to spread the load over the ticks.
+ */
+static int pilot_isLODTick( const Pilot *p )
+{
+   return ( ( pilot_lod_tick + p->id ) % PILOT_LOD_TICKS == 0 );
+}
+
 /**
  * @brief Updates all the pilots.
  *
@@ -4339,9 +4439,12 @@ void pilots_updatePurge( void )
  */
 void pilots_update( double dt )
 {
+   int nlod = 0;
    NTracingZone( _ctx, 1 );
    NTracingPlotI( "pilots", array_size( pilot_stack ) );
 
+   pilot_lod_tick++;
+
    /* Have all the pilots think. */
    for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
       Pilot *p = pilot_stack[i];
@@ -4350,6 +4453,13 @@ void pilots_update( double dt )
       if ( pilot_isFlag( p, PILOT_HIDE ) )
          continue;
 
+      /* Figure out the level of detail. */
+      if ( pilot_checkLOD( p ) ) {
+         pilot_setFlag( p, PILOT_LOD );
+         nlod++;
+      } else
+         pilot_rmFlag( p, PILOT_LOD );
+
       /* See if should think. */
       if ( pilot_isDisabled( p ) )
          continue;
@@ -4387,12 +4497,21 @@ void pilots_update( double dt )
                 !pilot_isFlag( p, PILOT_HYP_END ) ) {
          if ( pilot_isFlag( p, PILOT_PLAYER ) )
             player_think( p, dt );
-         else
+         else if ( pilot_isFlag( p, PILOT_LOD ) ) {
+            /* The steering decided now is held until the next think, so the
+             * AI plans over that time. */
+            if ( pilot_isLODTick( p ) )
+               ai_think( p, dt * PILOT_LOD_TICKS, 1 );
+         } else
             ai_think( p, dt, 1 );
       }
    }
+   NTracingPlotI( "pilots_lod", nlod );
 
-   /* Now update all the pilots. */
+   /* Now update all the pilots. Outfits that support it get their updates
+    * batched and run together afterwards. */
+   if ( conf.outfit_batch )
+      pilot_outfitLUpdateBatchStart();
    for ( int i = 0; i < array_size( pilot_stack ); i++ ) {
       Pilot *p = pilot_stack[i];
 
@@ -4410,6 +4529,7 @@ void pilots_update( double dt )
       else
          pilot_update( p, dt );
    }
+   pilot_outfitLUpdateBatchRun();
 
    NTracingZoneEnd( _ctx );
 }
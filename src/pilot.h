@@ -161,8 +161,15 @@ typedef struct PilotOutfitSlot_ {
    /* In the case of Lua stuff. */
    int
       lua_mem; /**< Lua reference to the memory table of the specific outfit. */
+   const void *lua_mem_ptr; /**< Address of the memory table, used to check if
+                               it is already set in the environment. */
    ShipStatList *lua_stats; /**< Intrinsic ship stats for the outfit calculated
                                on the fly. Used only by Lua outfits. */
+
+   /* Cached stats contribution, see pilot_calcStats(). */
+   const Outfit *stats_outfit; /**< Outfit the cached stats are from. */
+   int           stats_toggle; /**< Whether the stats depend on the state. */
+   int           stats_dirty;  /**< Lua stats changed since being applied. */
 } PilotOutfitSlot;
 
 /**
@@ -324,6 +331,14 @@ typedef struct Pilot_ {
                                      on the fly. */
    ShipStats
       stats; /**< Pilot's copy of ship statistics, used for comparisons.. */
+   ShipStats outfit_stats;       /**< Cached merged stats of the outfits. */
+   double    outfit_cpu;         /**< Cached CPU usage of the outfits. */
+   double    outfit_mass;        /**< Cached mass of the outfits. */
+   double    outfit_mass_core;   /**< Cached mass of the required outfits. */
+   int       outfit_nslots;      /**< Number of slots when cached. */
+   int       outfit_stats_valid; /**< Whether the outfit cache is valid. */
+   unsigned int
+      outfit_stats_groups; /**< Groups of stats touched by the outfits. */
 
    /* Ship effects. */
    Effect *effects; /**< Pilot's current activated effects. */
@@ -434,6 +449,7 @@ typedef struct Pilot_ {
 /* Getting pilot stuff. */
 Pilot *const *pilot_getAll( void );
 Pilot        *pilot_get( unsigned int id );
+Pilot        *pilot_getHint( unsigned int id, int *hint );
 Pilot        *pilot_getTarget( Pilot *p );
 unsigned int  pilot_getNextID( unsigned int id, int mode );
 unsigned int  pilot_getPrevID( unsigned int id, int mode );
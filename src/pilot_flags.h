@@ -100,6 +100,9 @@ enum {
    PILOT_NOLAND,         /**< Pilot cannot land on spobs. */
    PILOT_HASSPEEDLIMIT,  /**< Speed limiting is activated for Pilot.*/
    PILOT_BRAKING,        /**< Pilot is braking. */
+   /* Simulation. */
+   PILOT_LOD, /**< Pilot can't be observed by the player and thinks at a
+                 reduced rate. */
    /* Sentinal. */
    PILOT_FLAGS_MAX /**< Maximum number of flags. */
 };
@@ -33,12 +33,49 @@
 
 static int stealth_break = 0; /**< Whether or not to break stealth. */
 
+/**
+ * @brief Outfit slot waiting for a batched update.
+ */
+typedef struct OutfitLBatchEntry_ {
+   Pilot       *pilot;     /**< Pilot being updated. */
+   unsigned int id;        /**< ID of the pilot, to validate deferred updates. */
+   int          intrinsic; /**< Whether or not it is an intrinsic slot. */
+   int          slot;      /**< Index of the slot. */
+} OutfitLBatchEntry;
+
+/**
+ * @brief Pending batched updates of an outfit.
+ */
+typedef struct OutfitLBatch_ {
+   const Outfit      *outfit;  /**< Outfit being updated. */
+   double             dt;      /**< Delta tick of the updates. */
+   OutfitLBatchEntry *entries; /**< Array (array.h): Slots to update. */
+   int lua_entries; /**< Lua table of entries, reused between updates. */
+   int lua_n;       /**< Number of entries in the Lua table. */
+   int running;     /**< Whether or not the Lua table is being used. */
+} OutfitLBatch;
+
+static OutfitLBatch *outfitlbatch =
+   NULL; /**< Array (array.h): Batched outfit updates. */
+static int outfitlbatch_active =
+   0; /**< Whether or not batched updates are being collected. */
+
 /*
  * Prototypes.
  */
-static void        pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot,
-                                        ShipStats *s );
-static const char *outfitkeytostr( OutfitKey key );
+static int           pilot_slotStatsToggle( const PilotOutfitSlot *slot );
+static int           pilot_calcStatsSlotCheck( const PilotOutfitSlot *slot );
+static void          pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot,
+                                          ShipStats *s );
+static void          pilot_calcStatsSlotMisc( Pilot           *pilot,
+                                              PilotOutfitSlot *slot,
+                                              ShipStats       *s,
+                                              unsigned int    *groups );
+static void          pilot_calcStatsOutfits( Pilot *pilot, ShipStats *s,
+                                             unsigned int *groups );
+static int           outfitLGetBatch( const Outfit *o, double dt );
+static void          outfitLRunBatch( int ib, int deferred );
+static const char   *outfitkeytostr( OutfitKey key );
 
 /**
  * @brief Updates the lockons on the pilot's launchers
@@ -344,9 +381,11 @@ int pilot_addOutfitRawNoLua( Pilot *pilot, const Outfit *outfit,
       s->flags &= ~PILOTOUTFIT_TOGGLEABLE;
 
    /* Disable lua for now. */
-   s->lua_mem = LUA_NOREF;
+   s->lua_mem     = LUA_NOREF;
+   s->lua_mem_ptr = NULL;
    ss_free( s->lua_stats ); /* Just in case. */
-   s->lua_stats = NULL;
+   s->lua_stats   = NULL;
+   s->stats_dirty = 1;
 
    return 0;
 }
@@ -530,12 +569,14 @@ int pilot_rmOutfitRaw( Pilot *pilot, PilotOutfitSlot *s )
    /* Clear Lua if necessary. */
    if ( s->lua_mem != LUA_NOREF ) {
       luaL_unref( naevL, LUA_REGISTRYINDEX, s->lua_mem );
-      s->lua_mem = LUA_NOREF;
+      s->lua_mem     = LUA_NOREF;
+      s->lua_mem_ptr = NULL;
    }
 
    /* Clean up stats. */
    ss_free( s->lua_stats );
-   s->lua_stats = NULL;
+   s->lua_stats   = NULL;
+   s->stats_dirty = 1;
 
    /* Outfit changed. */
    pilot_outfitLOutfitChange( pilot );
@@ -989,63 +1030,170 @@ double pilot_outfitRange( const Pilot *p, const Outfit *o, int falloff )
 }
 
 /**
- * @brief Computes the stats for a pilot's slot.
+ * @brief Checks to see if the outfit stats of a slot depend on it being on.
+ */
+static int pilot_slotStatsToggle( const PilotOutfitSlot *slot )
+{
+   const Outfit *o = slot->outfit;
+
+   /* Always add stats for non mod/afterburners. */
+   if ( !outfit_isMod( o ) && !outfit_isAfterburner( o ) )
+      return 0;
+
+   /* Active outfits must be on to affect stuff. */
+   return ( slot->flags & PILOTOUTFIT_ACTIVE ) != 0;
+}
+
+/**
+ * @brief Checks to see if the cached stats of a slot are still valid.
+ *
+ *    @return 1 if all the outfit stats have to be computed again.
+ */
+static int pilot_calcStatsSlotCheck( const PilotOutfitSlot *slot )
+{
+   if ( ( slot->stats_outfit != slot->outfit ) || slot->stats_dirty )
+      return 1;
+   if ( slot->outfit == NULL )
+      return 0;
+   return ( slot->stats_toggle != pilot_slotStatsToggle( slot ) );
+}
+
+/**
+ * @brief Computes the cached stats for a pilot's slot.
+ *
+ * Only the stats that do not depend on the state of the slot are cached,
+ * those of outfits that can be turned on and off are added by
+ * pilot_calcStatsSlotMisc().
  */
 static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot,
                                  ShipStats *s )
 {
    const Outfit *o = slot->outfit;
 
+   slot->stats_outfit = o;
+   slot->stats_dirty  = 0;
+   slot->stats_toggle = 0;
+
    /* Outfit must exist. */
    if ( o == NULL )
       return;
 
    /* Modify CPU. */
-   pilot->cpu += outfit_cpu( o );
+   pilot->outfit_cpu += outfit_cpu( o );
 
    /* Add mass. */
-   pilot->mass_outfit += outfit_mass( o );
+   pilot->outfit_mass += outfit_mass( o );
 
    /* Keep a separate counter for required (core) outfits. */
    if ( sp_required( outfit_slotProperty( o ) ) )
-      pilot->base_mass += outfit_mass( o );
-
-   if ( outfit_isAfterburner( o ) ) /* Afterburner */
-      pilot->afterburner = slot;    /* Set afterburner */
+      pilot->outfit_mass_core += outfit_mass( o );
 
    /* Lua mods apply their stats. */
-   if ( slot->lua_mem != LUA_NOREF )
+   if ( slot->lua_mem != LUA_NOREF ) {
       ss_statsMergeFromList( s, slot->lua_stats, 0 );
-
-   /* Has update function. */
-   if ( outfit_luaUpdate( o ) != LUA_NOREF )
-      pilot->outfitlupdate = 1;
+      pilot->outfit_stats_groups |= ss_listGroups( slot->lua_stats );
+   }
 
    /* Apply modifications. */
-   if ( outfit_isMod( o ) ) { /* Modification */
-      /* Active outfits must be on to affect stuff. */
-      if ( ( slot->flags & PILOTOUTFIT_ACTIVE ) &&
-           !( slot->state == PILOT_OUTFIT_ON ) )
-         return;
-      /* Add stats. */
-      ss_statsMergeFromList( s, outfit_stats( o ), 0 );
+   slot->stats_toggle = pilot_slotStatsToggle( slot );
+   if ( !slot->stats_toggle ) {
+      ss_statsMergeFromPacked( s, outfit_statsPacked( o ), 0 );
+      pilot->outfit_stats_groups |= ss_packGroups( outfit_statsPacked( o ) );
+   }
+}
 
-   } else if ( outfit_isAfterburner( o ) ) { /* Afterburner */
-      /* Active outfits must be on to affect stuff. */
-      if ( ( slot->flags & PILOTOUTFIT_ACTIVE ) &&
-           !( slot->state == PILOT_OUTFIT_ON ) )
-         return;
-      /* Add stats. */
-      ss_statsMergeFromList( s, outfit_stats( o ), 0 );
-      pilot_setFlag(
-         pilot,
-         PILOT_AFTERBURNER ); /* We use old school flags for this still... */
-      pilot->stats.energy_regen_malus +=
-         outfit_energy( pilot->afterburner->outfit ); /* energy loss */
-   } else {
-      /* Always add stats for non mod/afterburners. */
-      ss_statsMergeFromList( s, outfit_stats( o ), 0 );
+/**
+ * @brief Computes the properties of a slot that are not cached.
+ *
+ *    @param pilot Pilot the slot belongs to.
+ *    @param slot Slot to compute.
+ *    @param s Stats to add the stats of the slot to if it is turned on.
+ *    @param groups Groups touched by the stats in s.
+ */
+static void pilot_calcStatsSlotMisc( Pilot *pilot, PilotOutfitSlot *slot,
+                                     ShipStats *s, unsigned int *groups )
+{
+   const Outfit *o  = slot->outfit;
+   int           on = 1;
+
+   /* Outfit must exist. */
+   if ( o == NULL )
+      return;
+
+   /* Active outfits must be on to affect stuff. */
+   if ( slot->stats_toggle ) {
+      on = ( slot->state == PILOT_OUTFIT_ON );
+      if ( on ) {
+         ss_statsMergeFromPacked( s, outfit_statsPacked( o ), 0 );
+         *groups |= ss_packGroups( outfit_statsPacked( o ) );
+      }
    }
+
+   if ( outfit_isAfterburner( o ) ) { /* Afterburner */
+      pilot->afterburner = slot;      /* Set afterburner */
+      if ( on ) {
+         pilot_setFlag(
+            pilot,
+            PILOT_AFTERBURNER ); /* We use old school flags for this still... */
+         pilot->stats.energy_regen_malus += outfit_energy( o ); /* energy loss */
+      }
+   }
+
+   /* Has update function. */
+   if ( ( outfit_luaUpdate( o ) != LUA_NOREF ) ||
+        ( outfit_luaUpdateBatch( o ) != LUA_NOREF ) )
+      pilot->outfitlupdate = 1;
+}
+
+/**
+ * @brief Computes the merged stats of all the outfits of a pilot.
+ *
+ * The stats of the outfits that are always applied are cached in the pilot
+ * and only merged again when the outfits change. The outfits that can be
+ * turned on and off, such as those toggled by weapon sets, are added on top
+ * of a copy of the cache every time so the result never drifts.
+ *
+ *    @param pilot Pilot to compute the outfit stats of.
+ *    @param[out] s Merged stats of the outfits.
+ *    @param[out] groups Groups touched by the stats in s.
+ */
+static void pilot_calcStatsOutfits( Pilot *pilot, ShipStats *s,
+                                    unsigned int *groups )
+{
+   int nslots =
+      array_size( pilot->outfit_intrinsic ) + array_size( pilot->outfits );
+   int rebuild =
+      !pilot->outfit_stats_valid || ( nslots != pilot->outfit_nslots );
+
+   /* See if the cache is still valid. */
+   for ( int i = 0; !rebuild && ( i < array_size( pilot->outfit_intrinsic ) );
+         i++ )
+      rebuild = pilot_calcStatsSlotCheck( &pilot->outfit_intrinsic[i] );
+   for ( int i = 0; !rebuild && ( i < array_size( pilot->outfits ) ); i++ )
+      rebuild = pilot_calcStatsSlotCheck( pilot->outfits[i] );
+
+   if ( rebuild ) {
+      ss_statsInit( &pilot->outfit_stats );
+      pilot->outfit_stats_groups = 0;
+      pilot->outfit_cpu          = 0.;
+      pilot->outfit_mass         = 0.;
+      pilot->outfit_mass_core    = 0.;
+      for ( int i = 0; i < array_size( pilot->outfit_intrinsic ); i++ )
+         pilot_calcStatsSlot( pilot, &pilot->outfit_intrinsic[i],
+                              &pilot->outfit_stats );
+      for ( int i = 0; i < array_size( pilot->outfits ); i++ )
+         pilot_calcStatsSlot( pilot, pilot->outfits[i], &pilot->outfit_stats );
+      pilot->outfit_nslots      = nslots;
+      pilot->outfit_stats_valid = 1;
+   }
+
+   /* Add the outfits that are turned on. */
+   *s      = pilot->outfit_stats;
+   *groups = pilot->outfit_stats_groups;
+   for ( int i = 0; i < array_size( pilot->outfit_intrinsic ); i++ )
+      pilot_calcStatsSlotMisc( pilot, &pilot->outfit_intrinsic[i], s, groups );
+   for ( int i = 0; i < array_size( pilot->outfits ); i++ )
+      pilot_calcStatsSlotMisc( pilot, pilot->outfits[i], s, groups );
 }
 
 /**
@@ -1055,8 +1203,10 @@ static void pilot_calcStatsSlot( Pilot *pilot, PilotOutfitSlot *slot,
  */
 void pilot_calcStats( Pilot *pilot )
 {
-   double     ac, sc, ec, fc, tm; /* temporary health coefficients to set */
-   ShipStats *s;
+   double       ac, sc, ec, fc, tm; /* temporary health coefficients to set */
+   ShipStats   *s;
+   ShipStats    outfit_stats;
+   unsigned int outfit_groups;
 
    /*
     * Set up the basic stuff
@@ -1117,14 +1267,12 @@ void pilot_calcStats( Pilot *pilot )
    ss_statsMergeFromList( &pilot->stats, pilot->intrinsic_stats, 1 );
 
    /* Now add outfit changes */
-   ShipStats outfit_stats;
-   ss_statsInit( &outfit_stats );
-   pilot->mass_outfit = 0.;
-   for ( int i = 0; i < array_size( pilot->outfit_intrinsic ); i++ )
-      pilot_calcStatsSlot( pilot, &pilot->outfit_intrinsic[i], &outfit_stats );
-   for ( int i = 0; i < array_size( pilot->outfits ); i++ )
-      pilot_calcStatsSlot( pilot, pilot->outfits[i], &outfit_stats );
-   ss_statsMerge( &pilot->stats, &outfit_stats, 1 );
+   pilot_calcStatsOutfits( pilot, &outfit_stats, &outfit_groups );
+   pilot->cpu += pilot->outfit_cpu;
+   pilot->mass_outfit = pilot->outfit_mass;
+   pilot->base_mass += pilot->outfit_mass_core;
+   /* Groups no outfit touches are still the identity and can be skipped. */
+   ss_statsMergeGroups( &pilot->stats, &outfit_stats, 1, outfit_groups );
 
    /* Compute effects. */
    effect_compute( &pilot->stats, pilot->effects );
@@ -1466,31 +1614,47 @@ static void outfitLRunWarning( const Pilot *p, const Outfit *o,
 
 /**
  * @brief Sets up the outfit memory for a slot.
+ *
+ * The environment keeps the last memory table set, so when the same slot runs
+ * several callbacks in a row nothing has to be done. Only nested calls into
+ * the same environment have to save the memory so it can be restored.
+ *
+ *    @return Lua reference to the memory to restore or LUA_NOREF if none.
  */
 static int pilot_outfitLmem( PilotOutfitSlot *po, nlua_env *env )
 {
-   int oldmem;
+   Outfit *o      = (Outfit *)po->outfit;
+   int     oldmem = LUA_NOREF;
    /* Create the memory if necessary and initialize stats. */
    if ( po->lua_mem == LUA_NOREF ) {
-      lua_newtable( naevL );                              /* mem */
-      po->lua_mem = luaL_ref( naevL, LUA_REGISTRYINDEX ); /* */
+      lua_newtable( naevL ); /* mem */
+      po->lua_mem_ptr = lua_topointer( naevL, -1 );
+      po->lua_mem     = luaL_ref( naevL, LUA_REGISTRYINDEX ); /* */
+   }
+   if ( po->lua_mem_ptr != o->lua_mem_cur ) {
+      /* Get old memory if it's still in use. */
+      if ( o->lua_mem_depth > 0 ) {
+         nlua_getenv( naevL, env, "mem" );              /* oldmem */
+         oldmem = luaL_ref( naevL, LUA_REGISTRYINDEX ); /* */
+      }
+      /* Set the memory. */
+      lua_rawgeti( naevL, LUA_REGISTRYINDEX, po->lua_mem ); /* mem */
+      nlua_setenv( naevL, env, "mem" );                     /* */
+      o->lua_mem_cur = po->lua_mem_ptr;
    }
-   /* Get old memory. */
-   nlua_getenv( naevL, env, "mem" );              /* oldmem */
-   oldmem = luaL_ref( naevL, LUA_REGISTRYINDEX ); /* */
-   /* Set the memory. */
-   lua_rawgeti( naevL, LUA_REGISTRYINDEX, po->lua_mem ); /* mem */
-   nlua_setenv( naevL, env, "mem" );                     /* */
+   o->lua_mem_depth++;
    return oldmem;
 }
 
 /**
  * @brief Cleans up the outfit memory for a slot.
  */
-static void pilot_outfitLunmem( nlua_env *env, int oldmem )
+static void pilot_outfitLunmem( const Outfit *o, int oldmem )
 {
-   lua_rawgeti( naevL, LUA_REGISTRYINDEX, oldmem );
-   nlua_setenv( naevL, env, "mem" ); /* pm */
+   ( (Outfit *)o )->lua_mem_depth--;
+   if ( oldmem == LUA_NOREF )
+      return;
+   outfit_luaSetMem( o, oldmem );
    luaL_unref( naevL, LUA_REGISTRYINDEX, oldmem );
 }
 
@@ -1658,7 +1822,7 @@ static void outfitLInit( const Pilot *pilot, PilotOutfitSlot *po,
    oldmem = pilot_outfitLmem( po, lua_env );
 
    if ( lua_oinit == LUA_NOREF ) {
-      pilot_outfitLunmem( outfit_luaEnv( o ), oldmem );
+      pilot_outfitLunmem( o, oldmem );
       return;
    }
 
@@ -1669,10 +1833,10 @@ static void outfitLInit( const Pilot *pilot, PilotOutfitSlot *po,
    if ( nlua_pcall( lua_env, 2, 0 ) ) {                /* */
       outfitLRunWarning( pilot, o, "init", luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
-      pilot_outfitLunmem( outfit_luaEnv( o ), oldmem );
+      pilot_outfitLunmem( o, oldmem );
       return;
    }
-   pilot_outfitLunmem( outfit_luaEnv( o ), oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 
 /**
@@ -1714,10 +1878,10 @@ int pilot_outfitLAdd( Pilot *pilot, PilotOutfitSlot *po )
    if ( nlua_pcall( env, 2, 0 ) ) {                               /* */
       outfitLRunWarning( pilot, o, "onadd", luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
-      pilot_outfitLunmem( env, oldmem );
+      pilot_outfitLunmem( o, oldmem );
       return -1;
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 
    temp_cleanup( tmp, pilot );
    return 1;
@@ -1751,10 +1915,10 @@ int pilot_outfitLRemove( Pilot *pilot, PilotOutfitSlot *po )
       outfitLRunWarning( pilot, o, "onremove",
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
-      pilot_outfitLunmem( env, oldmem );
+      pilot_outfitLunmem( o, oldmem );
       return -1;
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 
    temp_cleanup( tmp, pilot );
    return 1;
@@ -1784,7 +1948,7 @@ static void outfitLOutfitChange( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 
 void pilot_outfitLOutfitChange( Pilot *pilot )
@@ -1826,14 +1990,40 @@ static void outfitLUpdate( const Pilot *pilot, PilotOutfitSlot *po,
    int           oldmem;
    const Outfit *o = po->outfit;
 
+   /* The data. */
+   dt = *(double *)data;
+
+   /* Batched updates get deferred when possible. */
+   if ( outfit_luaUpdateBatch( o ) != LUA_NOREF ) {
+      /* Batches are referred to by index, as running Lua can add new ones. */
+      int               ib = outfitLGetBatch( o, dt );
+      OutfitLBatchEntry e;
+      /* Pilots not in the stack (like temporary ones) can't be looked up
+       * later, so they are always run immediately. */
+      int defer = outfitlbatch_active && ( pilot_get( pilot->id ) == pilot );
+      if ( !defer )
+         outfitLRunBatch( ib, 1 );
+      e.pilot = (Pilot *)pilot;
+      e.id    = pilot->id;
+      if ( ( po >= pilot->outfit_intrinsic ) &&
+           ( po < array_end( pilot->outfit_intrinsic ) ) ) {
+         e.intrinsic = 1;
+         e.slot      = po - pilot->outfit_intrinsic;
+      } else {
+         e.intrinsic = 0;
+         e.slot      = po->id;
+      }
+      array_push_back( &outfitlbatch[ib].entries, e );
+      if ( !defer )
+         outfitLRunBatch( ib, 0 );
+      return;
+   }
+
    if ( outfit_luaUpdate( o ) == LUA_NOREF )
       return;
 
    nlua_env *env = outfit_luaEnv( o );
 
-   /* The data. */
-   dt = *(double *)data;
-
    /* Set the memory. */
    oldmem = pilot_outfitLmem( po, env );
 
@@ -1847,7 +2037,7 @@ static void outfitLUpdate( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 /**
  * @brief Runs the pilot's Lua outfits update script.
@@ -1865,6 +2055,211 @@ void pilot_outfitLUpdate( Pilot *pilot, double dt )
    NTracingZoneEnd( _ctx );
 }
 
+/**
+ * @brief Gets the pending batch of an outfit, creating it if necessary.
+ *
+ *    @return Index of the batch in outfitlbatch.
+ */
+static int outfitLGetBatch( const Outfit *o, double dt )
+{
+   OutfitLBatch *b;
+   for ( int i = 0; i < array_size( outfitlbatch ); i++ ) {
+      if ( outfitlbatch[i].outfit != o )
+         continue;
+      /* All the updates of a batch have to share the delta tick. */
+      if ( ( array_size( outfitlbatch[i].entries ) > 0 ) &&
+           ( outfitlbatch[i].dt != dt ) )
+         outfitLRunBatch( i, 1 );
+      outfitlbatch[i].dt = dt;
+      return i;
+   }
+
+   if ( outfitlbatch == NULL )
+      outfitlbatch = array_create( OutfitLBatch );
+   b = &array_grow( &outfitlbatch );
+   memset( b, 0, sizeof( OutfitLBatch ) );
+   b->outfit = o;
+   b->dt     = dt;
+   lua_newtable( naevL );
+   b->lua_entries = luaL_ref( naevL, LUA_REGISTRYINDEX );
+   return array_size( outfitlbatch ) - 1;
+}
+
+/**
+ * @brief Runs the batched update of an outfit for all the pending slots.
+ *
+ * The Lua function is called as update_batch( entries, dt ), where each entry
+ * is a table of { p, po, mem }. Since many slots are updated at once, the
+ * global mem is not set and the one of each entry has to be used instead.
+ *
+ * Deferred batches recalculate the stats of the pilots that were updated if
+ * anything changed. Otherwise the batch is being run from pilot_outfitLRun()
+ * for a single pilot, and the modified flag is left set for it to handle.
+ *
+ *    @param ib Index of the batch to run.
+ *    @param deferred Whether or not the entries were deferred and the pilots
+ *           have to be looked up again.
+ */
+static void outfitLRunBatch( int ib, int deferred )
+{
+   OutfitLBatch *b   = &outfitlbatch[ib];
+   const Outfit *o   = b->outfit;
+   nlua_env     *env = outfit_luaEnv( o );
+   Pilot       **pilots;
+   int           n, reuse, modified;
+
+   if ( array_size( b->entries ) <= 0 )
+      return;
+
+   /* Fill in the entries, reusing the tables from previous updates unless
+    * they are still being used by an update that ended up running this one. */
+   reuse  = !b->running;
+   pilots = array_create_size( Pilot *, array_size( b->entries ) );
+   n      = 0;
+   lua_rawgeti( naevL, LUA_REGISTRYINDEX, outfit_luaUpdateBatch( o ) ); /* f */
+   if ( reuse )
+      lua_rawgeti( naevL, LUA_REGISTRYINDEX, b->lua_entries ); /* f, t */
+   else
+      lua_newtable( naevL ); /* f, t */
+   for ( int i = 0; i < array_size( b->entries ); i++ ) {
+      const OutfitLBatchEntry *e = &b->entries[i];
+      PilotOutfitSlot         *po;
+      Pilot                   *p = deferred ? pilot_get( e->id ) : e->pilot;
+
+      /* Pilot or outfit may have gone away since. */
+      if ( ( p == NULL ) || ( p != e->pilot ) ||
+           pilot_isFlag( p, PILOT_DELETE ) )
+         continue;
+      if ( e->intrinsic ) {
+         if ( e->slot >= array_size( p->outfit_intrinsic ) )
+            continue;
+         po = &p->outfit_intrinsic[e->slot];
+      } else {
+         if ( e->slot >= array_size( p->outfits ) )
+            continue;
+         po = p->outfits[e->slot];
+      }
+      if ( po->outfit != o )
+         continue;
+
+      /* Create the memory if necessary. */
+      if ( po->lua_mem == LUA_NOREF ) {
+         lua_newtable( naevL );
+         po->lua_mem_ptr = lua_topointer( naevL, -1 );
+         po->lua_mem     = luaL_ref( naevL, LUA_REGISTRYINDEX );
+      }
+
+      n++;
+      lua_rawgeti( naevL, -1, n ); /* f, t, e */
+      if ( lua_isnil( naevL, -1 ) ) {
+         lua_pop( naevL, 1 );        /* f, t */
+         lua_createtable( naevL, 3, 0 ); /* f, t, e */
+         lua_pushvalue( naevL, -1 );    /* f, t, e, e */
+         lua_rawseti( naevL, -3, n );   /* f, t, e */
+      }
+      lua_pushpilot( naevL, p->id );                        /* f, t, e, p */
+      lua_rawseti( naevL, -2, 1 );                          /* f, t, e */
+      lua_pushpilotoutfit( naevL, po );                     /* f, t, e, po */
+      lua_rawseti( naevL, -2, 2 );                          /* f, t, e */
+      lua_rawgeti( naevL, LUA_REGISTRYINDEX, po->lua_mem ); /* f, t, e, mem */
+      lua_rawseti( naevL, -2, 3 );                          /* f, t, e */
+      lua_pop( naevL, 1 );                                  /* f, t */
+      array_push_back( &pilots, p );
+   }
+   /* Remove stale entries so the length is correct. */
+   if ( reuse ) {
+      for ( int i = n + 1; i <= b->lua_n; i++ ) {
+         lua_pushnil( naevL );        /* f, t, nil */
+         lua_rawseti( naevL, -2, i ); /* f, t */
+      }
+      b->lua_n = n;
+   }
+   array_erase( &b->entries, array_begin( b->entries ),
+                array_end( b->entries ) );
+
+   if ( n <= 0 ) {
+      lua_pop( naevL, 2 );
+      array_free( pilots );
+      return;
+   }
+
+   /* Run the update. */
+   modified             = pilotoutfit_modified;
+   pilotoutfit_modified = 0;
+   lua_pushnumber( naevL, b->dt ); /* f, t, dt */
+   b->running++;
+   if ( nlua_pcall( env, 2, 0 ) ) { /* */
+      outfitLRunWarning( NULL, o, "update_batch",
+                         luaL_tolstring( naevL, -1, NULL ) );
+      lua_pop( naevL, 2 );
+   }
+   /* The Lua may have added batches, so b is no longer valid. */
+   outfitlbatch[ib].running--;
+
+   /* Not deferred, let pilot_outfitLRun() recalculate the pilot. */
+   if ( !deferred ) {
+      pilotoutfit_modified = modified || pilotoutfit_modified;
+      array_free( pilots );
+      return;
+   }
+
+   /* Recalculate if anything changed, we don't know which pilot it was. */
+   if ( pilotoutfit_modified ) {
+      for ( int i = 0; i < array_size( pilots ); i++ ) {
+         Pilot *p = pilots[i];
+         if ( pilot_isFlag( p, PILOT_DELETE ) )
+            continue;
+         /* The same pilot can appear more than once in a row. */
+         if ( ( i > 0 ) && ( pilots[i - 1] == p ) )
+            continue;
+         pilot_weapSetUpdateOutfitState( p );
+         pilot_calcStats( p );
+      }
+   }
+   pilotoutfit_modified = modified;
+   array_free( pilots );
+}
+
+/**
+ * @brief Starts collecting batched outfit updates.
+ *
+ * Until pilot_outfitLUpdateBatchRun() is called, updates of outfits that
+ * define update_batch are deferred so that they can be run for all the
+ * pilots at once.
+ */
+void pilot_outfitLUpdateBatchStart( void )
+{
+   outfitlbatch_active = 1;
+}
+
+/**
+ * @brief Frees the batched outfit update data.
+ */
+void pilot_outfitLUpdateBatchFree( void )
+{
+   for ( int i = 0; i < array_size( outfitlbatch ); i++ ) {
+      array_free( outfitlbatch[i].entries );
+      luaL_unref( naevL, LUA_REGISTRYINDEX, outfitlbatch[i].lua_entries );
+   }
+   array_free( outfitlbatch );
+   outfitlbatch        = NULL;
+   outfitlbatch_active = 0;
+}
+
+/**
+ * @brief Runs all the pending batched outfit updates.
+ */
+void pilot_outfitLUpdateBatchRun( void )
+{
+   NTracingZone( _ctx, 1 );
+
+   outfitlbatch_active = 0;
+   for ( int i = 0; i < array_size( outfitlbatch ); i++ )
+      outfitLRunBatch( i, 1 );
+
+   NTracingZoneEnd( _ctx );
+}
+
 static void outfitLOutofenergy( const Pilot *pilot, PilotOutfitSlot *po,
                                 const void *data )
 {
@@ -1889,7 +2284,7 @@ static void outfitLOutofenergy( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 /**
  * @brief Handles when the pilot runs out of energy.
@@ -1939,7 +2334,7 @@ static void outfitLOnhit( const Pilot *pilot, PilotOutfitSlot *po,
       outfitLRunWarning( pilot, o, "onhit", luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 /**
  * @brief Runs the pilot's Lua outfits onhit script.
@@ -1976,8 +2371,9 @@ void pilot_outfitLOnhit( Pilot *pilot, double armour, double shield,
 int pilot_outfitLOntoggle( const Pilot *pilot, PilotOutfitSlot *po, int on,
                            int natural )
 {
-   nlua_env *env = outfit_luaEnv( po->outfit );
-   int       ret, oldmem;
+   const Outfit *o   = po->outfit;
+   nlua_env     *env = outfit_luaEnv( o );
+   int           ret, oldmem;
    pilotoutfit_modified = 0;
 
    /* Set the memory. */
@@ -1994,14 +2390,14 @@ int pilot_outfitLOntoggle( const Pilot *pilot, PilotOutfitSlot *po, int on,
       outfitLRunWarning( pilot, po->outfit, "ontoggle",
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
-      pilot_outfitLunmem( env, oldmem );
+      pilot_outfitLunmem( o, oldmem );
       return 0;
    }
 
    /* Handle return boolean. */
    ret = lua_toboolean( naevL, -1 );
    lua_pop( naevL, 1 );
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
    return ret;
 }
 
@@ -2030,14 +2426,14 @@ int pilot_outfitLOnshoot( const Pilot *pilot, PilotOutfitSlot *po )
       outfitLRunWarning( pilot, o, "onshoot",
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
-      pilot_outfitLunmem( env, oldmem );
+      pilot_outfitLunmem( o, oldmem );
       return 0;
    }
 
    /* Handle return boolean. */
    ret = lua_toboolean( naevL, -1 );
    lua_pop( naevL, 1 );
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
    return ret || pilotoutfit_modified; /* Even if the script says it didn't
                                           change, it may have been modified. */
 }
@@ -2082,7 +2478,7 @@ static void outfitLCooldown( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 /**
  * @brief Handle cooldown hooks for outfits.
@@ -2123,7 +2519,7 @@ static void outfitLOnshootany( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 /**
  * @brief Runs the pilot's Lua outfits onshootany script.
@@ -2160,7 +2556,7 @@ static void outfitLOnstealth( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 /**
  * @brief Runs the pilot's Lua outfits onhit script.
@@ -2198,7 +2594,7 @@ static void outfitLOnscan( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 /**
  * @brief Runs Lua outfits when pilot scanned their target.
@@ -2235,7 +2631,7 @@ static void outfitLOnscanned( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 /**
  * @brief Runs Lua outfits when pilot was scanned by scanner.
@@ -2270,7 +2666,7 @@ static void outfitLOnland( const Pilot *pilot, PilotOutfitSlot *po,
       outfitLRunWarning( pilot, o, "land", luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 /**
  * @brief Runs Lua outfits when pilot lands on a spob.
@@ -2307,7 +2703,7 @@ static void outfitLOntakeoff( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 /**
  * @brief Runs Lua outfits when pilot takes off from a spob.
@@ -2343,7 +2739,7 @@ static void outfitLOnjumpin( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 /**
  * @brief Runs Lua outfits when pilot jumps into a system.
@@ -2379,7 +2775,7 @@ static void outfitLOnboard( const Pilot *pilot, PilotOutfitSlot *po,
       outfitLRunWarning( pilot, o, "board", luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 /**
  * @brief Runs Lua outfits when pilot boards a target.
@@ -2430,7 +2826,7 @@ static void outfitLOnkeydoubletap( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 
    /* Broke stealth. */
    if ( ( po->state == PILOT_OUTFIT_ON ) || lua_toboolean( naevL, -1 ) )
@@ -2472,7 +2868,7 @@ static void outfitLOnkeyrelease( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 void pilot_outfitLOnkeyrelease( Pilot *pilot, OutfitKey key )
 {
@@ -2515,7 +2911,7 @@ void pilot_outfitLCleanup( Pilot *pilot )
                             luaL_tolstring( naevL, -1, NULL ) );
          lua_pop( naevL, 2 );
       }
-      pilot_outfitLunmem( env, oldmem );
+      pilot_outfitLunmem( o, oldmem );
    }
    /* Pilot gets cleaned up so no need to recalculate stats. */
 }
@@ -2551,7 +2947,7 @@ int pilot_outfitLMessage( Pilot *pilot, PilotOutfitSlot *po, const char *msg,
       lua_pop( naevL, 2 );
       ret = 0;
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 
    /* Outfit message callback may have deleted the pilot. */
    if ( pilot_isFlag( pilot, PILOT_DELETE ) ) {
@@ -2592,7 +2988,7 @@ static void outfitLOndeath( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 void pilot_outfitLOndeath( Pilot *pilot )
 {
@@ -2643,7 +3039,7 @@ static void outfitLOnanyimpact( const Pilot *pilot, PilotOutfitSlot *po,
                          luaL_tolstring( naevL, -1, NULL ) );
       lua_pop( naevL, 2 );
    }
-   pilot_outfitLunmem( env, oldmem );
+   pilot_outfitLunmem( o, oldmem );
 }
 void pilot_outfitLOnanyimpact( Pilot *pilot, Pilot *target, const Solid *w,
                                const Outfit *o, double armour, double shield,
@@ -85,6 +85,9 @@ void pilot_outfitLOutfitChange( Pilot *pilot );
 void pilot_outfitLInitAll( Pilot *pilot );
 void pilot_outfitLInit( Pilot *pilot, PilotOutfitSlot *po );
 void pilot_outfitLUpdate( Pilot *pilot, double dt );
+void pilot_outfitLUpdateBatchStart( void );
+void pilot_outfitLUpdateBatchRun( void );
+void pilot_outfitLUpdateBatchFree( void );
 void pilot_outfitLOutfofenergy( Pilot *pilot );
 void pilot_outfitLOnhit( Pilot *pilot, double armour, double shield,
                          double disable, unsigned int attacker,
@@ -379,6 +379,29 @@ void player_new( void )
    save_loaded = 1;
 }
 
+/**
+ * @brief Creates a new player without asking anything.
+ *
+ * Meant for running things like benchmarks, so the start mission and event
+ * are not run, and the player is not marked as loaded so it never gets saved.
+ *
+ *    @param name Name to give the player.
+ *    @return 0 on success.
+ */
+int player_newHeadless( const char *name )
+{
+   player_newSetup();
+   player.date_created = time( NULL );
+   player.name         = strdup( name );
+
+   if ( player_newMake() )
+      return -1;
+
+   player.loaded_version = strdup( naev_version( 0 ) );
+   gui_load( gui_pick() );
+   return 0;
+}
+
 /**
  * @brief Actually creates a new player.
  *
@@ -1425,6 +1448,10 @@ void player_updateSpecific( Pilot *pplayer, const double dt )
       pilot_setFlag( t, PILOT_PLAYER_SCANNED );
    }
 
+   /* Prepare the landing screens while landing. */
+   if ( pilot_isFlag( pplayer, PILOT_LANDING ) )
+      land_prepareUpdate();
+
    /* Calculate engine sound to use. */
    if ( pilot_isFlag( pplayer, PILOT_AFTERBURNER ) )
       engsound = outfit_afterburnerSound( pplayer->afterburner->outfit );
@@ -1809,6 +1836,9 @@ int player_land( int loud )
    pilot_setAccel( player.p, 0. );
    pilot_setTurn( player.p, 0. );
 
+   /* Prepare what we can during the landing animation. */
+   land_prepare( spob );
+
    return PLAYER_LAND_OK;
 }
 
@@ -2749,6 +2779,9 @@ void player_destroyed( void )
    /* Set timer for death menu. */
    player_timer = 5.;
 
+   /* Won't be landing anymore. */
+   land_prepareClear();
+
    /* Stop sounds. */
    player_soundStop();
 
@@ -171,6 +171,7 @@ extern const Sound *snd_hypJump;      /**< Hyperspace jump sound. */
  */
 int           player_init( void );
 void          player_new( void );
+int           player_newHeadless( const char *name );
 PlayerShip_t *player_newShip( const Ship *ship, const char *def_name, int trade,
                               const char *acquired, int noname );
 void          player_cleanup( void );
@@ -0,0 +1,281 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file profiler.c
+ *
+ * @brief Built-in frame profiler used by the NTracing macros when Tracy is not
+ * available.
+ *
+ * The time spent in each zone is accumulated over a frame and stored in a ring
+ * buffer of the last frames when the frame ends. Only zones on the main thread
+ * are recorded. The data can be shown as an overlay or dumped to a CSV file.
+ */
+/** @cond */
+#include <SDL3/SDL_thread.h>
+#include <SDL3/SDL_timer.h>
+#include <stdlib.h>
+
+#include "physfs.h"
+
+#include "naev.h"
+/** @endcond */
+
+#include "profiler.h"
+
+#include "colour.h"
+#include "font.h"
+#include "log.h"
+#include "nstring.h"
+
+#define PROFILER_MAX_ZONES 256 /**< Maximum number of zones. */
+#define PROFILER_FRAMES 600    /**< Number of frames to keep. */
+#define PROFILER_AVERAGE 60    /**< Frames to average for the overlay. */
+#define PROFILER_SHOW 12       /**< Number of zones to show in the overlay. */
+
+/**
+ * @brief Averaged zone for displaying.
+ */
+typedef struct ProfilerAvg_ {
+   int    id;  /**< Zone index. */
+   double avg; /**< Average time in ms. */
+   double max; /**< Maximum time in ms. */
+} ProfilerAvg;
+
+int profiler_enabled = 0; /**< Whether or not the profiler is recording. */
+
+static SDL_ThreadID  profiler_mainthread; /**< Thread zones are recorded on. */
+static ProfilerZone *profiler_zones[PROFILER_MAX_ZONES]; /**< Known zones. */
+static int           profiler_nzones = 0; /**< Number of known zones. */
+static uint64_t
+   profiler_cur[PROFILER_MAX_ZONES]; /**< Ticks spent per zone this frame. */
+static uint64_t profiler_last = 0;   /**< Counter at the start of the frame. */
+static double  *profiler_frame = NULL; /**< Ring buffer of frame times (ms). */
+static float   *profiler_times =
+   NULL; /**< Ring buffer of zone times (ms), PROFILER_MAX_ZONES per frame. */
+static int profiler_head    = 0; /**< Next frame to write. */
+static int profiler_nframes = 0; /**< Number of frames recorded. */
+
+/**
+ * @brief Enables or disables the profiler.
+ *
+ * Enabling clears any previously recorded data.
+ *
+ *    @param enable Whether or not to enable the profiler.
+ */
+void profiler_enable( int enable )
+{
+   if ( enable && !profiler_enabled ) {
+      if ( profiler_frame == NULL ) {
+         profiler_frame = calloc( PROFILER_FRAMES, sizeof( double ) );
+         profiler_times =
+            calloc( PROFILER_FRAMES * PROFILER_MAX_ZONES, sizeof( float ) );
+      }
+      profiler_mainthread = SDL_GetCurrentThreadID();
+      memset( profiler_cur, 0, sizeof( profiler_cur ) );
+      profiler_head    = 0;
+      profiler_nframes = 0;
+      profiler_last    = SDL_GetPerformanceCounter();
+   }
+   profiler_enabled = enable;
+}
+
+/**
+ * @brief Starts recording a zone. Use profiler_zoneBegin() instead.
+ */
+ProfilerCtx _profiler_zoneBegin( ProfilerZone *zone )
+{
+   ProfilerCtx ctx = { .zone = NULL, .start = 0 };
+
+   if ( SDL_GetCurrentThreadID() != profiler_mainthread )
+      return ctx;
+
+   /* Register the zone on first use. */
+   if ( zone->id < 0 ) {
+      if ( profiler_nzones >= PROFILER_MAX_ZONES )
+         return ctx;
+      zone->id                        = profiler_nzones;
+      profiler_zones[profiler_nzones] = zone;
+      profiler_nzones++;
+   }
+
+   ctx.zone  = zone;
+   ctx.start = SDL_GetPerformanceCounter();
+   return ctx;
+}
+
+/**
+ * @brief Stops recording a zone. Use profiler_zoneEnd() instead.
+ */
+void _profiler_zoneEnd( ProfilerCtx ctx )
+{
+   profiler_cur[ctx.zone->id] += SDL_GetPerformanceCounter() - ctx.start;
+}
+
+/**
+ * @brief Marks the end of a frame, storing the zone times.
+ */
+void profiler_frameMark( void )
+{
+   uint64_t now;
+   double   ms;
+   float   *times;
+
+   if ( !profiler_enabled )
+      return;
+
+   now   = SDL_GetPerformanceCounter();
+   ms    = 1000. / (double)SDL_GetPerformanceFrequency();
+   times = &profiler_times[profiler_head * PROFILER_MAX_ZONES];
+   profiler_frame[profiler_head] = (double)( now - profiler_last ) * ms;
+   for ( int i = 0; i < PROFILER_MAX_ZONES; i++ )
+      times[i] = (double)profiler_cur[i] * ms;
+   memset( profiler_cur, 0, sizeof( profiler_cur ) );
+
+   profiler_last    = now;
+   profiler_head    = ( profiler_head + 1 ) % PROFILER_FRAMES;
+   profiler_nframes = MIN( profiler_nframes + 1, PROFILER_FRAMES );
+}
+
+/**
+ * @brief Gets the index of a recorded frame, with 0 being the oldest.
+ */
+static int profiler_frameIndex( int i )
+{
+   return ( profiler_head - profiler_nframes + i + PROFILER_FRAMES ) %
+          PROFILER_FRAMES;
+}
+
+/**
+ * @brief Compares averaged zones so that the slowest are first.
+ */
+static int profiler_cmp( const void *p1, const void *p2 )
+{
+   const ProfilerAvg *a1 = p1;
+   const ProfilerAvg *a2 = p2;
+   if ( a1->avg > a2->avg )
+      return -1;
+   else if ( a1->avg < a2->avg )
+      return +1;
+   return a1->id - a2->id;
+}
+
+/**
+ * @brief Renders the profiler overlay.
+ *
+ * Shows the frame time and the slowest zones averaged over the last frames.
+ *
+ *    @param x X position to render at.
+ *    @param y Y position to render at (top line).
+ */
+void profiler_render( double x, double y )
+{
+   ProfilerAvg avg[PROFILER_MAX_ZONES];
+   double      frame, frame_max;
+   int         n;
+
+   if ( !profiler_enabled )
+      return;
+
+   n = MIN( profiler_nframes, PROFILER_AVERAGE );
+   if ( n <= 0 )
+      return;
+
+   /* Average the last frames. */
+   frame     = 0.;
+   frame_max = 0.;
+   for ( int i = 0; i < profiler_nzones; i++ ) {
+      avg[i].id  = i;
+      avg[i].avg = 0.;
+      avg[i].max = 0.;
+   }
+   for ( int f = profiler_nframes - n; f < profiler_nframes; f++ ) {
+      int          idx   = profiler_frameIndex( f );
+      const float *times = &profiler_times[idx * PROFILER_MAX_ZONES];
+      frame += profiler_frame[idx];
+      frame_max = MAX( frame_max, profiler_frame[idx] );
+      for ( int i = 0; i < profiler_nzones; i++ ) {
+         avg[i].avg += times[i];
+         avg[i].max = MAX( avg[i].max, times[i] );
+      }
+   }
+   for ( int i = 0; i < profiler_nzones; i++ )
+      avg[i].avg /= n;
+   qsort( avg, profiler_nzones, sizeof( ProfilerAvg ), profiler_cmp );
+
+   /* Display. */
+   gl_print( &gl_smallFont, x, y, &cFontWhite, _( "%6.2f ms (max %6.2f) frame" ),
+             frame / n, frame_max );
+   for ( int i = 0; i < MIN( profiler_nzones, PROFILER_SHOW ); i++ ) {
+      if ( avg[i].max <= 0. )
+         break;
+      y -= gl_smallFont.h + 3.;
+      gl_print( &gl_smallFont, x, y, &cFontGrey, "%6.2f ms (max %6.2f) %s",
+                avg[i].avg, avg[i].max, profiler_zones[avg[i].id]->name );
+   }
+}
+
+/**
+ * @brief Writes the recorded frames to a CSV file.
+ *
+ * There is one row per frame, oldest first, and one column per zone with the
+ * time spent in milliseconds.
+ *
+ *    @param filename Name of the file to write in the write directory.
+ *    @return 0 on success.
+ */
+int profiler_dump( const char *filename )
+{
+   PHYSFS_File *f;
+   char         buf[STRMAX];
+   int          l;
+
+   if ( profiler_nframes <= 0 ) {
+      WARN( _( "No profiler data to dump!" ) );
+      return -1;
+   }
+
+   f = PHYSFS_openWrite( filename );
+   if ( f == NULL ) {
+      WARN( _( "Unable to open '%s' for writing: %s" ), filename,
+            _( PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
+      return -1;
+   }
+
+   /* Header. */
+   l = scnprintf( buf, sizeof( buf ), "frame,frame_ms" );
+   PHYSFS_writeBytes( f, buf, l );
+   for ( int i = 0; i < profiler_nzones; i++ ) {
+      l = scnprintf( buf, sizeof( buf ), ",\"%s\"", profiler_zones[i]->name );
+      PHYSFS_writeBytes( f, buf, l );
+   }
+   PHYSFS_writeBytes( f, "\n", 1 );
+
+   /* Frames. */
+   for ( int fr = 0; fr < profiler_nframes; fr++ ) {
+      int          idx   = profiler_frameIndex( fr );
+      const float *times = &profiler_times[idx * PROFILER_MAX_ZONES];
+      l = scnprintf( buf, sizeof( buf ), "%d,%.4f", fr, profiler_frame[idx] );
+      PHYSFS_writeBytes( f, buf, l );
+      for ( int i = 0; i < profiler_nzones; i++ ) {
+         l = scnprintf( buf, sizeof( buf ), ",%.4f", times[i] );
+         PHYSFS_writeBytes( f, buf, l );
+      }
+      PHYSFS_writeBytes( f, "\n", 1 );
+   }
+
+   PHYSFS_close( f );
+   return 0;
+}
+
+/**
+ * @brief Cleans up the profiler.
+ */
+void profiler_exit( void )
+{
+   profiler_enabled = 0;
+   free( profiler_frame );
+   free( profiler_times );
+   profiler_frame = NULL;
+   profiler_times = NULL;
+}
@@ -0,0 +1,62 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief A profiled zone, one per NTracingZone call site.
+ */
+typedef struct ProfilerZone_ {
+   const char *name; /**< Name of the zone. */
+   int         id;   /**< Index of the zone, or -1 if not registered yet. */
+} ProfilerZone;
+
+/**
+ * @brief An active profiled zone.
+ */
+typedef struct ProfilerCtx_ {
+   ProfilerZone *zone;  /**< Zone being profiled, or NULL if not recording. */
+   uint64_t      start; /**< Performance counter when the zone started. */
+} ProfilerCtx;
+
+extern int profiler_enabled; /**< Whether or not the profiler is recording. */
+
+ProfilerCtx _profiler_zoneBegin( ProfilerZone *zone );
+void        _profiler_zoneEnd( ProfilerCtx ctx );
+
+/**
+ * @brief Starts profiling a zone.
+ */
+static inline ProfilerCtx profiler_zoneBegin( ProfilerZone *zone, int active )
+{
+   if ( !profiler_enabled || !active ) {
+      ProfilerCtx ctx = { .zone = NULL, .start = 0 };
+      return ctx;
+   }
+   return _profiler_zoneBegin( zone );
+}
+
+/**
+ * @brief Stops profiling a zone.
+ */
+static inline void profiler_zoneEnd( ProfilerCtx ctx )
+{
+   if ( ctx.zone != NULL )
+      _profiler_zoneEnd( ctx );
+}
+
+/*
+ * Control.
+ */
+void profiler_enable( int enable );
+void profiler_frameMark( void );
+void profiler_exit( void );
+
+/*
+ * Output.
+ */
+void profiler_render( double x, double y );
+int  profiler_dump( const char *filename );
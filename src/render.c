@@ -15,6 +15,7 @@
 #include "opengl.h"
 #include "pause.h"
 #include "player.h"
+#include "rng.h"
 #include "space.h"
 #include "spfx.h"
 #include "toolkit.h"
@@ -181,6 +182,10 @@ void render_all( double game_dt, double real_dt )
    pp_final = ( array_size( pp_shaders_list[PP_LAYER_FINAL] ) > 0 );
    pp_core  = ( array_size( pp_shaders_list[PP_LAYER_CORE] ) > 0 );
 
+   /* Rendering is skipped when replaying, so it can't touch the random numbers
+    * of the simulation. */
+   rng_renderStart();
+
    /* Use pitch black for main screens. */
    glClearColor( 0., 0., 0., 1. );
 
@@ -284,6 +289,8 @@ void render_all( double game_dt, double real_dt )
       NTracingZoneEnd( _ctx_pp_core );
    }
 
+   rng_renderEnd();
+
    /* check error every loop */
    gl_checkErr();
 
@@ -25,6 +25,7 @@ pub mod luashader;
 pub mod model;
 pub mod sdf;
 pub mod shader;
+pub mod texcache;
 pub mod texture;
 
 /// Some hardcoded paths to search for things
@@ -10,11 +10,12 @@ use crate::{Context, ContextWrapper, Uniform, look_at4, ortho4};
 use anyhow::Context as anyhow_context;
 use anyhow::Result;
 use encase::ShaderType;
-use fs_err as fs;
 use glow::HasContext;
 use gltf::Gltf;
 use nalgebra::{Matrix3, Matrix4, Point3, Rotation3, Vector3, Vector4};
 use nlog::warn;
+use rayon::prelude::*;
+use std::collections::HashSet;
 use std::ffi::{CStr, CString};
 use std::os::raw::{c_char, c_double, c_int, c_uint};
 use std::path::Path;
@@ -1392,10 +1393,7 @@ impl Model {
       hasher.update(&size.to_ne_bytes());
       //hasher.update( &naev_core::constants::CTS.camera_angle.to_ne_bytes() );
       let hash = hasher.finalize();
-      let cache_path = ndata::cache_dir().join(format!("collisions/{hash}"));
-      if let Ok(data) = fs::read(&cache_path)
-         && let Ok(poly) = bitcode::deserialize::<SpinPolygon>(&data)
-      {
+      if let Some(poly) = collide::cache::load::<SpinPolygon>(&hash) {
          return Ok(poly);
       }
 
@@ -1406,11 +1404,12 @@ impl Model {
          .build_wrap(ctx)?;
 
       const N: usize = 120;
-      let polygons = {
+      // Rendering has to be done serially, but the tracing can be done in parallel afterwards
+      let views = {
          let lctx = ctx.lock();
          let gl = &lctx.gl;
          let target = FramebufferTarget::Framebuffer(fb);
-         let mut polygons = Vec::new();
+         let mut views = Vec::with_capacity(N);
          if let FramebufferTarget::Framebuffer(ref fb) = target {
             for i in 0..N {
                let dir = (i as f32) / (N as f32) * std::f32::consts::TAU;
@@ -1447,13 +1446,7 @@ impl Model {
                      glow::PixelPackData::Slice(Some(&mut data)),
                   );
                }
-               let img = match image::RgbaImage::from_vec(size as u32, size as u32, data) {
-                  Some(img) => image::DynamicImage::ImageRgba8(img),
-                  None => anyhow::bail!("failed to create ImageBuffer"),
-               };
-               let bimg = img.fast_blur(1.0);
-               let poly = Polygon::from_subimage(&bimg, 0, 0, size as u32, size as u32, dir.into());
-               polygons.push(poly);
+               views.push((dir, data));
             }
          }
          Framebuffer::unbind(&lctx);
@@ -1461,22 +1454,80 @@ impl Model {
             let dims = lctx.dimensions.read().unwrap();
             gl.viewport(0, 0, dims.pixels_width as i32, dims.pixels_height as i32);
          }
-         polygons
+         views
          // Have to drop lctx before dropping the textures
       };
+      let polygons = views
+         .into_par_iter()
+         .map(|(dir, data)| {
+            let img = match image::RgbaImage::from_vec(size as u32, size as u32, data) {
+               Some(img) => image::DynamicImage::ImageRgba8(img),
+               None => anyhow::bail!("failed to create ImageBuffer"),
+            };
+            let bimg = img.fast_blur(1.0);
+            Ok(Polygon::from_subimage(
+               &bimg,
+               0,
+               0,
+               size as u32,
+               size as u32,
+               dir.into(),
+            ))
+         })
+         .collect::<Result<Vec<_>>>()?;
       let dir_inc = 1.0 / (N as f32) * std::f32::consts::TAU;
       let dir_off = -dir_inc * 0.5;
 
-      let poly = SpinPolygon {
-         polygons,
-         dir_inc: dir_inc as f64,
-         dir_off: dir_off as f64,
-      };
+      let poly = SpinPolygon::new(polygons, dir_inc as f64, dir_off as f64);
       // Store in cache
-      fs::write(&cache_path, bitcode::serialize(&poly)?)?;
+      collide::cache::store(&hash, &poly)?;
       Ok(poly)
    }
 
+   /// Estimates the amount of memory used by the model in bytes, including the textures.
+   pub fn memory_usage(&self) -> usize {
+      fn visit(
+         node: &Node,
+         meshes: &mut HashSet<*const Mesh>,
+         textures: &mut HashSet<*const texture::TextureData>,
+         total: &mut usize,
+      ) {
+         if let Some(mesh) = &node.mesh
+            && meshes.insert(Rc::as_ptr(mesh))
+         {
+            for p in &mesh.primitives {
+               // Vertex data is kept both on the CPU and GPU
+               *total += p.vertex_data.len() * std::mem::size_of::<Vertex>() * 2;
+               *total += p.num_indices as usize * std::mem::size_of::<u32>();
+               let m = &p.material;
+               for t in [
+                  &m.diffuse,
+                  &m.metallic,
+                  &m.emissive,
+                  &m.normalmap,
+                  &m.ambientocclusion,
+               ] {
+                  if textures.insert(std::sync::Arc::as_ptr(&t.texture)) {
+                     *total += t.texture.memory_usage();
+                  }
+               }
+            }
+         }
+         for child in &node.children {
+            visit(child, meshes, textures, total);
+         }
+      }
+      let mut meshes = HashSet::new();
+      let mut textures = HashSet::new();
+      let mut total = 0;
+      for scene in &self.scenes {
+         for node in &scene.nodes {
+            visit(node, &mut meshes, &mut textures, &mut total);
+         }
+      }
+      total
+   }
+
    pub fn into_ptr(self) -> *mut Model {
       Box::into_raw(Box::new(self))
    }
@@ -1697,3 +1748,12 @@ pub extern "C" fn gltf_mountPosition(obj: *const Model, id: c_int) -> Vector3<f6
    let model = unsafe { &*obj };
    model.mounts[id as usize].position.cast::<f64>()
 }
+
+#[unsafe(no_mangle)]
+pub extern "C" fn gltf_memory(obj: *const Model) -> usize {
+   if obj.is_null() {
+      return 0;
+   }
+   let model = unsafe { &*obj };
+   model.memory_usage()
+}
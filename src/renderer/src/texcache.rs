@@ -0,0 +1,200 @@
+//! Optional on-disk cache of decoded texture pixel data.
+//!
+//! Decoding PNG/WebP/AVIF images and rendering SVGs takes a significant part of start up. When
+//! enabled, the pixel data that would be uploaded to the GPU is stored in the cache directory,
+//! and memory mapped on the next load instead of decoding the image again. Entries are keyed by
+//! the path, a hash of the file contents, and the parameters that change the pixel data.
+//!
+//! Entries are never pruned, so whenever images change the old entries are left behind and the
+//! `textures/` cache directory grows without bound until it is deleted by hand.
+//!
+//! Load times are also tracked per texture category to be able to compare decoding against
+//! cache hits.
+use anyhow::Result;
+use fs_err as fs;
+use memmap2::Mmap;
+use nlog::info;
+use std::collections::BTreeMap;
+use std::path::PathBuf;
+use std::sync::atomic::{AtomicU32, Ordering};
+use std::sync::{LazyLock, Mutex};
+use std::time::Duration;
+
+const MAGIC: &[u8; 4] = b"NTEX";
+const VERSION: u32 = 1;
+const HEADER_SIZE: usize = 20;
+
+/// Whether or not the texture cache is enabled.
+pub fn enabled() -> bool {
+   unsafe { naevc::conf.texture_cache != 0 }
+}
+
+/// Computes the key of a texture in the cache.
+pub fn key(
+   path: &str,
+   data: &[u8],
+   srgb: bool,
+   flipv: bool,
+   w: Option<usize>,
+   h: Option<usize>,
+) -> blake3::Hash {
+   let mut hasher = blake3::Hasher::new();
+   hasher.update(&VERSION.to_le_bytes());
+   hasher.update(path.as_bytes());
+   hasher.update(blake3::hash(data).as_bytes());
+   hasher.update(&[srgb as u8, flipv as u8]);
+   hasher.update(&w.unwrap_or(0).to_le_bytes());
+   hasher.update(&h.unwrap_or(0).to_le_bytes());
+   hasher.finalize()
+}
+
+/// Used to generate unique temporary file names
+static TMP_COUNTER: AtomicU32 = AtomicU32::new(0);
+
+fn cache_path(key: &blake3::Hash) -> PathBuf {
+   ndata::cache_dir().join(format!("textures/{key}"))
+}
+
+/// Memory mapped pixel data ready to be uploaded.
+pub struct CachedPixels {
+   mmap: Mmap,
+   pub w: u32,
+   pub h: u32,
+   pub has_alpha: bool,
+}
+
+impl CachedPixels {
+   /// Raw RGB or RGBA pixel data.
+   pub fn data(&self) -> &[u8] {
+      &self.mmap[HEADER_SIZE..]
+   }
+}
+
+/// Tries to load pixel data from the cache.
+pub fn load(key: &blake3::Hash) -> Option<CachedPixels> {
+   let file = std::fs::File::open(cache_path(key)).ok()?;
+   // Safety: entries are written to a temporary file and renamed, so they never change in place.
+   let mmap = unsafe { Mmap::map(&file) }.ok()?;
+   if mmap.len() < HEADER_SIZE || &mmap[0..4] != MAGIC {
+      return None;
+   }
+   let field = |i: usize| u32::from_le_bytes(mmap[4 + i * 4..8 + i * 4].try_into().unwrap());
+   if field(0) != VERSION {
+      return None;
+   }
+   let (w, h, channels) = (field(1), field(2), field(3));
+   if !(channels == 3 || channels == 4)
+      || mmap.len() != HEADER_SIZE + (w as usize) * (h as usize) * (channels as usize)
+   {
+      return None;
+   }
+   Some(CachedPixels {
+      mmap,
+      w,
+      h,
+      has_alpha: channels == 4,
+   })
+}
+
+/// Stores pixel data in the cache.
+pub fn store(key: &blake3::Hash, w: u32, h: u32, has_alpha: bool, data: &[u8]) -> Result<()> {
+   let channels: u32 = if has_alpha { 4 } else { 3 };
+   let mut out = Vec::with_capacity(HEADER_SIZE + data.len());
+   out.extend_from_slice(MAGIC);
+   for v in [VERSION, w, h, channels] {
+      out.extend_from_slice(&v.to_le_bytes());
+   }
+   out.extend_from_slice(data);
+
+   let path = cache_path(key);
+   if let Some(parent) = path.parent() {
+      fs::create_dir_all(parent)?;
+   }
+   // Multiple threads and instances of the game may be loading the same texture, so use unique
+   // temporary files
+   let tmp = path.with_extension(format!(
+      "{}.{}.tmp",
+      std::process::id(),
+      TMP_COUNTER.fetch_add(1, Ordering::Relaxed)
+   ));
+   fs::write(&tmp, &out)?;
+   fs::rename(&tmp, &path)?;
+   Ok(())
+}
+
+#[derive(Default)]
+struct LoadStats {
+   decoded: usize,
+   decode_time: Duration,
+   hits: usize,
+   hit_time: Duration,
+}
+
+static STATS: LazyLock<Mutex<BTreeMap<String, LoadStats>>> =
+   LazyLock::new(|| Mutex::new(Default::default()));
+
+/// Gets the category of a texture, which is just the first two components of the path.
+fn category(path: &str) -> String {
+   let mut it = path.trim_start_matches('/').split('/');
+   match (it.next(), it.next(), it.next()) {
+      (Some(a), Some(b), Some(_)) => format!("{a}/{b}"),
+      (Some(a), Some(_), None) => a.to_string(),
+      _ => String::from("."),
+   }
+}
+
+/// Records the time it took to load a texture.
+pub fn record(path: &str, hit: bool, elapsed: Duration) {
+   let mut stats = STATS.lock().unwrap();
+   let s = stats.entry(category(path)).or_default();
+   if hit {
+      s.hits += 1;
+      s.hit_time += elapsed;
+   } else {
+      s.decoded += 1;
+      s.decode_time += elapsed;
+   }
+}
+
+/// Prints a report of texture load times so far.
+pub fn report() {
+   let stats = STATS.lock().unwrap();
+   if stats.is_empty() {
+      return;
+   }
+   let ms = |d: Duration| d.as_secs_f64() * 1000.0;
+   info!(
+      "Texture load times (cache {}):",
+      if enabled() { "enabled" } else { "disabled" }
+   );
+   let mut total = LoadStats::default();
+   for (cat, s) in stats.iter() {
+      info!(
+         "   {cat:<24} decoded {:>5} in {:>9.2} ms, cached {:>5} in {:>9.2} ms",
+         s.decoded,
+         ms(s.decode_time),
+         s.hits,
+         ms(s.hit_time)
+      );
+      total.decoded += s.decoded;
+      total.decode_time += s.decode_time;
+      total.hits += s.hits;
+      total.hit_time += s.hit_time;
+   }
+   info!(
+      "   {:<24} decoded {:>5} in {:>9.2} ms, cached {:>5} in {:>9.2} ms",
+      "total",
+      total.decoded,
+      ms(total.decode_time),
+      total.hits,
+      ms(total.hit_time)
+   );
+}
+
+#[test]
+fn test_texcache_category() {
+   assert_eq!(category("gfx/ship/llama/llama.webp"), "gfx/ship");
+   assert_eq!(category("/gfx/spob/space/foo.webp"), "gfx/spob");
+   assert_eq!(category("gfx/foo.png"), "gfx");
+   assert_eq!(category("foo.png"), ".");
+}
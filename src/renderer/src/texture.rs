@@ -1,6 +1,7 @@
 use crate::buffer;
 use crate::colour::Colour;
 use crate::framebuffer::{Framebuffer, FramebufferBuilder};
+use crate::texcache;
 use crate::{
    Context, ContextWrapper, TextureSDFUniform, TextureScaleUniform, TextureUniform, Uniform,
 };
@@ -19,7 +20,7 @@ use physics::transform2::Transform2;
 use sdl3 as sdl;
 use std::boxed::Box;
 use std::ffi::{CStr, CString, c_char, c_double, c_float, c_int, c_uint};
-use std::io::{Read, Seek};
+use std::io::Read;
 use std::num::NonZero;
 use std::sync::{Arc, LazyLock, Weak, atomic::AtomicU32};
 #[cfg(not(debug_assertions))]
@@ -243,15 +244,28 @@ impl TextureData {
       flipv: bool,
       srgb: bool,
    ) -> Result<Self> {
-      let gl = &ctx.gl;
+      let (imgdata, has_alpha) = Self::prepare_image(img, flipv);
+      Self::from_pixels(
+         ctx,
+         name,
+         imgdata.as_bytes(),
+         imgdata.width(),
+         imgdata.height(),
+         has_alpha,
+         flipv,
+         srgb,
+      )
+   }
 
+   /// Converts an image into the RGB or RGBA pixel data that gets uploaded to the GPU.
+   fn prepare_image(img: image::DynamicImage, flipv: bool) -> (image::DynamicImage, bool) {
       let has_alpha = img.color().has_alpha();
       let img = match flipv {
          true => img.flipv(),
          false => img,
       };
 
-      let (imgdata, fmt): (image::DynamicImage, u32) = match has_alpha {
+      let imgdata: image::DynamicImage = match has_alpha {
          true => {
             let mut img = img.into_rgba8();
             // Since we aren't premultiplying in our pipeline, garbage RGB values for alpha==0
@@ -262,14 +276,32 @@ impl TextureData {
                   p.0 = [0u8; 4];
                }
             }
-            (img.into(), glow::RGBA)
+            img.into()
          }
-         false => (img.into_rgb8().into(), glow::RGB),
+         false => img.into_rgb8().into(),
       };
-      let (w, h) = (imgdata.width(), imgdata.height());
+      (imgdata, has_alpha)
+   }
 
+   /// Creates a new TextureData from prepared RGB or RGBA pixel data
+   #[allow(clippy::too_many_arguments)]
+   fn from_pixels(
+      ctx: &Context,
+      name: Option<&str>,
+      data: &[u8],
+      w: u32,
+      h: u32,
+      has_alpha: bool,
+      flipv: bool,
+      srgb: bool,
+   ) -> Result<Self> {
+      let gl = &ctx.gl;
+      let fmt = match has_alpha {
+         true => glow::RGBA,
+         false => glow::RGB,
+      };
       let internalformat = TextureFormat::auto(has_alpha, srgb);
-      let gldata = glow::PixelUnpackData::Slice(Some(imgdata.as_bytes()));
+      let gldata = glow::PixelUnpackData::Slice(Some(data));
 
       let texture = unsafe {
          let texture = gl.create_texture().map_err(|e| anyhow::anyhow!(e))?;
@@ -370,6 +402,16 @@ impl TextureData {
       })
    }
 
+   /// Estimates the amount of GPU memory used by the texture in bytes.
+   pub fn memory_usage(&self) -> usize {
+      // We assume 4 bytes per pixel, as RGB data tends to get padded anyway, and SDF use floats
+      let base = self.w * self.h * 4;
+      match self.mipmaps {
+         true => base * 4 / 3,
+         false => base,
+      }
+   }
+
    fn generate_mipmap(&mut self, gl: &glow::Context) -> Result<()> {
       unsafe {
          gl.bind_texture(glow::TEXTURE_2D, Some(self.texture));
@@ -742,25 +784,16 @@ impl mlua::FromLua for FilterMode {
 }
 
 /// Loads an SVG file into a DynamicImage
-//fn svg_to_img(path: &str, w: Option<usize>, h: Option<usize>) -> Result<image::DynamicImage> {
-fn svg_to_img(
-   rw: &mut sdl::iostream::IOStream,
-   w: Option<usize>,
-   h: Option<usize>,
-) -> Result<image::DynamicImage> {
+fn svg_to_img(svg_data: &[u8], w: Option<usize>, h: Option<usize>) -> Result<image::DynamicImage> {
    use resvg::{tiny_skia, usvg};
 
    // Load the SVG
    // TODO add ndata-based href resolves and such
-   //let svg_data = ndata::read(path)?;
-   let mut svg_data = Vec::new();
-   rw.read_to_end(&mut svg_data)?;
-
    let opt = usvg::Options {
       resources_dir: None, // TODO add and such
       ..Default::default()
    };
-   let tree = usvg::Tree::from_data(&svg_data, &opt)?;
+   let tree = usvg::Tree::from_data(svg_data, &opt)?;
 
    // Render the SVG
    let (iw, ih) = tree.size().to_int_size().dimensions();
@@ -794,6 +827,47 @@ fn svg_to_img(
       .into())
 }
 
+/// Finds the image file matching a path, trying the known extensions if it has none.
+fn image_file_path(path: &str) -> Result<String> {
+   if std::path::Path::new(path).extension().is_some() {
+      return Ok(path.to_string());
+   }
+   // We could just use ImageFormat::all() here, but I figure we want a specific order
+   for imageformat in FORMATS {
+      for ext in imageformat.extensions_str() {
+         let path = format!("{}.{}", path, ext);
+         if ndata::exists(&path) {
+            return Ok(path);
+         }
+      }
+   }
+   // Try svg as a last special case as it is not supported by image-rs
+   let svg = format!("{}.svg", path);
+   if ndata::exists(&svg) {
+      return Ok(svg);
+   }
+   anyhow::bail!("No image file matching '{}' found", path)
+}
+
+/// Decodes an image file that has been read into memory.
+fn decode_image(
+   path: &str,
+   data: &[u8],
+   w: Option<usize>,
+   h: Option<usize>,
+) -> Result<image::DynamicImage> {
+   match std::path::Path::new(path)
+      .extension()
+      .and_then(|s| s.to_str())
+   {
+      Some("svg") => svg_to_img(data, w, h),
+      _ => Ok(image::load_from_memory_with_format(
+         data,
+         image::ImageFormat::from_path(path)?,
+      )?),
+   }
+}
+
 pub enum TextureSource {
    Path(String),
    IOStream(sdl::iostream::IOStream<'static>),
@@ -840,71 +914,74 @@ impl TextureSource {
       let tex = Arc::new({
          let mut inner = match self {
             TextureSource::Path(path) => {
-               let img = {
-                  let cpath = ndata::simplify_path(&path)?;
-
-                  // Small wrapper to simplify things
-                  fn try_load_file(path: &str) -> Result<image::DynamicImage> {
-                     let rw = ndata::iostream(path)?;
-                     Ok(image::ImageReader::with_format(
-                        std::io::BufReader::new(rw),
-                        image::ImageFormat::from_path(path)?,
-                     )
-                     //let img = image::ImageReader::new(std::io::BufReader::new(rw)).with_guessed_format()?
-                     .decode()?)
+               let file = image_file_path(&ndata::simplify_path(&path)?)?;
+               let timer = std::time::Instant::now();
+               let data = ndata::read(&file)?;
+
+               // Try to use the pre-decoded pixel data if possible
+               let key = (!sdf && texcache::enabled())
+                  .then(|| texcache::key(&file, &data, srgb, flipv, w, h));
+               let cached = key.as_ref().and_then(texcache::load);
+               let hit = cached.is_some();
+               let tex = match cached {
+                  Some(px) => {
+                     let ctx = &sctx.lock();
+                     TextureData::from_pixels(
+                        ctx,
+                        name,
+                        px.data(),
+                        px.w,
+                        px.h,
+                        px.has_alpha,
+                        flipv,
+                        srgb,
+                     )?
                   }
-
-                  // Figure out what to do based on path
-                  match std::path::Path::new(&cpath)
-                     .extension()
-                     .and_then(|s| s.to_str())
-                  {
-                     Some("svg") => svg_to_img(&mut ndata::iostream(&cpath)?, w, h)?,
-                     Some(_) => try_load_file(&cpath)?,
-                     None => {
-                        // We could just use ImageFormat::all() here, but I figure we want
-                        // a specific order
-                        let mut image = None;
-                        'imageformat: for imageformat in FORMATS {
-                           for ext in imageformat.extensions_str() {
-                              let path = &format!("{}.{}", cpath, ext);
-                              if ndata::exists(path) {
-                                 image = Some(try_load_file(path)?);
-                                 break 'imageformat;
-                              }
-                           }
+                  None => {
+                     let img = decode_image(&file, &data, w, h)?;
+                     match sdf {
+                        true => {
+                           let ctx = &sctx.lock();
+                           TextureData::from_image_sdf(ctx, name, img, flipv)?
                         }
-                        // Try to load svg as a last special case as it is not supported by
-                        // image-rs
-                        if image.is_none() {
-                           let path = &format!("{}.svg", cpath);
-                           if ndata::exists(path) {
-                              image = Some(svg_to_img(&mut ndata::iostream(path)?, w, h)?);
+                        false => {
+                           let (img, has_alpha) = TextureData::prepare_image(img, flipv);
+                           let (iw, ih) = (img.width(), img.height());
+                           if let Some(key) = &key
+                              && let Err(e) =
+                                 texcache::store(key, iw, ih, has_alpha, img.as_bytes())
+                           {
+                              warn_err!(e);
                            }
+                           let ctx = &sctx.lock();
+                           TextureData::from_pixels(
+                              ctx,
+                              name,
+                              img.as_bytes(),
+                              iw,
+                              ih,
+                              has_alpha,
+                              flipv,
+                              srgb,
+                           )?
                         }
-                        image
-                           .with_context(|| format!("No image file matching '{}' found", cpath))?
                      }
                   }
                };
-               let ctx = &sctx.lock();
-               match sdf {
-                  true => TextureData::from_image_sdf(ctx, name, img, flipv)?,
-                  false => TextureData::from_image(ctx, name, img, flipv, srgb)?,
-               }
+               texcache::record(&file, hit, timer.elapsed());
+               tex
             }
             TextureSource::IOStream(mut rw) => {
                let img = {
+                  let mut data = Vec::new();
+                  rw.read_to_end(&mut data)?;
                   // We don't know if it's an SVG, so the only choice is to try to open it
                   // and fallback to image if it fails.
-                  match svg_to_img(&mut rw, w, h) {
+                  match svg_to_img(&data, w, h) {
                      Ok(img) => img,
-                     Err(_) => {
-                        rw.seek(std::io::SeekFrom::Start(0))?;
-                        image::ImageReader::new(std::io::BufReader::new(rw))
-                           .with_guessed_format()?
-                           .decode()?
-                     }
+                     Err(_) => image::ImageReader::new(std::io::Cursor::new(data))
+                        .with_guessed_format()?
+                        .decode()?,
                   }
                };
                let ctx = &sctx.lock();
@@ -1609,6 +1686,15 @@ pub extern "C-unwind" fn tex_name(ctex: *mut Texture) -> *const c_char {
    }
 }
 
+#[unsafe(no_mangle)]
+pub extern "C-unwind" fn tex_memory(ctex: *mut Texture) -> usize {
+   if ctex.is_null() {
+      return 0;
+   }
+   let tex = unsafe { &*ctex };
+   tex.texture.memory_usage()
+}
+
 #[unsafe(no_mangle)]
 pub extern "C-unwind" fn tex_isSDF(ctex: *mut Texture) -> c_int {
    let tex = unsafe { &*ctex };
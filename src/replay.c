@@ -0,0 +1,656 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+/**
+ * @file replay.c
+ *
+ * @brief Deterministic recording and replaying of play sessions.
+ *
+ * A recording stores the seed of the main thread random number generator, the
+ * input events in the order they were handled, and the real delta tick of
+ * every frame. Replaying feeds them back through the main loop without
+ * rendering, so that update_routine() gets the exact same sequence of delta
+ * ticks and random numbers. Every few simulation ticks a checksum of the pilot
+ * and weapon state is stored, which is verified when replaying, and the whole
+ * replay is timed so it can double as a benchmark.
+ *
+ * Input timers such as key repeats and double taps use replay_getTicks(),
+ * which follows the recorded delta ticks instead of the wall clock, and
+ * rendering uses its own random number stream, so skipping it when replaying
+ * doesn't change the numbers the simulation gets.
+ *
+ * Recordings are raw dumps of the SDL events, and are only meant to be replayed
+ * with the same build and configuration that made them.
+ */
+/** @cond */
+#include <inttypes.h>
+#include <SDL3/SDL_timer.h>
+
+#include "physfs.h"
+
+#include "naev.h"
+/** @endcond */
+
+#include "replay.h"
+
+#include "array.h"
+#include "conf.h"
+#include "log.h"
+#include "ndata.h"
+#include "ntime.h"
+#include "pilot.h"
+#include "rng.h"
+#include "weapon.h"
+
+#define REPLAY_MAGIC "NAEVRPLY" /**< Magic at the start of recordings. */
+#define REPLAY_VERSION 2        /**< Version of the recording format. */
+#define REPLAY_BUFSIZE ( 64 * 1024 ) /**< Size of the write buffer. */
+
+/**
+ * @brief Types of records in a recording.
+ */
+typedef enum ReplayRecord_ {
+   REPLAY_REC_EVENT = 1, /**< Input event, followed by its string if any. */
+   REPLAY_REC_POLLEND,   /**< No more events were pending. */
+   REPLAY_REC_FRAME,     /**< Real delta tick of a frame. */
+   REPLAY_REC_CHECKSUM,  /**< Checksum of the simulation state. */
+   REPLAY_REC_END,       /**< Checksum of the final simulation state. */
+} ReplayRecord;
+
+/**
+ * @brief Current state of the replay system.
+ */
+typedef enum ReplayMode_ {
+   REPLAY_NONE = 0, /**< Not doing anything. */
+   REPLAY_RECORD,   /**< Recording. */
+   REPLAY_PLAY,     /**< Playing back a recording. */
+} ReplayMode;
+
+/**
+ * @brief Header of a recording.
+ */
+typedef struct ReplayHeader_ {
+   char     magic[8];       /**< Should be REPLAY_MAGIC. */
+   uint32_t version;        /**< Should be REPLAY_VERSION. */
+   uint32_t event_size;     /**< Size of the SDL events. */
+   uint64_t seed;           /**< Random number generator seed. */
+   uint32_t checksum_ticks; /**< Ticks between checksums, 0 for none. */
+   uint32_t padding;        /**< Unused. */
+} ReplayHeader;
+
+static ReplayMode   replay_mode = REPLAY_NONE; /**< Current mode. */
+static PHYSFS_File *replay_out  = NULL; /**< Recording being written. */
+static char        *replay_data = NULL; /**< Recording being played. */
+static size_t       replay_size = 0;    /**< Size of replay_data. */
+static size_t       replay_pos  = 0;    /**< Read position in replay_data. */
+static uint32_t     replay_checksumTicks =
+   REPLAY_CHECKSUM_TICKS;              /**< Ticks between checksums. */
+static uint64_t replay_ticks      = 0; /**< Simulation ticks so far. */
+static uint64_t replay_frames     = 0; /**< Frames so far. */
+static int      replay_checked    = 0; /**< Number of checksums verified. */
+static int      replay_mismatches = 0; /**< Number of checksums that failed. */
+static Uint64   replay_start      = 0; /**< Counter when replaying started. */
+static double   replay_clock = 0.; /**< Sum of the frame delta ticks so far. */
+static int      replay_final = -1; /**< Whether the final state matched. */
+
+/*
+ * Prototypes.
+ */
+static int  replay_startRecord( const char *filename );
+static int  replay_startPlay( const char *filename );
+static void replay_finish( void );
+static void replay_recordEnd( void );
+static void replay_write( const void *data, size_t size );
+static int  replay_read( void *data, size_t size );
+static int  replay_peek( void );
+static const char **replay_eventText( SDL_Event *event );
+static int          replay_eventSkip( const SDL_Event *event );
+static void         replay_writeEvent( SDL_Event *event );
+static int          replay_readEvent( SDL_Event *event );
+static uint64_t     replay_hash( uint64_t h, const void *data, size_t size );
+
+/**
+ * @brief Starts recording or replaying depending on the configuration.
+ *
+ * Has to be called right before the main menu is opened, so that the whole
+ * session including the main menu uses the same random numbers.
+ *
+ *    @return 0 on success.
+ */
+int replay_init( void )
+{
+   if ( conf.replay != NULL ) {
+      if ( conf.record != NULL )
+         WARN( _( "Can not record while replaying, only replaying '%s'." ),
+               conf.replay );
+      return replay_startPlay( conf.replay );
+   }
+   if ( conf.record != NULL )
+      return replay_startRecord( conf.record );
+   return 0;
+}
+
+/**
+ * @brief Stops recording or replaying.
+ */
+void replay_exit( void )
+{
+   if ( replay_out != NULL ) {
+      PHYSFS_close( replay_out );
+      replay_out = NULL;
+   }
+   free( replay_data );
+   replay_data = NULL;
+   replay_size = 0;
+   replay_pos  = 0;
+   replay_mode = REPLAY_NONE;
+}
+
+/**
+ * @brief Checks to see if a session is being recorded.
+ */
+int replay_isRecording( void )
+{
+   return ( replay_mode == REPLAY_RECORD );
+}
+
+/**
+ * @brief Checks to see if a recording is being played back.
+ *
+ * Nothing should be rendered while replaying.
+ */
+int replay_isPlaying( void )
+{
+   return ( replay_mode == REPLAY_PLAY );
+}
+
+/**
+ * @brief Gets the number of milliseconds to use for input timers.
+ *
+ * Follows the recorded delta ticks when recording or replaying, so that key
+ * repeats and double taps trigger on the same frames.
+ *
+ *    @return Milliseconds since some arbitrary point.
+ */
+uint64_t replay_getTicks( void )
+{
+   if ( replay_mode == REPLAY_NONE )
+      return SDL_GetTicks();
+   return (uint64_t)( replay_clock * 1000. );
+}
+
+/**
+ * @brief Starts recording.
+ */
+static int replay_startRecord( const char *filename )
+{
+   ReplayHeader h;
+
+   replay_out = PHYSFS_openWrite( filename );
+   if ( replay_out == NULL ) {
+      WARN( _( "Unable to open '%s' for writing: %s" ), filename,
+            _( PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
+      return -1;
+   }
+   PHYSFS_setBuffer( replay_out, REPLAY_BUFSIZE );
+
+   memset( &h, 0, sizeof( h ) );
+   memcpy( h.magic, REPLAY_MAGIC, sizeof( h.magic ) );
+   h.version        = REPLAY_VERSION;
+   h.event_size     = sizeof( SDL_Event );
+   h.seed           = rng_getSeed();
+   h.checksum_ticks = REPLAY_CHECKSUM_TICKS;
+
+   /* Restart the sequence so the replay gets the same numbers from here on. */
+   rng_seed( h.seed );
+
+   replay_mode          = REPLAY_RECORD;
+   replay_checksumTicks = h.checksum_ticks;
+   replay_ticks         = 0;
+   replay_frames        = 0;
+   replay_clock         = 0.;
+   replay_write( &h, sizeof( h ) );
+   LOG( _( "Recording replay to '%s' with seed %" PRIu64 "." ), filename,
+        h.seed );
+   return 0;
+}
+
+/**
+ * @brief Starts playing back a recording.
+ */
+static int replay_startPlay( const char *filename )
+{
+   ReplayHeader h;
+
+   replay_data = ndata_read( filename, &replay_size );
+   if ( replay_data == NULL ) {
+      WARN( _( "Unable to read replay '%s'!" ), filename );
+      return -1;
+   }
+   replay_pos  = 0;
+   replay_mode = REPLAY_PLAY;
+   if ( replay_read( &h, sizeof( h ) ) ||
+        ( memcmp( h.magic, REPLAY_MAGIC, sizeof( h.magic ) ) != 0 ) ) {
+      WARN( _( "Replay '%s' is not a valid recording!" ), filename );
+      replay_exit();
+      return -1;
+   }
+   if ( ( h.version != REPLAY_VERSION ) ||
+        ( h.event_size != sizeof( SDL_Event ) ) ) {
+      WARN( _( "Replay '%s' was recorded with an incompatible build!" ),
+            filename );
+      replay_exit();
+      return -1;
+   }
+
+   rng_seed( h.seed );
+   replay_checksumTicks = h.checksum_ticks;
+   replay_ticks         = 0;
+   replay_frames        = 0;
+   replay_checked       = 0;
+   replay_mismatches    = 0;
+   replay_clock         = 0.;
+   replay_final         = -1;
+   replay_start         = SDL_GetPerformanceCounter();
+   LOG( _( "Playing replay '%s' with seed %" PRIu64 "." ), filename, h.seed );
+   return 0;
+}
+
+/**
+ * @brief Finishes a replay, reports the results and quits the game.
+ */
+static void replay_finish( void )
+{
+   double s = (double)( SDL_GetPerformanceCounter() - replay_start ) /
+              (double)SDL_GetPerformanceFrequency();
+
+   LOG( _( "Replay finished: %" PRIu64 " frames and %" PRIu64
+           " ticks in %.3f s (%.3f ms per frame)." ),
+        replay_frames, replay_ticks, s,
+        ( replay_frames > 0 ) ? 1e3 * s / (double)replay_frames : 0. );
+   if ( replay_mismatches > 0 )
+      WARN( _( "Replay was not deterministic: %d of %d checksums did not "
+               "match!" ),
+            replay_mismatches, replay_checked );
+   else if ( replay_final == 0 )
+      WARN( _( "Replay was not deterministic: the final state did not "
+               "match!" ) );
+   else
+      LOG( _( "Replay was deterministic: all %d checksums matched." ),
+           replay_checked );
+
+   replay_exit();
+   naev_quit();
+}
+
+/**
+ * @brief Stops recording after the configured number of frames, storing the
+ * final state so the replay can compare against it, and quits the game.
+ */
+static void replay_recordEnd( void )
+{
+   uint64_t buf[2];
+   uint8_t  type = REPLAY_REC_END;
+
+   buf[0] = replay_ticks;
+   buf[1] = replay_checksum();
+   replay_write( &type, sizeof( type ) );
+   if ( replay_out != NULL )
+      replay_write( buf, sizeof( buf ) );
+   LOG( _( "Recorded %" PRIu64 " frames and %" PRIu64 " ticks." ),
+        replay_frames, replay_ticks );
+
+   replay_exit();
+   naev_quit();
+}
+
+/**
+ * @brief Writes data to the recording.
+ */
+static void replay_write( const void *data, size_t size )
+{
+   if ( PHYSFS_writeBytes( replay_out, data, size ) != (PHYSFS_sint64)size ) {
+      WARN( _( "Failed to write replay, stopping recording: %s" ),
+            _( PHYSFS_getErrorByCode( PHYSFS_getLastErrorCode() ) ) );
+      replay_exit();
+   }
+}
+
+/**
+ * @brief Reads data from the recording.
+ *
+ *    @return 0 on success, -1 if the recording ended.
+ */
+static int replay_read( void *data, size_t size )
+{
+   if ( replay_pos + size > replay_size )
+      return -1;
+   memcpy( data, &replay_data[replay_pos], size );
+   replay_pos += size;
+   return 0;
+}
+
+/**
+ * @brief Gets the type of the next record without consuming it.
+ *
+ *    @return The ReplayRecord type, or -1 if the recording ended.
+ */
+static int replay_peek( void )
+{
+   if ( replay_pos >= replay_size )
+      return -1;
+   return (uint8_t)replay_data[replay_pos];
+}
+
+/**
+ * @brief Gets the string referenced by an event, if any.
+ */
+static const char **replay_eventText( SDL_Event *event )
+{
+   switch ( event->type ) {
+   case SDL_EVENT_TEXT_INPUT:
+      return &event->text.text;
+   case SDL_EVENT_TEXT_EDITING:
+      return &event->edit.text;
+   default:
+      return NULL;
+   }
+}
+
+/**
+ * @brief Checks to see if an event references data that can't be recorded.
+ *
+ * None of these affect the simulation.
+ */
+static int replay_eventSkip( const SDL_Event *event )
+{
+   switch ( event->type ) {
+   case SDL_EVENT_DROP_FILE:
+   case SDL_EVENT_DROP_TEXT:
+   case SDL_EVENT_DROP_BEGIN:
+   case SDL_EVENT_DROP_COMPLETE:
+   case SDL_EVENT_DROP_POSITION:
+   case SDL_EVENT_CLIPBOARD_UPDATE:
+   case SDL_EVENT_TEXT_EDITING_CANDIDATES:
+      return 1;
+   default:
+      return 0;
+   }
+}
+
+/**
+ * @brief Writes an event to the recording.
+ */
+static void replay_writeEvent( SDL_Event *event )
+{
+   uint8_t      type = REPLAY_REC_EVENT;
+   const char **text;
+
+   if ( replay_eventSkip( event ) )
+      return;
+
+   replay_write( &type, sizeof( type ) );
+   if ( replay_out == NULL )
+      return;
+   replay_write( event, sizeof( SDL_Event ) );
+   text = replay_eventText( event );
+   if ( ( text != NULL ) && ( replay_out != NULL ) ) {
+      const char *str = ( *text != NULL ) ? *text : "";
+      uint32_t    len = strlen( str ) + 1;
+      replay_write( &len, sizeof( len ) );
+      if ( replay_out != NULL )
+         replay_write( str, len );
+   }
+}
+
+/**
+ * @brief Reads an event from the recording.
+ *
+ * Strings point into the recording, so they are valid until it is closed.
+ *
+ *    @return 0 on success.
+ */
+static int replay_readEvent( SDL_Event *event )
+{
+   uint8_t      type;
+   uint32_t     len;
+   const char **text;
+
+   if ( replay_read( &type, sizeof( type ) ) ||
+        replay_read( event, sizeof( SDL_Event ) ) )
+      return -1;
+   text = replay_eventText( event );
+   if ( text != NULL ) {
+      if ( replay_read( &len, sizeof( len ) ) || ( len == 0 ) ||
+           ( replay_pos + len > replay_size ) ||
+           ( replay_data[replay_pos + len - 1] != '\0' ) )
+         return -1;
+      *text = &replay_data[replay_pos];
+      replay_pos += len;
+   }
+   return 0;
+}
+
+/**
+ * @brief Replacement for SDL_PollEvent that records or replays the events.
+ *
+ *    @param[out] event Event that was polled.
+ *    @return 1 if an event was polled, 0 otherwise.
+ */
+int replay_pollEvent( SDL_Event *event )
+{
+   uint8_t type;
+
+   switch ( replay_mode ) {
+   case REPLAY_RECORD:
+      if ( !SDL_PollEvent( event ) ) {
+         type = REPLAY_REC_POLLEND;
+         replay_write( &type, sizeof( type ) );
+         return 0;
+      }
+      replay_writeEvent( event );
+      return 1;
+
+   case REPLAY_PLAY:
+      /* Real events get discarded, including those pushed by the replayed
+       * code, since the recording already has them. Only quitting is
+       * respected. */
+      SDL_PumpEvents();
+      if ( SDL_HasEvent( SDL_EVENT_QUIT ) ) {
+         replay_finish();
+         return 0;
+      }
+      SDL_FlushEvents( SDL_EVENT_FIRST, SDL_EVENT_LAST );
+
+      switch ( replay_peek() ) {
+      case REPLAY_REC_EVENT:
+         if ( replay_readEvent( event ) ) {
+            WARN( _( "Replay is truncated!" ) );
+            replay_finish();
+            return 0;
+         }
+         return 1;
+      case REPLAY_REC_POLLEND:
+         replay_pos++;
+         return 0;
+      case -1:
+         replay_finish();
+         return 0;
+      default:
+         return 0;
+      }
+
+   default:
+      return SDL_PollEvent( event );
+   }
+}
+
+/**
+ * @brief Records or replays the real delta tick of a frame.
+ *
+ *    @param[in,out] dt Real delta tick of the frame, gets overwritten when
+ * replaying.
+ */
+void replay_frame( double *dt )
+{
+   uint8_t type;
+
+   if ( replay_mode == REPLAY_RECORD ) {
+      if ( ( conf.record_frames > 0 ) &&
+           ( replay_frames >= (uint64_t)conf.record_frames ) ) {
+         replay_recordEnd();
+         return;
+      }
+      type = REPLAY_REC_FRAME;
+      replay_write( &type, sizeof( type ) );
+      if ( replay_out != NULL )
+         replay_write( dt, sizeof( double ) );
+      replay_frames++;
+      replay_clock += *dt;
+      return;
+   }
+   if ( replay_mode != REPLAY_PLAY )
+      return;
+
+   /* Skip anything that wasn't consumed, which only happens if desynced, until
+    * the next frame or the end of the recording. */
+   while ( replay_peek() != REPLAY_REC_FRAME ) {
+      SDL_Event event;
+      uint64_t  buf[2];
+      int       ret;
+      switch ( replay_peek() ) {
+      case REPLAY_REC_EVENT:
+         ret = replay_readEvent( &event );
+         break;
+      case REPLAY_REC_CHECKSUM:
+         replay_pos++;
+         ret = replay_read( buf, sizeof( buf ) );
+         replay_checked++;
+         replay_mismatches++;
+         break;
+      case REPLAY_REC_POLLEND:
+         replay_pos++;
+         ret = 0;
+         break;
+      case REPLAY_REC_END:
+         /* Compare at the same point of the frame as it was recorded. */
+         replay_pos++;
+         if ( replay_read( buf, sizeof( buf ) ) == 0 )
+            replay_final = ( buf[0] == replay_ticks ) &&
+                           ( buf[1] == replay_checksum() );
+         ret = -1;
+         break;
+      default:
+         ret = -1;
+         break;
+      }
+      if ( ret ) {
+         *dt = 0.;
+         replay_finish();
+         return;
+      }
+   }
+   replay_pos++;
+   if ( replay_read( dt, sizeof( double ) ) ) {
+      *dt = 0.;
+      replay_finish();
+      return;
+   }
+   replay_frames++;
+   replay_clock += *dt;
+}
+
+/**
+ * @brief Counts a simulation tick, and records or verifies the checksum when
+ * needed.
+ *
+ * Should be called at the end of update_routine().
+ */
+void replay_tick( void )
+{
+   uint64_t buf[2];
+   uint8_t  type;
+
+   if ( replay_mode == REPLAY_NONE )
+      return;
+
+   replay_ticks++;
+   if ( ( replay_checksumTicks == 0 ) ||
+        ( replay_ticks % replay_checksumTicks != 0 ) )
+      return;
+
+   if ( replay_mode == REPLAY_RECORD ) {
+      type   = REPLAY_REC_CHECKSUM;
+      buf[0] = replay_ticks;
+      buf[1] = replay_checksum();
+      replay_write( &type, sizeof( type ) );
+      if ( replay_out != NULL )
+         replay_write( buf, sizeof( buf ) );
+      return;
+   }
+
+   replay_checked++;
+   if ( replay_peek() != REPLAY_REC_CHECKSUM ) {
+      replay_mismatches++;
+      if ( replay_mismatches == 1 )
+         WARN( _( "Replay desynced at tick %" PRIu64 ": missing checksum." ),
+               replay_ticks );
+      return;
+   }
+   replay_pos++;
+   if ( replay_read( buf, sizeof( buf ) ) )
+      return;
+   if ( ( buf[0] != replay_ticks ) || ( buf[1] != replay_checksum() ) ) {
+      replay_mismatches++;
+      if ( replay_mismatches == 1 )
+         WARN( _( "Replay desynced at tick %" PRIu64 ": checksum mismatch." ),
+               replay_ticks );
+   }
+}
+
+/**
+ * @brief FNV-1a hash of some data.
+ */
+static uint64_t replay_hash( uint64_t h, const void *data, size_t size )
+{
+   const uint8_t *p = data;
+   for ( size_t i = 0; i < size; i++ )
+      h = ( h ^ p[i] ) * 0x100000001b3ULL;
+   return h;
+}
+
+/**
+ * @brief Computes a checksum of the simulation state.
+ *
+ * Covers the game time and the physics and health of all pilots and weapons,
+ * which is where any divergence shows up sooner or later.
+ *
+ *    @return Checksum of the current state.
+ */
+uint64_t replay_checksum( void )
+{
+   uint64_t      h       = 0xcbf29ce484222325ULL;
+   ntime_t       t       = ntime_get();
+   Pilot *const *pilots  = pilot_getAll();
+   const Weapon *weapons = weapon_getStack();
+
+   h = replay_hash( h, &t, sizeof( t ) );
+   for ( int i = 0; i < array_size( pilots ); i++ ) {
+      const Pilot *p = pilots[i];
+      h              = replay_hash( h, &p->id, sizeof( p->id ) );
+      h              = replay_hash( h, &p->solid.pos, sizeof( vec2 ) );
+      h              = replay_hash( h, &p->solid.vel, sizeof( vec2 ) );
+      h              = replay_hash( h, &p->solid.dir, sizeof( double ) );
+      h              = replay_hash( h, &p->armour, sizeof( double ) );
+      h              = replay_hash( h, &p->shield, sizeof( double ) );
+      h              = replay_hash( h, &p->energy, sizeof( double ) );
+   }
+   for ( int i = 0; i < array_size( weapons ); i++ ) {
+      const Weapon *w = &weapons[i];
+      h               = replay_hash( h, &w->id, sizeof( w->id ) );
+      h               = replay_hash( h, &w->solid.pos, sizeof( vec2 ) );
+      h               = replay_hash( h, &w->solid.vel, sizeof( vec2 ) );
+      h               = replay_hash( h, &w->armour, sizeof( double ) );
+   }
+   return h;
+}
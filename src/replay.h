@@ -0,0 +1,33 @@
+/*
+ * See Licensing and Copyright notice in naev.h
+ */
+#pragma once
+
+/** @cond */
+#include <SDL3/SDL_events.h>
+#include <stdint.h>
+/** @endcond */
+
+#define REPLAY_CHECKSUM_TICKS                                                  \
+   60 /**< Number of simulation ticks between checksums. */
+
+/*
+ * Control.
+ */
+int      replay_init( void );
+void     replay_exit( void );
+int      replay_isRecording( void );
+int      replay_isPlaying( void );
+uint64_t replay_getTicks( void );
+
+/*
+ * Main loop hooks.
+ */
+int  replay_pollEvent( SDL_Event *event );
+void replay_frame( double *dt );
+void replay_tick( void );
+
+/*
+ * Verification.
+ */
+uint64_t replay_checksum( void );
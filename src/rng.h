@@ -3,6 +3,10 @@
  */
 #pragma once
 
+/** @cond */
+#include <stdint.h>
+/** @endcond */
+
 /**
  * @brief Gets a random number between `L` and `H` (`L <= RNG <= H`).
  *
@@ -47,6 +51,10 @@
 /* Random functions */
 unsigned int randint( void );
 double       randfp( void );
+void         rng_seed( uint64_t seed );
+uint64_t     rng_getSeed( void );
+void         rng_renderStart( void );
+void         rng_renderEnd( void );
 
 /* Probability functions */
 double Normal( double x );
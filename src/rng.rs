@@ -1,5 +1,7 @@
 use mlua::{Either, UserData, UserDataMethods};
-use rand::RngExt;
+use rand::rngs::StdRng;
+use rand::{RngExt, SeedableRng};
+use std::cell::{Cell, RefCell};
 use std::os::raw::{c_double, c_uint};
 
 #[unsafe(no_mangle)]
@@ -19,15 +21,64 @@ pub unsafe extern "C" fn NormalInverse(p: c_double) -> c_double {
    normal_inverse(p) as c_double
 }
 
+/// Reseeds the random number generator of the calling thread.
+///
+/// Used by replays to get the exact same sequence of random numbers on the main thread.
+#[unsafe(no_mangle)]
+pub extern "C" fn rng_seed(seed: u64) {
+   seed_rng(seed);
+}
+/// Gets the seed the random number generator of the calling thread was last seeded with.
+#[unsafe(no_mangle)]
+#[allow(non_snake_case)]
+pub extern "C" fn rng_getSeed() -> u64 {
+   SEED.get()
+}
+
+/// Makes the calling thread use a separate random number stream until [`rng_renderEnd`].
+///
+/// Rendering is skipped when replaying, so anything random it does must not advance the stream
+/// used by the simulation.
+#[unsafe(no_mangle)]
+#[allow(non_snake_case)]
+pub extern "C" fn rng_renderStart() {
+   RENDERING.set(true);
+}
+/// Goes back to the main random number stream after [`rng_renderStart`].
+#[unsafe(no_mangle)]
+#[allow(non_snake_case)]
+pub extern "C" fn rng_renderEnd() {
+   RENDERING.set(false);
+}
+
 thread_local! {
-    static RNG: std::cell::RefCell<rand::rngs::ThreadRng> = std::cell::RefCell::new(rand::rng());
+    static SEED: Cell<u64> = Cell::new(rand::rng().random::<u64>());
+    static RNG: RefCell<StdRng> = RefCell::new(StdRng::seed_from_u64(SEED.get()));
+    static RENDERING: Cell<bool> = const { Cell::new(false) };
+    static RENDER_RNG: RefCell<StdRng> =
+        RefCell::new(StdRng::seed_from_u64(rand::rng().random::<u64>()));
+}
+
+/// Runs a function with the random number generator of the current stream.
+fn with_rng<T>(f: impl FnOnce(&mut StdRng) -> T) -> T {
+   if RENDERING.get() {
+      RENDER_RNG.with_borrow_mut(f)
+   } else {
+      RNG.with_borrow_mut(f)
+   }
+}
+
+/// Reseeds the random number generator of the current thread.
+pub fn seed_rng(seed: u64) {
+   SEED.set(seed);
+   RNG.set(StdRng::seed_from_u64(seed));
 }
 
 pub fn rng<T>() -> T
 where
    rand::distr::StandardUniform: rand::prelude::Distribution<T>,
 {
-   RNG.with_borrow_mut(|x| x.random::<T>())
+   with_rng(|x| x.random::<T>())
 }
 
 pub fn range<T, R>(range: R) -> T
@@ -35,7 +86,7 @@ where
    T: std::cmp::PartialOrd + rand::distr::uniform::SampleUniform,
    R: rand::distr::uniform::SampleRange<T>,
 {
-   RNG.with_borrow_mut(|x| x.random_range(range))
+   with_rng(|x| x.random_range(range))
 }
 
 // Taken from probability package.
@@ -333,7 +384,7 @@ impl UserData for Rnd {
                Either::Right(ref tbl) => tbl.len()? as usize,
             };
             let mut vals: Vec<usize> = (0..len).collect();
-            RNG.with_borrow_mut(|x| vals.shuffle(x));
+            with_rng(|x| vals.shuffle(x));
 
             let t = lua.create_table()?;
             match val {
@@ -359,6 +410,29 @@ pub fn open_rnd(lua: &mlua::Lua) -> anyhow::Result<mlua::AnyUserData> {
    Ok(lua.create_proxy::<Rnd>()?)
 }
 
+#[test]
+fn test_rng_seed() {
+   seed_rng(1234);
+   let a: Vec<u64> = (0..16).map(|_| rng::<u64>()).collect();
+   seed_rng(1234);
+   let b: Vec<u64> = (0..16).map(|_| rng::<u64>()).collect();
+   assert_eq!(a, b);
+   assert_eq!(rng_getSeed(), 1234);
+}
+
+#[test]
+fn test_rng_render() {
+   seed_rng(1234);
+   let a: Vec<u64> = (0..16).map(|_| rng::<u64>()).collect();
+   seed_rng(1234);
+   let mut b: Vec<u64> = (0..8).map(|_| rng::<u64>()).collect();
+   rng_renderStart();
+   let _: Vec<f64> = (0..100).map(|_| rng::<f64>()).collect();
+   rng_renderEnd();
+   b.extend((0..8).map(|_| rng::<u64>()));
+   assert_eq!(a, b);
+}
+
 #[test]
 fn main() {
    let lua = mlua::Lua::new();
@@ -183,6 +183,20 @@ SHADERS = [
       attributes = ["vertex"],
       uniforms = ["projection", "colour"],
    ),
+   Shader(
+      name = "maplanes",
+      vs_path = "maplanes.vert",
+      fs_path = "maplanes.frag",
+      attributes = ["centre", "dir", "vertex", "size", "colour_start", "colour_end"],
+      uniforms = ["projection", "zoom", "radius"],
+   ),
+   Shader(
+      name = "mapsystems",
+      vs_path = "mapsystems.vert",
+      fs_path = "mapsystems.frag",
+      attributes = ["centre", "vertex", "size", "filled", "vertex_colour"],
+      uniforms = ["projection", "zoom", "radius"],
+   ),
    Shader(
       name = "font",
       vs_path = "font.vert",
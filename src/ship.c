@@ -390,6 +390,7 @@ void ship_renderGfxStore( GLuint fbo, const Ship *s, int size, double dir,
 
 void ship_gfxLoad( Ship *s )
 {
+   s->gfx_used = SDL_GetTicks();
    ship_setFlag( s, SHIP_NEEDSGFX );
    ship_gfxLoadNeeded();
 }
@@ -618,6 +619,39 @@ int ship_gfxLoaded( const Ship *s )
    return ( ( s->gfx_3d != NULL ) || ( s->gfx_space != NULL ) );
 }
 
+/**
+ * @brief Frees the graphics of a ship. They will be loaded again on demand.
+ *
+ * Must not be called while any pilot is using the ship.
+ *
+ *    @param s Ship to free graphics of.
+ */
+void ship_gfxFree( Ship *s )
+{
+   gltf_free( s->gfx_3d );
+   gl_freeTexture( s->gfx_space );
+   gl_freeTexture( s->gfx_engine );
+   gl_freeTexture( s->_gfx_store );
+   poly_free( s->polygon );
+   s->gfx_3d     = NULL;
+   s->gfx_space  = NULL;
+   s->gfx_engine = NULL;
+   s->_gfx_store = NULL;
+   s->polygon    = NULL;
+}
+
+/**
+ * @brief Estimates the memory used by the graphics of a ship.
+ *
+ *    @param s Ship to get memory usage of.
+ *    @return Estimated memory usage in bytes.
+ */
+size_t ship_gfxMemory( const Ship *s )
+{
+   return gltf_memory( s->gfx_3d ) + tex_memory( s->gfx_space ) +
+          tex_memory( s->gfx_engine ) + tex_memory( s->_gfx_store );
+}
+
 /**
  * @brief Loads the graphics for a ship if necessary.
  *
@@ -1793,11 +1827,8 @@ void ships_free( void )
 
       ss_free( s->stats );
 
-      /* Free graphics. */
-      gltf_free( s->gfx_3d );
-      gl_freeTexture( s->gfx_space );
-      gl_freeTexture( s->gfx_engine );
-      gl_freeTexture( s->_gfx_store );
+      /* Free graphics and collision polygons. */
+      ship_gfxFree( s );
       free( s->gfx_comm );
       for ( int j = 0; j < array_size( s->gfx_overlays ); j++ )
          gl_freeTexture( s->gfx_overlays[j] );
@@ -1805,9 +1836,6 @@ void ships_free( void )
       free( s->gfx_path );
       free( s->polygon_path );
 
-      /* Free collision polygons. */
-      poly_free( s->polygon );
-
       /* Free trail emitters. */
       array_free( s->trail_emitters );
 
@@ -161,6 +161,7 @@ typedef struct Ship {
    glTexture  *_gfx_store;    /**< Store graphic. */
    char       *gfx_comm;      /**< Name of graphic for communication. */
    glTexture **gfx_overlays;  /**< Array (array.h): Store overlay graphics. */
+   uint64_t    gfx_used; /**< Last time the graphics were used (eviction). */
    ShipTrailEmitter *trail_emitters; /**< Trail emitters. */
    int               sx; /* TODO remove this and sy when possible. */
    int               sy;
@@ -250,5 +251,7 @@ int    ship_gfxLoaded( const Ship *s );
 int    ship_gfxLoadNeeded( void );
 int    ship_gfxLoadPost3D( Ship *temp );
 int    ship_gfxLoad2D( Ship *s, const char *base, const char *ext );
+void   ship_gfxFree( Ship *s );
+size_t ship_gfxMemory( const Ship *s );
 int    ship_compareTech( const void *arg1, const void *arg2 );
 double ship_maxSize( void );
@@ -302,9 +302,64 @@ static const StatRename ss_rename[] = {
    { .old = NULL, .new = NULL },
 };
 
+/**
+ * @brief Groups of contiguous fields of the same data type in ShipStats.
+ */
+typedef enum ShipStatsGroupType_ {
+   SS_GROUP_RELATIVE,          /**< Relative doubles. */
+   SS_GROUP_RELATIVE_INVERTED, /**< Inverted relative doubles. */
+   SS_GROUP_ABSOLUTE,          /**< Absolute and percent doubles. */
+   SS_GROUP_INTEGER,           /**< Integers. */
+   SS_GROUP_BOOLEAN,           /**< Booleans. */
+   SS_GROUP_SENTINEL,          /**< Number of groups. */
+} ShipStatsGroupType;
+
+/**
+ * @brief Byte range of a group of fields in ShipStats.
+ */
+typedef struct ShipStatsGroup_ {
+   size_t start; /**< Offset of the first field. */
+   size_t end;   /**< Offset past the last field. */
+} ShipStatsGroup;
+
+#define SS_GROUP( first, last )                                                \
+   { .start = offsetof( ShipStats, first ),                                    \
+     .end   = offsetof( ShipStats, last ) + sizeof( ( (ShipStats *)0 )->last ) }
+
+/**
+ * Field ranges of each group, must match the order in ShipStats. Checked by
+ * ss_check().
+ */
+static const ShipStatsGroup ss_groups[SS_GROUP_SENTINEL] = {
+   [SS_GROUP_RELATIVE]          = SS_GROUP( speed_mod, jump_distance ),
+   [SS_GROUP_RELATIVE_INVERTED] = SS_GROUP( fuel_usage_mod, jump_warmup ),
+   [SS_GROUP_ABSOLUTE]          = SS_GROUP( speed, fuel_regen ),
+   [SS_GROUP_INTEGER]           = SS_GROUP( fuel, crew ),
+   [SS_GROUP_BOOLEAN]           = SS_GROUP( misc_instant_jump, invincible ),
+};
+
+/**
+ * @brief Stat list compiled into field offsets and values, sorted by group so
+ * that each group can be merged with a simple loop.
+ */
+struct ShipStatsPacked {
+   unsigned int groups; /**< Mask of the groups that have stats. */
+   int start[SS_GROUP_SENTINEL + 1]; /**< First entry of each group. */
+   size_t *offset;                   /**< Offsets of the fields. */
+   double *d; /**< Values of the entries in double groups. */
+   int    *i; /**< Values of the entries in integer groups. */
+};
+
+/* Gets the fields of a group as an array. */
+#define SS_GROUP_ARRAY( type, ptr, g )                                         \
+   ( (type *)(void *)&( ptr )[ss_groups[g].start] )
+#define SS_GROUP_LEN( type, g )                                                \
+   ( (int)( ( ss_groups[g].end - ss_groups[g].start ) / sizeof( type ) ) )
+
 /*
  * Prototypes.
  */
+static ShipStatsGroupType ss_group( const ShipStatsLookup *sl );
 static const char *ss_printD_colour( double d, const ShipStatsLookup *sl );
 static const char *ss_printI_colour( int i, const ShipStatsLookup *sl );
 static int         ss_printD( char *buf, int len, int newline, double d,
@@ -540,10 +595,36 @@ int ss_sort( ShipStatList **ll )
  */
 int ss_check( void )
 {
+   size_t size[SS_GROUP_SENTINEL] = { 0 };
+
    for ( ShipStatsType i = 0; i <= SS_TYPE_SENTINEL; i++ ) {
-      if ( ss_lookup[i].type != i ) {
-         WARN( _( "ss_lookup: %s should have id %d but has %d" ),
-               ss_lookup[i].name, i, ss_lookup[i].type );
+      const ShipStatsLookup *sl = &ss_lookup[i];
+      ShipStatsGroupType     g;
+
+      if ( sl->type != i ) {
+         WARN( _( "ss_lookup: %s should have id %d but has %d" ), sl->name, i,
+               sl->type );
+         return -1;
+      }
+      if ( sl->name == NULL )
+         continue;
+
+      /* Make sure the field is in the right group. */
+      g = ss_group( sl );
+      if ( ( sl->offset < ss_groups[g].start ) ||
+           ( sl->offset >= ss_groups[g].end ) ) {
+         WARN( _( "ss_lookup: %s is not in the ShipStats group of its data "
+                  "type" ),
+               sl->name );
+         return -1;
+      }
+      size[g] += ( g >= SS_GROUP_INTEGER ) ? sizeof( int ) : sizeof( double );
+   }
+
+   /* Make sure there are no fields missing from the groups. */
+   for ( int g = 0; g < SS_GROUP_SENTINEL; g++ ) {
+      if ( size[g] != ss_groups[g].end - ss_groups[g].start ) {
+         WARN( _( "ss_lookup: ShipStats group %d has unknown fields" ), g );
          return -1;
       }
    }
@@ -551,42 +632,43 @@ int ss_check( void )
    return 0;
 }
 
+/**
+ * @brief Gets the group a stat belongs to in ShipStats.
+ */
+static ShipStatsGroupType ss_group( const ShipStatsLookup *sl )
+{
+   switch ( sl->data ) {
+   case SS_DATA_TYPE_DOUBLE:
+      return ( sl->inverted ) ? SS_GROUP_RELATIVE_INVERTED : SS_GROUP_RELATIVE;
+   case SS_DATA_TYPE_DOUBLE_ABSOLUTE:
+   case SS_DATA_TYPE_DOUBLE_ABSOLUTE_PERCENT:
+      return SS_GROUP_ABSOLUTE;
+   case SS_DATA_TYPE_INTEGER:
+      return SS_GROUP_INTEGER;
+   case SS_DATA_TYPE_BOOLEAN:
+      return SS_GROUP_BOOLEAN;
+   }
+   return SS_GROUP_ABSOLUTE;
+}
+
 /**
  * @brief Initializes a stat structure.
  */
 int ss_statsInit( ShipStats *stats )
 {
-   char *ptr;
+   double *dbl;
 
    /* Clear the memory. */
    memset( stats, 0, sizeof( ShipStats ) );
 
-   ptr = (char *)stats;
-   for ( int i = 0; i < SS_TYPE_SENTINEL; i++ ) {
-      const ShipStatsLookup *sl = &ss_lookup[i];
-
-      /* Only want valid names. */
-      if ( sl->name == NULL )
-         continue;
-
-      /* Handle doubles. */
-      switch ( sl->data ) {
-      case SS_DATA_TYPE_DOUBLE: {
-         double     *dbl;
-         const char *fieldptr = &ptr[sl->offset];
-         memcpy( &dbl, &fieldptr, sizeof( double * ) );
-         *dbl = 1.0;
-         break;
-      }
-
-         /* No need to set, memset does the work. */
-      case SS_DATA_TYPE_DOUBLE_ABSOLUTE:
-      case SS_DATA_TYPE_DOUBLE_ABSOLUTE_PERCENT:
-      case SS_DATA_TYPE_INTEGER:
-      case SS_DATA_TYPE_BOOLEAN:
-         break;
-      }
-   }
+   /* Relative doubles are centred around 1. */
+   dbl = SS_GROUP_ARRAY( double, (char *)stats, SS_GROUP_RELATIVE );
+   for ( int i = 0; i < SS_GROUP_LEN( double, SS_GROUP_RELATIVE ); i++ )
+      dbl[i] = 1.0;
+   dbl = SS_GROUP_ARRAY( double, (char *)stats, SS_GROUP_RELATIVE_INVERTED );
+   for ( int i = 0; i < SS_GROUP_LEN( double, SS_GROUP_RELATIVE_INVERTED );
+         i++ )
+      dbl[i] = 1.0;
 
    return 0;
 }
@@ -594,57 +676,95 @@ int ss_statsInit( ShipStats *stats )
 /**
  * @brief Merges two different ship stats.
  *
+ * Since fields of the same data type are contiguous in ShipStats, this works
+ * on each group as a flat array, which the compiler can vectorize.
+ *
  *    @param dest Destination ship stats.
  *    @param src Source to be merged with destination.
  *    @param multiply Whether or not to use multiplication for merging.
  */
 int ss_statsMerge( ShipStats *dest, const ShipStats *src, int multiply )
 {
-   int          *destint;
-   const int    *srcint;
+   return ss_statsMergeGroups( dest, src, multiply, ~0u );
+}
+
+/**
+ * @brief Merges only some groups of two different ship stats.
+ *
+ * Groups not in the mask must be the identity in the source, such as the
+ * groups not touched by any of the lists the source was built from.
+ *
+ *    @param dest Destination ship stats.
+ *    @param src Source to be merged with destination.
+ *    @param multiply Whether or not to use multiplication for merging.
+ *    @param groups Mask of the groups to merge, as returned by
+ * ss_listGroups().
+ */
+int ss_statsMergeGroups( ShipStats *dest, const ShipStats *src, int multiply,
+                         unsigned int groups )
+{
+   char         *destptr = (char *)dest;
+   const char   *srcptr  = (const char *)src;
    double       *destdbl;
    const double *srcdbl;
-   char         *destptr;
-   const char   *srcptr;
-
-   destptr = (char *)dest;
-   srcptr  = (const char *)src;
-   for ( int i = 0; i < SS_TYPE_SENTINEL; i++ ) {
-      const ShipStatsLookup *sl = &ss_lookup[i];
-
-      /* Only want valid names. */
-      if ( sl->name == NULL )
-         continue;
+   int          *destint;
+   const int    *srcint;
+   int           n;
+
+   /* Relative doubles. */
+   if ( groups & ( 1u << SS_GROUP_RELATIVE ) ) {
+      destdbl = SS_GROUP_ARRAY( double, destptr, SS_GROUP_RELATIVE );
+      srcdbl  = SS_GROUP_ARRAY( const double, srcptr, SS_GROUP_RELATIVE );
+      n       = SS_GROUP_LEN( double, SS_GROUP_RELATIVE );
+      if ( multiply ) {
+         for ( int i = 0; i < n; i++ )
+            destdbl[i] *= srcdbl[i];
+      } else {
+         for ( int i = 0; i < n; i++ )
+            destdbl[i] += srcdbl[i];
+      }
+   }
 
-      switch ( sl->data ) {
-      case SS_DATA_TYPE_DOUBLE:
-         destdbl = (double *)(void *)&destptr[sl->offset];
-         srcdbl  = (const double *)(const void *)&srcptr[sl->offset];
-         if ( multiply )
-            *destdbl *= *srcdbl;
-         else
-            ss_adjustDoubleStat( destdbl, *srcdbl, sl->inverted );
-         break;
+   /* Inverted relative doubles, see ss_adjustDoubleStat. */
+   if ( groups & ( 1u << SS_GROUP_RELATIVE_INVERTED ) ) {
+      destdbl = SS_GROUP_ARRAY( double, destptr, SS_GROUP_RELATIVE_INVERTED );
+      srcdbl =
+         SS_GROUP_ARRAY( const double, srcptr, SS_GROUP_RELATIVE_INVERTED );
+      n = SS_GROUP_LEN( double, SS_GROUP_RELATIVE_INVERTED );
+      if ( multiply ) {
+         for ( int i = 0; i < n; i++ )
+            destdbl[i] *= srcdbl[i];
+      } else {
+         for ( int i = 0; i < n; i++ )
+            destdbl[i] *= 1. + srcdbl[i];
+      }
+   }
 
-      case SS_DATA_TYPE_DOUBLE_ABSOLUTE:
-      case SS_DATA_TYPE_DOUBLE_ABSOLUTE_PERCENT:
-         destdbl = (double *)(void *)&destptr[sl->offset];
-         srcdbl  = (const double *)(const void *)&srcptr[sl->offset];
-         *destdbl += *srcdbl;
-         break;
+   /* Absolute doubles. */
+   if ( groups & ( 1u << SS_GROUP_ABSOLUTE ) ) {
+      destdbl = SS_GROUP_ARRAY( double, destptr, SS_GROUP_ABSOLUTE );
+      srcdbl  = SS_GROUP_ARRAY( const double, srcptr, SS_GROUP_ABSOLUTE );
+      n       = SS_GROUP_LEN( double, SS_GROUP_ABSOLUTE );
+      for ( int i = 0; i < n; i++ )
+         destdbl[i] += srcdbl[i];
+   }
 
-      case SS_DATA_TYPE_INTEGER:
-         destint = (int *)&destptr[sl->offset];
-         srcint  = (const int *)&srcptr[sl->offset];
-         *destint += *srcint;
-         break;
+   /* Integers. */
+   if ( groups & ( 1u << SS_GROUP_INTEGER ) ) {
+      destint = SS_GROUP_ARRAY( int, destptr, SS_GROUP_INTEGER );
+      srcint  = SS_GROUP_ARRAY( const int, srcptr, SS_GROUP_INTEGER );
+      n       = SS_GROUP_LEN( int, SS_GROUP_INTEGER );
+      for ( int i = 0; i < n; i++ )
+         destint[i] += srcint[i];
+   }
 
-      case SS_DATA_TYPE_BOOLEAN:
-         destint  = (int *)&destptr[sl->offset];
-         srcint   = (const int *)&srcptr[sl->offset];
-         *destint = !!( ( *destint ) + ( *srcint ) );
-         break;
-      }
+   /* Booleans. */
+   if ( groups & ( 1u << SS_GROUP_BOOLEAN ) ) {
+      destint = SS_GROUP_ARRAY( int, destptr, SS_GROUP_BOOLEAN );
+      srcint  = SS_GROUP_ARRAY( const int, srcptr, SS_GROUP_BOOLEAN );
+      n       = SS_GROUP_LEN( int, SS_GROUP_BOOLEAN );
+      for ( int i = 0; i < n; i++ )
+         destint[i] = !!( destint[i] + srcint[i] );
    }
 
    return 0;
@@ -773,6 +893,147 @@ int ss_statsMergeFromListScale( ShipStats *stats, const ShipStatList *list,
    return ret;
 }
 
+/**
+ * @brief Gets the groups of ShipStats fields touched by a stat list.
+ *
+ *    @param list List to check.
+ *    @return Mask of the groups, to be used with ss_statsMergeGroups().
+ */
+unsigned int ss_listGroups( const ShipStatList *list )
+{
+   unsigned int groups = 0;
+   for ( const ShipStatList *ll = list; ll != NULL; ll = ll->next )
+      groups |= 1u << ss_group( &ss_lookup[ll->type] );
+   return groups;
+}
+
+/**
+ * @brief Compiles a stat list so that it can be merged quickly.
+ *
+ * Meant for lists that don't change once loaded, such as the outfit stats.
+ *
+ *    @param ll List to compile.
+ *    @return The compiled list or NULL if the list is empty.
+ */
+ShipStatsPacked *ss_pack( const ShipStatList *ll )
+{
+   ShipStatsPacked *pk;
+   int              pos[SS_GROUP_SENTINEL] = { 0 };
+   int              n                      = 0;
+
+   if ( ll == NULL )
+      return NULL;
+
+   pk = calloc( 1, sizeof( ShipStatsPacked ) );
+
+   /* Count the entries of each group. */
+   for ( const ShipStatList *l = ll; l != NULL; l = l->next ) {
+      ShipStatsGroupType g = ss_group( &ss_lookup[l->type] );
+      pk->start[g + 1]++;
+      pk->groups |= 1u << g;
+      n++;
+   }
+   for ( int g = 0; g < SS_GROUP_SENTINEL; g++ ) {
+      pk->start[g + 1] += pk->start[g];
+      pos[g] = pk->start[g];
+   }
+
+   /* Fill in sorted by group. */
+   pk->offset = malloc( n * sizeof( size_t ) );
+   pk->d      = calloc( n, sizeof( double ) );
+   pk->i      = calloc( n, sizeof( int ) );
+   for ( const ShipStatList *l = ll; l != NULL; l = l->next ) {
+      const ShipStatsLookup *sl = &ss_lookup[l->type];
+      ShipStatsGroupType     g  = ss_group( sl );
+      int                    k  = pos[g]++;
+      pk->offset[k]             = sl->offset;
+      if ( g >= SS_GROUP_INTEGER )
+         pk->i[k] = l->d.i;
+      else
+         pk->d[k] = l->d.d;
+   }
+
+   return pk;
+}
+
+/**
+ * @brief Frees a compiled stat list.
+ */
+void ss_packFree( ShipStatsPacked *pk )
+{
+   if ( pk == NULL )
+      return;
+   free( pk->offset );
+   free( pk->d );
+   free( pk->i );
+   free( pk );
+}
+
+/**
+ * @brief Gets the groups of ShipStats fields touched by a compiled stat list.
+ *
+ *    @param pk Compiled list to check.
+ *    @return Mask of the groups, to be used with ss_statsMergeGroups().
+ */
+unsigned int ss_packGroups( const ShipStatsPacked *pk )
+{
+   return ( pk == NULL ) ? 0 : pk->groups;
+}
+
+/* Gets a field of a ShipStats by offset. */
+#define SS_FIELD( type, ptr, off ) ( (type *)(void *)&( ptr )[off] )
+
+/**
+ * @brief Updates a stat structure from a compiled stat list, same as
+ * ss_statsMergeFromList() with the original list.
+ *
+ *    @param stats Stats to update.
+ *    @param pk Compiled list to update from.
+ *    @param multiply Whether or not to use multiplication for merging.
+ *    @return 0 on success.
+ */
+int ss_statsMergeFromPacked( ShipStats *stats, const ShipStatsPacked *pk,
+                             int multiply )
+{
+   char *ptr = (char *)stats;
+   int   g;
+
+   if ( pk == NULL )
+      return 0;
+
+   /* Relative doubles, see ss_adjustDoubleStat. */
+   g = SS_GROUP_RELATIVE;
+   if ( multiply ) {
+      for ( int k = pk->start[g]; k < pk->start[g + 1]; k++ )
+         *SS_FIELD( double, ptr, pk->offset[k] ) *= 1. + pk->d[k];
+   } else {
+      for ( int k = pk->start[g]; k < pk->start[g + 1]; k++ )
+         *SS_FIELD( double, ptr, pk->offset[k] ) += pk->d[k];
+   }
+   g = SS_GROUP_RELATIVE_INVERTED;
+   for ( int k = pk->start[g]; k < pk->start[g + 1]; k++ )
+      *SS_FIELD( double, ptr, pk->offset[k] ) *= 1. + pk->d[k];
+
+   /* Absolute doubles. */
+   g = SS_GROUP_ABSOLUTE;
+   for ( int k = pk->start[g]; k < pk->start[g + 1]; k++ )
+      *SS_FIELD( double, ptr, pk->offset[k] ) += pk->d[k];
+
+   /* Integers. */
+   g = SS_GROUP_INTEGER;
+   for ( int k = pk->start[g]; k < pk->start[g + 1]; k++ )
+      *SS_FIELD( int, ptr, pk->offset[k] ) += pk->i[k];
+
+   /* Booleans can only be set to true. */
+   g = SS_GROUP_BOOLEAN;
+   for ( int k = pk->start[g]; k < pk->start[g + 1]; k++ )
+      *SS_FIELD( int, ptr, pk->offset[k] ) = 1;
+
+   return 0;
+}
+
+#undef SS_FIELD
+
 /**
  * @brief Gets the name from type.
  *
@@ -1265,6 +1526,16 @@ int ss_statsGetLua( lua_State *L, const ShipStats *s, const char *name,
 int ss_statsGetLuaTable( lua_State *L, const ShipStats *s, int internal )
 {
    lua_newtable( L );
+   return ss_statsSetLuaTable( L, s, internal );
+}
+
+/**
+ * @brief Sets all the ship stats in the Lua table at the top of the stack.
+ *
+ * Allows reusing an existing table instead of creating a new one.
+ */
+int ss_statsSetLuaTable( lua_State *L, const ShipStats *s, int internal )
+{
    for ( int i = 0; i < SS_TYPE_SENTINEL; i++ ) {
       const ShipStatsLookup *sl = &ss_lookup[i];
 
@@ -192,7 +192,8 @@ typedef enum ShipStatsType {
     */
    SS_TYPE_SENTINEL /**< Sentinel for end of types. */
 } ShipStatsType;
-typedef struct ShipStatList ShipStatList;
+typedef struct ShipStatList   ShipStatList;
+typedef struct ShipStatsPacked ShipStatsPacked;
 
 /**
  * @brief Represents ship statistics, properties ship can use.
@@ -213,150 +214,141 @@ typedef struct ShipStatList ShipStatList;
  *
  * Booleans:
  *  1 or 0 values where 1 indicates property is set.
+ *
+ * Fields are grouped by data type so that merging can work on contiguous
+ * arrays, ss_check() makes sure they stay that way.
  */
 typedef struct ShipStats {
-   /* Movement. */
-   double speed;     /**< Speed modifier. */
-   double turn;      /**< Turn modifier. */
-   double accel;     /**< Accel modifier. */
-   double speed_mod; /**< Speed multiplier. */
-   double turn_mod;  /**< Turn multiplier. */
-   double accel_mod; /**< Accel multiplier. */
-
-   /* Health. */
-   double energy;             /**< Energy modifier. */
-   double energy_regen;       /**< Energy regeneration modifier. */
+   /* Relative doubles, centred around 1. and additive when merged. */
+   double speed_mod;          /**< Speed multiplier. */
+   double turn_mod;           /**< Turn multiplier. */
+   double accel_mod;          /**< Accel multiplier. */
    double energy_mod;         /**< Energy multiplier. */
    double energy_regen_mod;   /**< Energy regeneration multiplier. */
-   double energy_regen_malus; /**< Energy usage (flat). */
-   double shield;             /**< Shield modifier. */
-   double shield_regen;       /**< Shield regeneration modifier. */
    double shield_mod;         /**< Shield multiplier. */
    double shield_regen_mod;   /**< Shield regeneration multiplier. */
-   double shield_regen_malus; /**< Shield usage (flat). */
-   double armour;             /**< Armour modifier. */
-   double armour_regen;       /**< Armour regeneration modifier. */
    double armour_mod;         /**< Armour multiplier. */
    double armour_regen_mod;   /**< Armour regeneration multiplier. */
-   double armour_regen_malus; /**< Armour regeneration (flat). */
-   double damage;             /**< Damage over time. */
-   double disable;            /**< Disable over time. */
-
-   /* General */
-   double cargo_mod;      /**< Cargo space multiplier. */
-   double fuel_mod;       /**< Fuel capacity multiplier. */
-   double fuel_usage_mod; /**< Fuel usage modifier. */
-   double cpu_mod;        /**< CPU multiplier. */
-   double cpu;            /**< CPU usage, does not get multiplied. */
-   double cpu_max;        /**< CPU modifier. */
-   double damage_taken;   /**< Damage taken. */
-   double absorb;         /**< Flat damage absorption. */
-   double cooldown_mod;   /**< Ability cooldown mod. */
-   double shielddown_mod; /**< Time shields are down. */
-
-   /* Freighter-type. */
-   double jump_delay;    /**< Modulates the time that passes during a hyperspace
-                            jump. */
-   double land_delay;    /**< Modulates the time that passes during landing. */
-   double cargo_inertia; /**< Lowers the effect of cargo mass. */
-
-   /* Stealth. */
-   double ew_hide;        /**< Electronic warfare hide modifier. */
-   double ew_detected;    /**< Electronic warfare detected modifier. */
-   double ew_signature;   /**< Electronic warfare signature modifier. */
-   double ew_stealth;     /**< Electronic warfare stealth modifier. */
-   double ew_stealth_min; /**< Electronic warfare minimum stealth modifier. */
-   double ew_detect;      /**< Electronic warfare detection modifier. */
-   double ew_track;       /**< Electronic warfare tracking modifier. */
-   double
-      ew_jump_detect; /**< Electronic warfare jump point detection modifier. */
-   double ew_stealth_timer; /**< Stealth timer decrease speed. */
-   double ew_scanned_time;  /**< Time to scan. */
-
-   /* Military type. */
+   double cargo_mod;          /**< Cargo space multiplier. */
+   double fuel_mod;           /**< Fuel capacity multiplier. */
+   double cpu_mod;            /**< CPU multiplier. */
+   double ew_detect;          /**< Electronic warfare detection modifier. */
+   double ew_track;           /**< Electronic warfare tracking modifier. */
+   double ew_jump_detect;     /**< Electronic warfare jump point detection
+                                 modifier. */
+   double ew_scanned_time;    /**< Time to scan. */
    double stress_dissipation; /**< Global stress dissipation. */
    double crew_mod;           /**< Relative crew modification. */
-   double mass_mod;           /**< Relative mass modification. */
-   double mass;               /**< Absolute mass. */
-
-   /* Weapons. */
-   double weapon_range;      /**< Weapon range. */
-   double weapon_damage;     /**< Weapon damage. */
-   double weapon_firerate;   /**< Weapon firerate. */
-   double weapon_energy;     /**< Weapon energy usage. */
-   double weapon_dam_as_dis; /**< Weapon damage as disable. */
-   double weapon_speed;      /**< Weapon speed. */
-
-   /* Launchers. */
+   double weapon_range;       /**< Weapon range. */
+   double weapon_damage;      /**< Weapon damage. */
+   double weapon_firerate;    /**< Weapon firerate. */
+   double weapon_dam_as_dis;  /**< Weapon damage as disable. */
+   double weapon_speed;       /**< Weapon speed. */
    double launch_rate;        /**< Fire rate of launchers. */
    double launch_range;       /**< Range of launchers. */
    double launch_damage;      /**< Damage of launchers. */
-   double launch_energy;      /**< Energy usage of launchers. */
    double launch_dam_as_dis;  /**< Launcher damage as disable. */
    double ammo_capacity;      /**< Capacity of launchers. */
+   double launch_reload;      /**< Reload rate of launchers. */
+   double launch_accel;       /**< Missile accel. */
+   double launch_speed;       /**< Missile speed. */
+   double launch_turn;        /**< Missile turn. */
+   double fbay_damage;        /**< Fighter bay fighter damage (all weapons). */
+   double fbay_health;        /**< Fighter bay fighter health (armour and
+                                 shield). */
+   double fbay_movement;      /**< Fighter bay fighter movement (thrust, turn,
+                                 and speed). */
+   double fbay_capacity;      /**< Capacity of fighter bays. */
+   double fbay_rate;          /**< Launch rate of fighter bays. */
+   double fbay_reload;        /**< Reload rate of fighters. */
+   double fwd_damage;         /**< Damage of forward mounts. */
+   double fwd_tracking;       /**< Tracking of forward mounts. */
+   double fwd_firerate;       /**< Rate of fire of forward mounts. */
+   double fwd_dam_as_dis;     /**< Damage as disable for forward mounts. */
+   double fwd_range;          /**< Range of forward mounts. */
+   double fwd_speed;          /**< Forward weapon speed. */
+   double tur_damage;         /**< Damage of turrets. */
+   double tur_tracking;       /**< Tracking of turrets. */
+   double tur_firerate;       /**< Rate of fire of turrets. */
+   double tur_dam_as_dis;     /**< Damage as disable for turrets. */
+   double tur_range;          /**< Range of forward mounts. */
+   double tur_speed;          /**< Turret weapon speed. */
+   double engine_limit_rel;   /**< Engine limit modifier. */
+   double mining_bonus;       /**< Bonus when mining asteroids. */
+   double ship_price;         /**< Base price of the ship. */
+   double loot_mod;           /**< Boarding loot reward bonus. */
+   double action_speed;       /**< Makes the pilot operate at higher speeds. */
+   double jump_distance;      /**< Modifies how far the pilot can jump from the
+                                 jump point. */
+
+   /* Relative doubles where less is better, multiplicative when merged. */
+   double fuel_usage_mod;     /**< Fuel usage modifier. */
+   double damage_taken;       /**< Damage taken. */
+   double cooldown_mod;       /**< Ability cooldown mod. */
+   double shielddown_mod;     /**< Time shields are down. */
+   double jump_delay;         /**< Modulates the time that passes during a
+                                 hyperspace jump. */
+   double land_delay;         /**< Modulates the time that passes during
+                                 landing. */
+   double cargo_inertia;      /**< Lowers the effect of cargo mass. */
+   double ew_hide;            /**< Electronic warfare hide modifier. */
+   double ew_detected;        /**< Electronic warfare detected modifier. */
+   double ew_signature;       /**< Electronic warfare signature modifier. */
+   double ew_stealth;         /**< Electronic warfare stealth modifier. */
+   double ew_stealth_min;     /**< Electronic warfare minimum stealth
+                                 modifier. */
+   double ew_stealth_timer;   /**< Stealth timer decrease speed. */
+   double mass_mod;           /**< Relative mass modification. */
+   double weapon_energy;      /**< Weapon energy usage. */
+   double launch_energy;      /**< Energy usage of launchers. */
    double launch_lockon;      /**< Lock on speed of launchers. */
    double launch_calibration; /**< Calibration speed of launchers. */
-   double launch_reload;      /**< Reload rate of launchers. */
-   double launch_accel /**< Missile accel. */;
-   double launch_speed; /**< Missile speed. */
-   double launch_turn;  /**< Missile turn. */
-
-   /* Fighter bays. */
-   double fbay_damage;   /**< Fighter bay fighter damage (all weapons). */
-   double fbay_health;   /**< Fighter bay fighter health (armour and shield). */
-   double fbay_movement; /**< Fighter bay fighter movement (thrust, turn, and
-                            speed). */
-   double fbay_capacity; /**< Capacity of fighter bays. */
-   double fbay_rate;     /**< Launch rate of fighter bays. */
-   double fbay_reload;   /**< Reload rate of fighters. */
-
-   /* Fighter/Corvette type. */
-   double fwd_damage;     /**< Damage of forward mounts. */
-   double fwd_tracking;   /**< Tracking of forward mounts. */
-   double fwd_firerate;   /**< Rate of fire of forward mounts. */
-   double fwd_energy;     /**< Consumption rate of forward mounts. */
-   double fwd_dam_as_dis; /**< Damage as disable for forward mounts. */
-   double fwd_range;      /**< Range of forward mounts. */
-   double fwd_speed;      /**< Forward weapon speed. */
-
-   /* Destroyer/Cruiser type. */
-   double tur_damage;     /**< Damage of turrets. */
-   double tur_tracking;   /**< Tracking of turrets. */
-   double tur_firerate;   /**< Rate of fire of turrets. */
-   double tur_energy;     /**< Consumption rate of turrets. */
-   double tur_dam_as_dis; /**< Damage as disable for turrets. */
-   double tur_range;      /**< Range of forward mounts. */
-   double tur_speed;      /**< Turret weapon speed. */
-
-   /* Jamming. */
-   double jam_chance; /**< Jamming chance. */
-
-   /* Engine limits. */
-   double engine_limit_rel; /**< Engine limit modifier. */
-   double engine_limit;     /**< Engine limit. */
-
-   /* Misc. */
-   double nebu_absorb;         /**< Shield nebula resistance. */
-   double nebu_visibility;     /**< Nebula visibility. */
-   int    misc_instant_jump;   /**< Do not require brake or chargeup to jump. */
-   int    misc_reverse_thrust; /**< Slows down the ship instead of turning it
-                                  around. */
-   double asteroid_scan; /**< Distance at which asteroids can be scanned. */
-   double mining_bonus;  /**< Bonus when mining asteroids. */
-   double ship_price;    /**< Base price of the ship. */
-   int    misc_hidden_jump_detect; /**< Degree of hidden jump detection. */
-   int    fuel;                    /**< Maximum fuel modifier. */
-   double fuel_regen;              /**< Absolute fuel regeneration. */
-   int    cargo;                   /**< Maximum cargo modifier. */
-   int    crew;                    /**< Crew modifier. */
-   double loot_mod;                /**< Boarding loot reward bonus. */
-   double time_mod;                /**< Time dilation modifier. */
-   double action_speed;  /**< Makes the pilot operate at higher speeds. */
-   double cooldown_time; /**< Modifies cooldown time. */
-   double jump_distance; /**< Modifies how far the pilot can jump from the jump
-                            point. */
-   double jump_warmup;   /**< Modifies the time that is necessary to jump. */
-   int    invincible;    /**< Invincibility. */
+   double fwd_energy;         /**< Consumption rate of forward mounts. */
+   double tur_energy;         /**< Consumption rate of turrets. */
+   double time_mod;           /**< Time dilation modifier. */
+   double cooldown_time;      /**< Modifies cooldown time. */
+   double jump_warmup;        /**< Modifies the time that is necessary to
+                                 jump. */
+
+   /* Absolute doubles, including percentages. */
+   double speed;              /**< Speed modifier. */
+   double turn;               /**< Turn modifier. */
+   double accel;              /**< Accel modifier. */
+   double energy;             /**< Energy modifier. */
+   double energy_regen;       /**< Energy regeneration modifier. */
+   double energy_regen_malus; /**< Energy usage (flat). */
+   double shield;             /**< Shield modifier. */
+   double shield_regen;       /**< Shield regeneration modifier. */
+   double shield_regen_malus; /**< Shield usage (flat). */
+   double armour;             /**< Armour modifier. */
+   double armour_regen;       /**< Armour regeneration modifier. */
+   double armour_regen_malus; /**< Armour regeneration (flat). */
+   double damage;             /**< Damage over time. */
+   double disable;            /**< Disable over time. */
+   double cpu;                /**< CPU usage, does not get multiplied. */
+   double cpu_max;            /**< CPU modifier. */
+   double absorb;             /**< Flat damage absorption. */
+   double mass;               /**< Absolute mass. */
+   double jam_chance;         /**< Jamming chance. */
+   double engine_limit;       /**< Engine limit. */
+   double nebu_absorb;        /**< Shield nebula resistance. */
+   double nebu_visibility;    /**< Nebula visibility. */
+   double asteroid_scan;      /**< Distance at which asteroids can be
+                                 scanned. */
+   double fuel_regen;         /**< Absolute fuel regeneration. */
+
+   /* Integers. */
+   int fuel;  /**< Maximum fuel modifier. */
+   int cargo; /**< Maximum cargo modifier. */
+   int crew;  /**< Crew modifier. */
+
+   /* Booleans. */
+   int misc_instant_jump;       /**< Do not require brake or chargeup to
+                                   jump. */
+   int misc_reverse_thrust;     /**< Slows down the ship instead of turning it
+                                   around. */
+   int misc_hidden_jump_detect; /**< Degree of hidden jump detection. */
+   int invincible;              /**< Invincibility. */
 } ShipStats;
 
 /*
@@ -367,18 +359,26 @@ int ss_check( void );
 /*
  * Loading.
  */
-ShipStatList *ss_listFromXML( xmlNodePtr node );
-ShipStatList *ss_listFromXMLSingle( ShipStatList *head, xmlNodePtr node );
-int           ss_listToXML( xmlTextWriterPtr writer, const ShipStatList *ll );
-int           ss_sort( ShipStatList **ll );
-void          ss_free( ShipStatList *ll );
-ShipStatList *ss_dupList( const ShipStatList *ll );
+ShipStatList    *ss_listFromXML( xmlNodePtr node );
+ShipStatList    *ss_listFromXMLSingle( ShipStatList *head, xmlNodePtr node );
+int              ss_listToXML( xmlTextWriterPtr writer, const ShipStatList *ll );
+int              ss_sort( ShipStatList **ll );
+void             ss_free( ShipStatList *ll );
+ShipStatList    *ss_dupList( const ShipStatList *ll );
+ShipStatsPacked *ss_pack( const ShipStatList *ll );
+void             ss_packFree( ShipStatsPacked *pk );
 
 /*
  * Manipulation
  */
 int ss_statsInit( ShipStats *stats );
 int ss_statsMerge( ShipStats *dest, const ShipStats *src, int multiply );
+int ss_statsMergeGroups( ShipStats *dest, const ShipStats *src, int multiply,
+                         unsigned int groups );
+int ss_statsMergeFromPacked( ShipStats *stats, const ShipStatsPacked *pk,
+                             int multiply );
+unsigned int ss_listGroups( const ShipStatList *list );
+unsigned int ss_packGroups( const ShipStatsPacked *pk );
 int ss_statsMergeFromList( ShipStats *stats, const ShipStatList *list,
                            int multiply );
 int ss_statsMergeFromListScale( ShipStats *stats, const ShipStatList *list,
@@ -405,6 +405,7 @@ double        ss_statsGetRaw( const ShipStats *s, ShipStatsType type );
 int  ss_statsGetLua( lua_State *L, const ShipStats *s, const char *name,
                      int internal );
 int  ss_statsGetLuaTable( lua_State *L, const ShipStats *s, int internal );
+int  ss_statsSetLuaTable( lua_State *L, const ShipStats *s, int internal );
 int  ss_statsGetLuaTableList( lua_State *L, const ShipStatList *list,
                               int internal );
 void ss_exportLua( lua_State *L );
@@ -24,6 +24,7 @@
 #include "dev_uniedit.h"
 #include "economy.h"
 #include "gatherable.h"
+#include "gfxcache.h"
 #include "gui.h"
 #include "hook.h"
 #include "land.h"
@@ -121,7 +122,23 @@ static Spob *space_landQueueSpob      = NULL;
 /*
  * Fleet spawning.
  */
-int space_spawn = 1; /**< Spawn enabled by default. */
+int           space_spawn = 1; /**< Spawn enabled by default. */
+static double sched_elapsed =
+   0.; /**< Time elapsed since the scheduler last went over the presences. */
+static double sched_wait =
+   0.; /**< Time until the next faction spawn timer runs out. */
+
+/*
+ * Presence.
+ */
+static const SpobPresence **presence_dirty =
+   NULL; /**< Array (array.h): Spob presences changed since the last update. */
+static int presence_dirty_all =
+   1; /**< Whether all the presences have to be reconstructed. */
+static StarSystem **presence_spilled =
+   NULL; /**< Array (array.h): Systems spilled to by the current spread. */
+static StarSystem **presence_touched =
+   NULL; /**< Array (array.h): Systems whose presence has to be recomputed. */
 
 /*
  * Internal Prototypes.
@@ -146,6 +163,11 @@ static int             spob_cmp( const void *p1, const void *p2 );
 static void            system_scheduler( double dt, int init );
 static SystemPresence *system_getFactionPresenceGrow( StarSystem *sys,
                                                       FactionRef  faction );
+static void system_presenceApply( StarSystem *sys, const SpobPresence *ap,
+                                  double factor );
+static void system_presenceSpread( StarSystem *sys, const SpobPresence *ap,
+                                   int apply );
+static void system_presenceRecompute( StarSystem *sys );
 /* Markers. */
 static int space_addMarkerSystem( int sysid, MissionMarkerType type );
 static int space_addMarkerSpob( int pntid, MissionMarkerType type );
@@ -388,6 +410,7 @@ void system_updateAsteroids( StarSystem *sys )
 int spob_setFaction( Spob *p, FactionRef faction )
 {
    p->presence.faction = faction;
+   space_presenceDirty( &p->presence );
    return 0;
 }
 
@@ -1285,33 +1308,76 @@ const char *jump_getSymbol( const JumpPoint *jp )
    return "";
 }
 
+/**
+ * @brief Checks to see if a presence of the current system is being scheduled.
+ */
+static const nlua_env *system_schedulerEnv( const SystemPresence *p )
+{
+   if ( p->value <= 0. )
+      return NULL;
+
+   /* Spawning is disabled for this faction. */
+   if ( p->disabled )
+      return NULL;
+
+   /* Must have a valid scheduler, NULL otherwise. */
+   return faction_getScheduler( p->faction );
+}
+
+/**
+ * @brief Applies the time the scheduler has been waiting to the presence
+ * timers.
+ *
+ * Has to be called before modifying the timers, values, or spawn state of the
+ * presences of the current system. The scheduler will go over all the
+ * presences on the next update.
+ */
+void space_schedulerFlush( void )
+{
+   if ( ( cur_system != NULL ) && ( sched_elapsed > 0. ) ) {
+      for ( int i = 0; i < array_size( cur_system->presence ); i++ ) {
+         SystemPresence *p = &cur_system->presence[i];
+         if ( system_schedulerEnv( p ) != NULL )
+            p->timer -= sched_elapsed;
+      }
+   }
+   sched_elapsed = 0.;
+   sched_wait    = 0.;
+}
+
 /**
  * @brief Controls fleet spawning.
  *
+ * Instead of decrementing all the faction timers each frame, the time until
+ * the first one runs out is tracked, and all the factions are processed at
+ * once when it does.
+ *
  *    @param dt Current delta tick.
  *    @param init Should be 1 to initialize the scheduler.
  */
 static void system_scheduler( double dt, int init )
 {
+   if ( init )
+      space_schedulerFlush();
+   else {
+      /* Nothing to do until a timer runs out. */
+      sched_elapsed += dt;
+      if ( sched_elapsed <= sched_wait )
+         return;
+      dt            = sched_elapsed;
+      sched_elapsed = 0.;
+   }
+
    NTracingZone( _ctx, 1 );
 
    /* Go through all the factions and reduce the timer. */
    for ( int i = 0; i < array_size( cur_system->presence ); i++ ) {
       int             n;
-      SystemPresence *p = &cur_system->presence[i];
-      if ( p->value <= 0. )
-         continue;
-
-      const nlua_env *env = faction_getScheduler( p->faction );
-
-      /* Must have a valid scheduler. */
+      SystemPresence *p   = &cur_system->presence[i];
+      const nlua_env *env = system_schedulerEnv( p );
       if ( env == NULL )
          continue;
 
-      /* Spawning is disabled for this faction. */
-      if ( p->disabled )
-         continue;
-
       /* Run the appropriate function. */
       if ( init ) {
          nlua_getenv( naevL, env, "create" ); /* f */
@@ -1416,6 +1482,15 @@ static void system_scheduler( double dt, int init )
       lua_pop( naevL, 2 );
    }
 
+   /* Figure out when the next timer runs out. Spawn scripts can create pilots
+    * that change the presences, so it has to be done afterwards. */
+   sched_wait = HUGE_VAL;
+   for ( int i = 0; i < array_size( cur_system->presence ); i++ ) {
+      const SystemPresence *p = &cur_system->presence[i];
+      if ( system_schedulerEnv( p ) != NULL )
+         sched_wait = MIN( sched_wait, p->timer );
+   }
+
    NTracingZoneEnd( _ctx );
 }
 
@@ -1425,6 +1500,7 @@ static void system_scheduler( double dt, int init )
 void space_factionChange( void )
 {
    space_fchg = 1;
+   map_invalidate(); /* Map colours depend on standing. */
 }
 
 /**
@@ -1672,9 +1748,12 @@ void space_init( const char *sysname, int do_simulate )
       cur_system->presence[i].timer    = 0.;
       cur_system->presence[i].disabled = 0;
    }
+   sched_elapsed = 0.;
+   sched_wait    = 0.;
 
-   /* Load graphics. */
+   /* Load graphics, including the ships we expect to spawn. */
    space_gfxLoad( cur_system );
+   gfxcache_preload( cur_system );
 
    /* Call the scheduler. */
    system_scheduler( 0., 1 );
@@ -1744,6 +1823,9 @@ void space_init( const char *sysname, int do_simulate )
    space_simulating         = 0;
    NTracingZoneEnd( _ctx_simulating );
 
+   /* Free graphics that are no longer needed if over budget. */
+   gfxcache_evict();
+
    /* Refresh overlay if necessary (player kept it open). */
    ovr_refresh();
 
@@ -2682,6 +2764,7 @@ int system_addSpob( StarSystem *sys, const char *spobname )
       return -1;
    array_push_back( &sys->spobs, spob );
    array_push_back( &sys->spobsid, spob->id );
+   space_presenceDirty( &spob->presence );
 
    /* add spob <-> star system to name stack */
    array_push_back( &spobname_stack, spob->name );
@@ -2705,7 +2788,7 @@ int system_addSpob( StarSystem *sys, const char *spobname )
 /**
  * @brief Removes a spob from a star system.
  *
- * Remember to call space_reconstructPresences() after using this function.
+ * Remember to call space_updatePresences() after using this function.
  *
  *    @param sys Star System to remove spob from.
  *    @param spobname Name of the spob to remove.
@@ -2737,6 +2820,7 @@ int system_rmSpob( StarSystem *sys, const char *spobname )
    /* Remove spob from system. */
    array_erase( &sys->spobs, &sys->spobs[i], &sys->spobs[i + 1] );
    array_erase( &sys->spobsid, &sys->spobsid[i], &sys->spobsid[i + 1] );
+   space_presenceDirty( &spob->presence );
 
    /* Remove from the name stack thingy. */
    found = 0;
@@ -2778,6 +2862,8 @@ int system_addVirtualSpob( StarSystem *sys, const char *spobname )
    if ( va == NULL )
       return -1;
    array_push_back( &sys->spobs_virtual, va );
+   for ( int i = 0; i < array_size( va->presences ); i++ )
+      space_presenceDirty( &va->presences[i] );
 
    /* Economy is affected by presence. */
    economy_addQueuedUpdate();
@@ -2814,6 +2900,8 @@ int system_rmVirtualSpob( StarSystem *sys, const char *spobname )
    }
 
    /* Remove virtual spob. */
+   for ( int j = 0; j < array_size( sys->spobs_virtual[i]->presences ); j++ )
+      space_presenceDirty( &sys->spobs_virtual[i]->presences[j] );
    array_erase( &sys->spobs_virtual, &sys->spobs_virtual[i],
                 &sys->spobs_virtual[i + 1] );
 
@@ -2858,6 +2946,9 @@ int system_addJump( StarSystem *sys, StarSystem *target )
    j->hide     = HIDE_DEFAULT_JUMP;
    jp_setFlag( j, JP_AUTOPOS );
 
+   /* Changes how presence spills. */
+   space_presenceDirty( NULL );
+
    return 0;
 }
 
@@ -2888,6 +2979,9 @@ int system_rmJump( StarSystem *sys, StarSystem *target )
 
    /* Remove the jump. */
    array_erase( &sys->jumps, &sys->jumps[i], &sys->jumps[i + 1] );
+
+   /* Changes how presence spills. */
+   space_presenceDirty( NULL );
    return 0;
 }
 
@@ -2905,6 +2999,7 @@ static void system_init( StarSystem *sys )
    sys->astexclude    = array_create( AsteroidExclusion );
    sys->faction       = FACTION_NULL;
    sys->presence      = array_create( SystemPresence );
+   sys->presence_src  = array_create( SystemPresenceSource );
 }
 
 /**
@@ -3004,6 +3099,7 @@ void systems_reconstructJumps( void )
       for ( int j = 0; j < array_size( sys->jumps ); j++ )
          sys->jumps[j].targetid = sys->jumps[j].target->id;
    }
+   map_invalidate();
 
    NTracingZoneEnd( _ctx );
 }
@@ -3856,6 +3952,15 @@ void space_exit( void )
    array_free( spobname_stack );
    array_free( systemname_stack );
 
+   /* Free the presence bookkeeping. */
+   array_free( presence_dirty );
+   presence_dirty = NULL;
+   array_free( presence_spilled );
+   presence_spilled = NULL;
+   array_free( presence_touched );
+   presence_touched   = NULL;
+   presence_dirty_all = 1;
+
    /* Free the spobs. */
    for ( int i = 0; i < array_size( spob_stack ); i++ ) {
       Spob *spb = &spob_stack[i];
@@ -3922,6 +4027,7 @@ void space_exit( void )
       free( sys->note );
       array_free( sys->jumps );
       array_free( sys->presence );
+      array_free( sys->presence_src );
       array_free( sys->spobs );
       array_free( sys->spobsid );
       array_free( sys->spobs_virtual );
@@ -4367,61 +4473,101 @@ static int space_parseSaveNodes( xmlNodePtr parent, StarSystem *sys )
 }
 
 /**
- * @brief Adds (or removes) some presence to a system.
- *
- *    @param sys Pointer to the system to add to or remove from.
- *    @param ap Spob presence to add.
+ * @brief Checks to see if a spob presence adds any presence at all.
  */
-void system_presenceAddSpob( StarSystem *sys, const SpobPresence *ap )
+static int system_presenceValid( const SpobPresence *ap )
 {
-   int                     curSpill;
-   Queue                   q, qn;
-   double                  spillfactor;
-   FactionRef              faction   = ap->faction;
-   double                  base      = ap->base;
-   double                  bonus     = ap->bonus;
-   double                  range     = ap->range;
-   int                     usehidden = faction_usesHiddenJumps( faction );
-   const FactionGenerator *fgens;
-
-   /* Check for NULL and display a warning. */
-   if ( sys == NULL ) {
-      WARN( "sys == NULL" );
-      return;
-   }
-
    /* Check that we have a valid faction. */
-   if ( faction_isFaction( faction ) == 0 )
-      return;
+   if ( faction_isFaction( ap->faction ) == 0 )
+      return 0;
 
    /* Check that we're actually adding any. */
-   if ( ( base == 0. ) && ( bonus == 0. ) )
-      return;
+   if ( ( ap->base == 0. ) && ( ap->bonus == 0. ) )
+      return 0;
 
-   /* Get secondary if applicable. */
-   fgens = faction_generators( faction );
+   return 1;
+}
 
-   /* Add the presence to the current system. */
-   SystemPresence *sp = system_getFactionPresenceGrow( sys, faction );
+/**
+ * @brief Applies a spob presence to a system.
+ *
+ *    @param sys System to apply presence to.
+ *    @param ap Spob presence to apply.
+ *    @param factor Spill factor of the presence.
+ */
+static void system_presenceApply( StarSystem *sys, const SpobPresence *ap,
+                                  double factor )
+{
+   const FactionGenerator *fgens = faction_generators( ap->faction );
+   double                  base  = ap->base * factor;
+   double                  bonus = ap->bonus * factor;
+
+   SystemPresence *sp = system_getFactionPresenceGrow( sys, ap->faction );
    sp->base           = MAX( sp->base, base );
    sp->bonus += bonus;
    sp->value = sp->base + sp->bonus;
+
+   /* Secondary factions. */
    for ( int i = 0; i < array_size( fgens ); i++ ) {
       SystemPresence *spf = system_getFactionPresenceGrow( sys, fgens[i].id );
       spf->base           = MAX( spf->base, MAX( 0., base * fgens[i].weight ) );
       spf->bonus += MAX( 0., bonus * fgens[i].weight );
       spf->value = spf->base + spf->bonus;
    }
+}
+
+/**
+ * @brief Adds a system reached by a spob presence.
+ */
+static void system_presenceReach( StarSystem *sys, const SpobPresence *ap,
+                                  double factor, int apply )
+{
+   SystemPresenceSource *src = &array_grow( &sys->presence_src );
+   src->ap                   = ap;
+   src->factor               = factor;
+   if ( apply )
+      system_presenceApply( sys, ap, factor );
+   else if ( !sys->presence_dirty ) {
+      sys->presence_dirty = 1;
+      array_push_back( &presence_touched, sys );
+   }
+}
+
+/**
+ * @brief Spreads a spob presence to a system and the systems it spills to.
+ *
+ * Each system reached keeps track of the presence in its sources, so that it
+ * can be recomputed when a spob presence changes without having to go over
+ * the entire universe.
+ *
+ *    @param sys System the spob presence is in.
+ *    @param ap Spob presence to spread.
+ *    @param apply Whether to apply the presence or mark the systems as needing
+ * to be recomputed.
+ */
+static void system_presenceSpread( StarSystem *sys, const SpobPresence *ap,
+                                   int apply )
+{
+   int   curSpill;
+   Queue q, qn;
+   int   range     = ap->range;
+   int   usehidden = faction_usesHiddenJumps( ap->faction );
+
+   /* Add the presence to the current system. */
+   system_presenceReach( sys, ap, 1., apply );
 
    /* If there's no range, we're done here. */
    if ( range < 1 )
       return;
 
    /* Add the spill. */
+   if ( presence_spilled == NULL )
+      presence_spilled = array_create( StarSystem * );
    sys->spilled = 1;
-   curSpill     = 0;
-   q            = q_create();
-   qn           = q_create();
+   array_push_back( &presence_spilled, sys );
+   curSpill = 0;
+   q        = q_create();
+   qn       = q_create();
 
    /* Create the initial queue consisting of sys adjacencies. */
    for ( int i = 0; i < array_size( sys->jumps ); i++ ) {
@@ -4430,23 +4576,16 @@ void system_presenceAddSpob( StarSystem *sys, const SpobPresence *ap )
            !jp_isFlag( &sys->jumps[i], JP_EXITONLY ) ) {
          q_enqueue( q, sys->jumps[i].target );
          sys->jumps[i].target->spilled = 1;
+         array_push_back( &presence_spilled, sys->jumps[i].target );
       }
    }
 
-   /* If it's empty, something's wrong. */
-   if ( q_isEmpty( q ) ) {
-      /* Means system isn't connected. */
-      /*WARN(_("q is empty after getting adjacencies of %s."), sys->name);*/
-      q_destroy( q );
-      q_destroy( qn );
-      goto sys_cleanup;
-   }
-
    while ( curSpill < range ) {
       /* Pull one off the current range queue. */
       StarSystem *cur = q_dequeue( q );
 
-      /* Ran out of candidates before running out of spill range! */
+      /* Ran out of candidates before running out of spill range! This also
+       * happens if the system isn't connected. */
       if ( cur == NULL )
          break;
 
@@ -4457,24 +4596,12 @@ void system_presenceAddSpob( StarSystem *sys, const SpobPresence *ap )
               !jp_isFlag( &cur->jumps[i], JP_EXITONLY ) ) {
             q_enqueue( qn, cur->jumps[i].target );
             cur->jumps[i].target->spilled = 1;
+            array_push_back( &presence_spilled, cur->jumps[i].target );
          }
       }
 
       /* Spill some presence. */
-      sp          = system_getFactionPresenceGrow( cur, faction );
-      spillfactor = 1. / ( 2. + (double)curSpill );
-      sp->base    = MAX( sp->base, base * spillfactor );
-      sp->bonus += bonus * spillfactor;
-      sp->value = sp->base + sp->bonus;
-
-      for ( int i = 0; i < array_size( fgens ); i++ ) {
-         SystemPresence *spf =
-            system_getFactionPresenceGrow( cur, fgens[i].id );
-         spf->base =
-            MAX( spf->base, MAX( 0., base * spillfactor * fgens[i].weight ) );
-         spf->bonus += MAX( 0., bonus * spillfactor * fgens[i].weight );
-         spf->value = spf->base + spf->bonus;
-      }
+      system_presenceReach( cur, ap, 1. / ( 2. + (double)curSpill ), apply );
 
       /* Check to see if we've finished this range and grab the next queue. */
       if ( q_isEmpty( q ) ) {
@@ -4489,11 +4616,30 @@ void system_presenceAddSpob( StarSystem *sys, const SpobPresence *ap )
    q_destroy( q );
    q_destroy( qn );
 
-sys_cleanup:
-   /* Clean up our mess. */
-   for ( int i = 0; i < array_size( systems_stack ); i++ )
-      systems_stack[i].spilled = 0;
-   return;
+   /* Clean up our mess, only the systems we went through. */
+   for ( int i = 0; i < array_size( presence_spilled ); i++ )
+      presence_spilled[i]->spilled = 0;
+   array_resize( &presence_spilled, 0 );
+}
+
+/**
+ * @brief Adds (or removes) some presence to a system.
+ *
+ *    @param sys Pointer to the system to add to or remove from.
+ *    @param ap Spob presence to add.
+ */
+void system_presenceAddSpob( StarSystem *sys, const SpobPresence *ap )
+{
+   /* Check for NULL and display a warning. */
+   if ( sys == NULL ) {
+      WARN( "sys == NULL" );
+      return;
+   }
+
+   if ( !system_presenceValid( ap ) )
+      return;
+
+   system_presenceSpread( sys, ap, 1 );
 }
 
 static SystemPresence *system_getFactionPresenceGrow( StarSystem *sys,
@@ -4655,6 +4801,11 @@ void system_addAllSpobsPresence( StarSystem *sys )
  */
 void space_reconstructPresences( void )
 {
+   NTracingZone( _ctx, 1 );
+
+   /* Values are going to change. */
+   space_schedulerFlush();
+
    /* Reset the presence in each system. */
    for ( int i = 0; i < array_size( systems_stack ); i++ ) {
       StarSystem *sys = &systems_stack[i];
@@ -4666,6 +4817,8 @@ void space_reconstructPresences( void )
          sp->bonus          = 0.;
          sp->value          = 0.;
       }
+      array_resize( &sys->presence_src, 0 );
+      sys->presence_dirty            = 0;
       systems_stack[i].ownerpresence = 0.;
    }
 
@@ -4680,11 +4833,155 @@ void space_reconstructPresences( void )
          system_getPresence( &systems_stack[i], systems_stack[i].faction );
    }
 
+   /* Everything is up to date now. */
+   array_resize( &presence_dirty, 0 );
+   array_resize( &presence_touched, 0 );
+   presence_dirty_all = 0;
+
    /* Have to redo the scheduler because everything changed. */
    /* TODO this actually ignores existing presence and will temporarily increase
     * system presence more than normal... */
    if ( cur_system != NULL )
       system_scheduler( 0., 1 );
+
+   /* Dominant factions may have changed. */
+   map_invalidate();
+
+   NTracingZoneEnd( _ctx );
+}
+
+/**
+ * @brief Marks a spob presence as changed.
+ *
+ * Has to be called when the values, faction, or range of a spob presence
+ * change, or when it's added or removed from a system. The presences will be
+ * updated on the next call to space_updatePresences().
+ *
+ *    @param ap Spob presence that changed, or NULL if everything has to be
+ * recomputed, such as when the jumps change.
+ */
+void space_presenceDirty( const SpobPresence *ap )
+{
+   if ( presence_dirty_all )
+      return;
+   if ( ap == NULL ) {
+      presence_dirty_all = 1;
+      return;
+   }
+   if ( presence_dirty == NULL )
+      presence_dirty = array_create( const SpobPresence * );
+   for ( int i = 0; i < array_size( presence_dirty ); i++ )
+      if ( presence_dirty[i] == ap )
+         return;
+   array_push_back( &presence_dirty, ap );
+}
+
+/**
+ * @brief Checks to see if a spob presence is marked as changed.
+ */
+static int space_presenceIsDirty( const SpobPresence *ap )
+{
+   for ( int i = 0; i < array_size( presence_dirty ); i++ )
+      if ( presence_dirty[i] == ap )
+         return 1;
+   return 0;
+}
+
+/**
+ * @brief Recomputes the presence of a system from the spob presences that
+ * reach it.
+ */
+static void system_presenceRecompute( StarSystem *sys )
+{
+   for ( int j = 0; j < array_size( sys->presence ); j++ ) {
+      SystemPresence *sp = &sys->presence[j];
+      sp->base           = 0.;
+      sp->bonus          = 0.;
+      sp->value          = 0.;
+   }
+   for ( int j = 0; j < array_size( sys->presence_src ); j++ )
+      system_presenceApply( sys, sys->presence_src[j].ap,
+                            sys->presence_src[j].factor );
+   system_setFaction( sys );
+   sys->ownerpresence = system_getPresence( sys, sys->faction );
+   sys->presence_dirty = 0;
+}
+
+/**
+ * @brief Updates the presences that changed since the last update.
+ *
+ * Only the systems reached by the changed spob presences, before or after the
+ * change, are recomputed. Falls back to space_reconstructPresences() if
+ * everything has to be recomputed.
+ */
+void space_updatePresences( void )
+{
+   int cur_changed = 0;
+
+   if ( presence_dirty_all ) {
+      space_reconstructPresences();
+      return;
+   }
+   if ( array_size( presence_dirty ) == 0 )
+      return;
+
+   NTracingZone( _ctx, 1 );
+   space_schedulerFlush();
+   if ( presence_touched == NULL )
+      presence_touched = array_create( StarSystem * );
+
+   /* Remove the old contributions. */
+   for ( int i = 0; i < array_size( systems_stack ); i++ ) {
+      StarSystem *sys = &systems_stack[i];
+      int         n   = 0;
+      for ( int j = 0; j < array_size( sys->presence_src ); j++ )
+         if ( !space_presenceIsDirty( sys->presence_src[j].ap ) )
+            sys->presence_src[n++] = sys->presence_src[j];
+      if ( n == array_size( sys->presence_src ) )
+         continue;
+      array_resize( &sys->presence_src, n );
+      if ( !sys->presence_dirty ) {
+         sys->presence_dirty = 1;
+         array_push_back( &presence_touched, sys );
+      }
+   }
+
+   /* Spread the new ones, wherever they are now. */
+   for ( int i = 0; i < array_size( systems_stack ); i++ ) {
+      StarSystem *sys = &systems_stack[i];
+      for ( int j = 0; j < array_size( sys->spobs ); j++ ) {
+         const SpobPresence *ap = &sys->spobs[j]->presence;
+         if ( space_presenceIsDirty( ap ) && system_presenceValid( ap ) )
+            system_presenceSpread( sys, ap, 0 );
+      }
+      for ( int j = 0; j < array_size( sys->spobs_virtual ); j++ ) {
+         const VirtualSpob *va = sys->spobs_virtual[j];
+         for ( int k = 0; k < array_size( va->presences ); k++ ) {
+            const SpobPresence *ap = &va->presences[k];
+            if ( space_presenceIsDirty( ap ) && system_presenceValid( ap ) )
+               system_presenceSpread( sys, ap, 0 );
+         }
+      }
+   }
+
+   /* Recompute the affected systems. */
+   for ( int i = 0; i < array_size( presence_touched ); i++ ) {
+      system_presenceRecompute( presence_touched[i] );
+      if ( presence_touched[i] == cur_system )
+         cur_changed = 1;
+   }
+   NTracingPlotI( "presence_touched", array_size( presence_touched ) );
+   array_resize( &presence_touched, 0 );
+   array_resize( &presence_dirty, 0 );
+
+   /* Only have to redo the scheduler if the current system changed. */
+   if ( cur_changed )
+      system_scheduler( 0., 1 );
+
+   /* Dominant factions may have changed. */
+   map_invalidate();
+
+   NTracingZoneEnd( _ctx );
 }
 
 /**
@@ -4733,6 +5030,9 @@ void system_rmCurrentPresence( StarSystem *sys, FactionRef faction,
       lua_pop( naevL, 1 );
       return;
    }
+   /* Timer has to be up to date. */
+   if ( sys == cur_system )
+      space_schedulerFlush();
    lua_pushnumber( naevL, presence->curUsed ); /* f, cur */
    lua_pushnumber( naevL, presence->value );   /* f, cur, max */
    lua_pushnumber( naevL, presence->timer );   /* f, cur, max, timer */
@@ -247,6 +247,14 @@ typedef struct SystemPresence_ {
    double local; /**< Local standing for the system. */
 } SystemPresence;
 
+/**
+ * @brief Spob presence that reaches a system, either directly or by spilling.
+ */
+typedef struct SystemPresenceSource_ {
+   const SpobPresence *ap;     /**< Spob presence being spread. */
+   double              factor; /**< Spill factor, 1 in the spob's own system. */
+} SystemPresenceSource;
+
 /*
  * Jump point flags.
  */
@@ -358,9 +366,13 @@ struct StarSystem_ {
    /* Presence. */
    SystemPresence *presence; /**< Array (array.h): Pointer to an array of
                                 presences in this system. */
-   int    spilled;           /**< If the system has been spilled to yet. */
-   double ownerpresence;     /**< Amount of presence the owning faction has in a
-                                system. */
+   SystemPresenceSource
+      *presence_src;     /**< Array (array.h): Spob presences reaching this
+                            system, used to recompute the presence. */
+   int    spilled;        /**< If the system has been spilled to yet. */
+   int    presence_dirty; /**< If the presence has to be recomputed. */
+   double ownerpresence;  /**< Amount of presence the owning faction has in a
+                             system. */
 
    /* Markers. */
    int markers_computer; /**< Number of mission computer markers. */
@@ -491,8 +503,11 @@ double system_getPresenceFull( const StarSystem *sys, FactionRef faction,
                                double *base, double *bonus );
 void   system_addAllSpobsPresence( StarSystem *sys );
 void   space_reconstructPresences( void );
+void   space_presenceDirty( const SpobPresence *ap );
+void   space_updatePresences( void );
 void   system_rmCurrentPresence( StarSystem *sys, FactionRef faction,
                                  double amount );
+void   space_schedulerFlush( void );
 
 /*
  * update.
@@ -9,6 +9,7 @@
 /** @cond */
 #include <SDL3/SDL_haptic.h>
 #include <SDL3/SDL_timer.h>
+#include <stddef.h>
 /** @endcond */
 
 #include "spfx.h"
@@ -30,6 +31,7 @@
 #include "render.h"
 #include "rng.h"
 #include "sound.h"
+#include "threadpool.h"
 #include "vec2.h"
 
 #define SPFX_XML_ID "spfx" /**< SPFX XML node tag. */
@@ -48,8 +50,32 @@
 /* Trail stuff. */
 #define TRAIL_UPDATE_DT                                                        \
    0.05 /**< Rate (in seconds) at which trail is updated. */
+#define SPFX_TRAIL_GRAIN                                                       \
+   ( 64 ) /**< Trails updated per task, most only have a few points. */
 static TrailSpec   *trail_spec_stack = NULL; /**< Trail specifications. */
 static Trail_spfx **trail_spfx_stack = NULL; /**< Active trail effects. */
+static Trail_spfx **trail_spfx_pool =
+   NULL; /**< Dead trails kept with their buffers for reuse until the next
+            spfx_clear. */
+
+/**
+ * @brief A trail segment instance, as uploaded to the GPU.
+ */
+typedef struct TrailSegment_ {
+   GLfloat segment[4]; /**< Screen coordinates of the start and end. */
+   GLfloat thick;      /**< Thickness in screen coordinates. */
+   GLfloat depth[2];   /**< Depth at the start and end. */
+   GLfloat c1[4];      /**< Colour at the start. */
+   GLfloat c2[4];      /**< Colour at the end. */
+   GLfloat t[2];       /**< Normalized time at the start and end. */
+   GLfloat pos1[2];    /**< Length and thickness at the end. */
+   GLfloat pos2[2];    /**< Length and thickness at the start. */
+   GLfloat params[2];  /**< Unique value and timer of the trail. */
+} TrailSegment;
+static TrailSegment **trail_batch =
+   NULL; /**< Pending segments per trail specification. */
+static int     trail_batch_n = 0;    /**< Number of elements in trail_batch. */
+static gl_vbo *trail_vbo     = NULL; /**< Instance VBO for trail segments. */
 
 /*
  * Special hard-coded special effects
@@ -154,8 +180,16 @@ static int  spfx_hapticInit( void );
 static void spfx_hapticRumble( double mod );
 /* Trail. */
 static void spfx_update_trails( double dt );
+static void spfx_trail_updateRange( int start, int end, void *data );
 static void spfx_trail_update( Trail_spfx *trail, double dt );
+static void spfx_trail_updateSpan( TrailPoint *restrict p, size_t n,
+                                   GLfloat rel_dt, double amod, double abase );
+static void spfx_trail_batch( const Trail_spfx *trail );
+static void spfx_trail_attrib( GLint attrib, size_t offset, GLint size );
+static void spfx_trail_attribClear( GLint attrib );
+static void spfx_trail_flush( void );
 static void spfx_trail_free( Trail_spfx *trail );
+static void spfx_trail_recycle( Trail_spfx *trail );
 
 /**
  * @brief For sorting and stuff.
@@ -480,11 +514,22 @@ void spfx_free( void )
        * wrong and it is failing the assert on some systems. */
       // spfx_trail_free( trail_spfx_stack[i] );
       Trail_spfx *trail = trail_spfx_stack[i];
-      free( trail->point_ringbuf );
-      free( trail );
+      nfree( trail->point_ringbuf );
+      nfree( trail );
    }
    array_free( trail_spfx_stack );
    trail_spfx_stack = NULL;
+   for ( int i = 0; i < array_size( trail_spfx_pool ); i++ )
+      spfx_trail_free( trail_spfx_pool[i] );
+   array_free( trail_spfx_pool );
+   trail_spfx_pool = NULL;
+   for ( int i = 0; i < trail_batch_n; i++ )
+      array_free( trail_batch[i] );
+   free( trail_batch );
+   trail_batch   = NULL;
+   trail_batch_n = 0;
+   gl_vboDestroy( trail_vbo );
+   trail_vbo = NULL;
 
    /* Free the trail styles. */
    for ( int i = 0; i < array_size( trail_spec_stack ); i++ ) {
@@ -578,10 +623,16 @@ void spfx_clear( void )
       render_postprocessRm( damage_shader_pp_id );
    damage_shader_pp_id = 0;
 
+   /* The trail pool only lives as long as the system, so buffers grown by
+    * large battles don't stick around. */
    for ( int i = 0; i < array_size( trail_spfx_stack ); i++ )
       spfx_trail_free( trail_spfx_stack[i] );
    array_erase( &trail_spfx_stack, array_begin( trail_spfx_stack ),
                 array_end( trail_spfx_stack ) );
+   for ( int i = 0; i < array_size( trail_spfx_pool ); i++ )
+      spfx_trail_free( trail_spfx_pool[i] );
+   array_erase( &trail_spfx_pool, array_begin( trail_spfx_pool ),
+                array_end( trail_spfx_pool ) );
 
    /* Clear the Lua spfx. */
    spfxL_clear();
@@ -602,6 +653,7 @@ void spfx_update( const double dt, const double real_dt )
                              array_size( spfx_stack_middle ) +
                              array_size( spfx_stack_back ) );
    NTracingPlotI( "trails", array_size( trail_spfx_stack ) );
+   NTracingPlotI( "trails_pooled", array_size( trail_spfx_pool ) );
 
    spfx_update_layer( spfx_stack_front, dt );
    spfx_update_layer( spfx_stack_middle, dt );
@@ -632,21 +684,26 @@ void spfx_update( const double dt, const double real_dt )
  */
 static void spfx_update_layer( SPFX *layer, const double dt )
 {
+   int n = 0;
+   /* Dead effects are compacted away in a single pass, instead of shifting the
+    * layer once per effect. */
    for ( int i = 0; i < array_size( layer ); i++ ) {
-      layer[i].timer -= dt; /* less time to live */
+      SPFX *cur = &layer[i];
+      cur->timer -= dt; /* less time to live */
 
       /* time to die! */
-      if ( layer[i].timer < 0. ) {
-         array_erase( &layer, &layer[i], &layer[i + 1] );
-         i--;
+      if ( cur->timer < 0. )
          continue;
-      }
-      layer[i].time += dt; /* Shader timer. */
+      cur->time += dt; /* Shader timer. */
 
       /* actually update it */
-      vec2_cadd( &layer[i].pos, dt * VX( layer[i].vel ),
-                 dt * VY( layer[i].vel ) );
+      vec2_cadd( &cur->pos, dt * VX( cur->vel ), dt * VY( cur->vel ) );
+
+      if ( n != i )
+         layer[n] = *cur;
+      n++;
    }
+   array_resize( &layer, n );
 }
 
 /**
@@ -750,14 +807,24 @@ static void spfx_updateDamage( double dt )
  */
 Trail_spfx *spfx_trail_create( const TrailSpec *spec )
 {
-   Trail_spfx *trail = calloc( 1, sizeof( Trail_spfx ) );
-   trail->spec       = spec;
-   trail->capacity   = 1;
+   Trail_spfx *trail;
+
+   /* Reuse a dead trail and its buffer if possible, trails are created and
+    * destroyed with every projectile. */
+   if ( array_size( trail_spfx_pool ) > 0 ) {
+      trail = trail_spfx_pool[array_size( trail_spfx_pool ) - 1];
+      array_resize( &trail_spfx_pool, array_size( trail_spfx_pool ) - 1 );
+   } else {
+      trail                = ncalloc( 1, sizeof( Trail_spfx ) );
+      trail->capacity      = 1;
+      trail->point_ringbuf = ncalloc( trail->capacity, sizeof( TrailPoint ) );
+   }
+   trail->spec  = spec;
    trail->iread = trail->iwrite = 0;
-   trail->point_ringbuf = calloc( trail->capacity, sizeof( TrailPoint ) );
-   trail->refcount      = 1;
-   trail->r             = RNGF();
-   trail->ontop         = 0;
+   trail->refcount              = 1;
+   trail->dt                    = 0.;
+   trail->r                     = RNGF();
+   trail->ontop                 = 0;
 
    if ( trail_spfx_stack == NULL )
       trail_spfx_stack = array_create( Trail_spfx * );
@@ -773,17 +840,35 @@ Trail_spfx *spfx_trail_create( const TrailSpec *spec )
  */
 void spfx_update_trails( double dt )
 {
-   int n = array_size( trail_spfx_stack );
-   for ( int i = n - 1; i >= 0; i-- ) {
+   int n = 0;
+
+   /* Recycle the dead trails, compacting the stack in a single pass. */
+   for ( int i = 0; i < array_size( trail_spfx_stack ); i++ ) {
       Trail_spfx *trail = trail_spfx_stack[i];
-      if ( !trail->refcount && !trail_size( trail ) ) {
-         spfx_trail_free( trail );
-         array_erase( &trail_spfx_stack, &trail_spfx_stack[i],
-                      &trail_spfx_stack[i + 1] );
-      } else {
-         spfx_trail_update( trail, dt );
-      }
+      if ( !trail->refcount && !trail_size( trail ) )
+         spfx_trail_recycle( trail );
+      else
+         trail_spfx_stack[n++] = trail;
    }
+   if ( trail_spfx_stack != NULL )
+      array_resize( &trail_spfx_stack, n );
+
+   /* Trails only touch their own points, so they can be updated in parallel. */
+   parallel_for( 0, n, SPFX_TRAIL_GRAIN, spfx_trail_updateRange, &dt );
+}
+
+/**
+ * @brief Updates a range of the active trails.
+ *
+ *    @param start First trail to update.
+ *    @param end One past the last trail to update.
+ *    @param data Pointer to the update interval.
+ */
+static void spfx_trail_updateRange( int start, int end, void *data )
+{
+   double dt = *(const double *)data;
+   for ( int i = start; i < end; i++ )
+      spfx_trail_update( trail_spfx_stack[i], dt );
 }
 
 /**
@@ -794,31 +879,65 @@ void spfx_update_trails( double dt )
  */
 static void spfx_trail_update( Trail_spfx *trail, double dt )
 {
-   GLfloat rel_dt = dt / trail->spec->ttl;
+   const TrailSpec *spec   = trail->spec;
+   GLfloat          rel_dt = dt / spec->ttl;
+   size_t           n, start, first;
+
    /* Remove outdated elements. */
    while ( trail->iread < trail->iwrite &&
            trail_front( trail ).t < -TRAIL_UPDATE_DT )
       trail->iread++;
 
-   /* Update the other trail point's properties. */
-   for ( size_t i = trail->iread; i < trail->iwrite; i++ ) {
-      TrailPoint *trail_point = &trail_at( trail, i );
-      double      mod         = dt * trail_point->t * trail->spec->accel_mod;
-      trail_point->x += trail_point->dx * mod;
-      trail_point->y += trail_point->dy * mod;
-      if ( ( trail_point->mode != MODE_IDLE ) &&
-           ( trail->spec->accel_base > 0. ) ) {
-         mod = dt * trail_point->t / ( trail_point->dx + trail_point->dy );
-         trail_point->x += trail->spec->accel_base * mod * trail_point->dx;
-         trail_point->y += trail->spec->accel_base * mod * trail_point->dy;
-      }
-      trail_point->t -= rel_dt;
-   }
+   /* Update the other trail point's properties. The ring buffer is at most two
+    * contiguous spans, which keeps the loops simple enough to vectorize. */
+   n     = trail_size( trail );
+   start = trail->iread & ( trail->capacity - 1 );
+   first = MIN( n, trail->capacity - start );
+   spfx_trail_updateSpan( &trail->point_ringbuf[start], first, rel_dt,
+                          dt * spec->accel_mod, dt * spec->accel_base );
+   spfx_trail_updateSpan( trail->point_ringbuf, n - first, rel_dt,
+                          dt * spec->accel_mod, dt * spec->accel_base );
 
    /* Update timer. */
    trail->dt += dt;
 }
 
+/**
+ * @brief Updates a contiguous span of trail points.
+ *
+ *    @param p Points to update.
+ *    @param n Number of points.
+ *    @param rel_dt Update interval relative to the time to live.
+ *    @param amod Update interval times the acceleration modifier.
+ *    @param abase Update interval times the base acceleration.
+ */
+static void spfx_trail_updateSpan( TrailPoint *restrict p, size_t n,
+                                   GLfloat rel_dt, double amod, double abase )
+{
+   if ( abase > 0. ) {
+      for ( size_t i = 0; i < n; i++ ) {
+         double mod = p[i].t * amod;
+         double x   = p[i].x + p[i].dx * mod;
+         double y   = p[i].y + p[i].dy * mod;
+         if ( p[i].mode != MODE_IDLE ) {
+            mod = abase * p[i].t / ( p[i].dx + p[i].dy );
+            x += mod * p[i].dx;
+            y += mod * p[i].dy;
+         }
+         p[i].x = x;
+         p[i].y = y;
+         p[i].t -= rel_dt;
+      }
+   } else {
+      for ( size_t i = 0; i < n; i++ ) {
+         double mod = p[i].t * amod;
+         p[i].x += p[i].dx * mod;
+         p[i].y += p[i].dy * mod;
+         p[i].t -= rel_dt;
+      }
+   }
+}
+
 /**
  * @brief Makes a trail grow.
  *
@@ -860,7 +979,7 @@ void spfx_trail_sample( Trail_spfx *trail, double x, double y, double z,
    if ( trail_size( trail ) == trail->capacity ) {
       /* Full! Double capacity, and make the elements contiguous. (We've made
        * space to grow rightward.) */
-      trail->point_ringbuf = realloc(
+      trail->point_ringbuf = nrealloc(
          trail->point_ringbuf, 2 * trail->capacity * sizeof( TrailPoint ) );
       trail->iread %= trail->capacity;
       trail->iwrite = trail->iread + trail->capacity;
@@ -888,21 +1007,34 @@ void spfx_trail_remove( Trail_spfx *trail )
 static void spfx_trail_free( Trail_spfx *trail )
 {
    assert( trail->refcount == 0 );
-   free( trail->point_ringbuf );
-   free( trail );
+   nfree( trail->point_ringbuf );
+   nfree( trail );
 }
 
 /**
- * @brief Draws a trail on screen.
+ * @brief Puts an unreferenced, expired trail in the pool to be reused.
+ */
+static void spfx_trail_recycle( Trail_spfx *trail )
+{
+   assert( trail->refcount == 0 );
+   if ( trail_spfx_pool == NULL )
+      trail_spfx_pool = array_create( Trail_spfx * );
+   array_push_back( &trail_spfx_pool, trail );
+}
+
+/**
+ * @brief Adds the visible segments of a trail to the pending batch.
  *
- * Assumes depth testing is enabled.
+ * The segments are drawn by spfx_trail_flush().
  */
-void spfx_trail_draw( const Trail_spfx *trail )
+static void spfx_trail_batch( const Trail_spfx *trail )
 {
    const TrailSpec  *spec;
    const TrailStyle *styles;
+   TrailSegment    **batch;
    GLfloat           len;
    double            z;
+   int               idx;
 
    size_t n = trail_size( trail );
    if ( n == 0 )
@@ -910,20 +1042,25 @@ void spfx_trail_draw( const Trail_spfx *trail )
    spec   = trail->spec;
    styles = spec->style;
 
-   /* Stuff that doesn't change for the entire trail. */
-   glUseProgram( spec->shader.program );
-   glEnableVertexAttribArray( spec->shader.vertex );
-   gl_vboActivateAttribOffset( gl_squareVBO, spec->shader.vertex, 0, 2,
-                               GL_FLOAT, 0 );
-   glUniform1f( spec->shader.dt, trail->dt );
-   glUniform1f( spec->shader.r, trail->r );
+   /* Segments are grouped by specification, so they can share a draw. */
+   if ( trail_batch_n != array_size( trail_spec_stack ) ) {
+      for ( int i = 0; i < trail_batch_n; i++ )
+         array_free( trail_batch[i] );
+      trail_batch_n = array_size( trail_spec_stack );
+      free( trail_batch );
+      trail_batch = calloc( trail_batch_n, sizeof( TrailSegment * ) );
+   }
+   idx   = spec - trail_spec_stack;
+   batch = &trail_batch[idx];
+   if ( *batch == NULL )
+      *batch = array_create( TrailSegment );
 
    /* Start drawing from head to tail. */
    z   = cam_getZoom();
    len = 0.;
    for ( size_t i = trail->iread + 1; i < trail->iwrite; i++ ) {
-      mat4              projection;
       const TrailStyle *sp, *spp;
+      TrailSegment     *seg;
       double            x1, y1, x2, y2, s;
       TrailPoint       *tp  = &trail_at( trail, i );
       TrailPoint       *tpp = &trail_at( trail, i - 1 );
@@ -949,35 +1086,148 @@ void spfx_trail_draw( const Trail_spfx *trail )
       sp  = &styles[tp->mode];
       spp = &styles[tpp->mode];
 
-      /* Set vertex. */
-      projection = gl_view_matrix;
-      mat4_translate_xy( &projection, x1, y1 );
-      mat4_rotate2dv( &projection, ( x2 - x1 ) / s, ( y2 - y1 ) / s );
-      mat4_scale_xy( &projection, s, z * ( sp->thick + spp->thick ) );
-      mat4_translate_xy( &projection, 0., -0.5 );
-
-      /* Set uniforms. */
-      gl_uniformMat4( spec->shader.projection, &projection );
-      gl_uniformColour( spec->shader.c1, &sp->col );
-      gl_uniformColour( spec->shader.c2, &spp->col );
-      glUniform2f( spec->shader.t, tp->t, tpp->t );
-      glUniform2f( spec->shader.z, tp->z, tpp->z );
-      glUniform2f( spec->shader.pos2, len, sp->thick );
+      seg             = &array_grow( batch );
+      seg->segment[0] = x1;
+      seg->segment[1] = y1;
+      seg->segment[2] = x2;
+      seg->segment[3] = y2;
+      seg->thick      = z * ( sp->thick + spp->thick );
+      seg->depth[0]   = tp->z;
+      seg->depth[1]   = tpp->z;
+      memcpy( seg->c1, &sp->col, sizeof( seg->c1 ) );
+      memcpy( seg->c2, &spp->col, sizeof( seg->c2 ) );
+      seg->t[0]    = tp->t;
+      seg->t[1]    = tpp->t;
+      seg->pos2[0] = len;
+      seg->pos2[1] = sp->thick;
       len += s;
-      glUniform2f( spec->shader.pos1, len, spp->thick );
+      seg->pos1[0]   = len;
+      seg->pos1[1]   = spp->thick;
+      seg->params[0] = trail->r;
+      seg->params[1] = trail->dt;
+   }
+}
+
+/**
+ * @brief Sets up an instanced trail attribute.
+ */
+static void spfx_trail_attrib( GLint attrib, size_t offset, GLint size )
+{
+   if ( attrib < 0 )
+      return;
+   glEnableVertexAttribArray( attrib );
+   gl_vboActivateAttribOffset( trail_vbo, attrib, offset, size, GL_FLOAT,
+                               sizeof( TrailSegment ) );
+   glVertexAttribDivisor( attrib, 1 );
+}
+
+/**
+ * @brief Clears an instanced trail attribute.
+ */
+static void spfx_trail_attribClear( GLint attrib )
+{
+   if ( attrib < 0 )
+      return;
+   glVertexAttribDivisor( attrib, 0 );
+   glDisableVertexAttribArray( attrib );
+}
 
-      /* Draw. */
-      glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+/**
+ * @brief Draws all the pending trail segments.
+ *
+ * All the segments are uploaded at once, and each trail specification is drawn
+ * with a single instanced draw.
+ */
+static void spfx_trail_flush( void )
+{
+   size_t total = 0, offset = 0;
+
+   for ( int i = 0; i < trail_batch_n; i++ )
+      total += array_size( trail_batch[i] );
+   if ( total == 0 )
+      return;
+
+   /* Upload. */
+   if ( trail_vbo == NULL ) {
+      trail_vbo = gl_vboCreateStream( total * sizeof( TrailSegment ), NULL );
+      gl_vboLabel( trail_vbo, "Trail Segment VBO" );
+   } else
+      gl_vboData( trail_vbo, total * sizeof( TrailSegment ), NULL );
+   for ( int i = 0; i < trail_batch_n; i++ ) {
+      int n = array_size( trail_batch[i] );
+      if ( n == 0 )
+         continue;
+      gl_vboSubData( trail_vbo, offset * sizeof( TrailSegment ),
+                     n * sizeof( TrailSegment ), trail_batch[i] );
+      offset += n;
    }
 
-   /* Clear state. */
-   glDisableVertexAttribArray( spec->shader.vertex );
+   /* Draw. */
+   offset = 0;
+   for ( int i = 0; i < trail_batch_n; i++ ) {
+      const TrailSpec *spec = &trail_spec_stack[i];
+      int              n    = array_size( trail_batch[i] );
+      size_t           base = offset * sizeof( TrailSegment );
+      if ( n == 0 )
+         continue;
+
+      glUseProgram( spec->shader.program );
+      gl_uniformMat4( spec->shader.projection, &gl_view_matrix );
+      glEnableVertexAttribArray( spec->shader.vertex );
+      gl_vboActivateAttribOffset( gl_squareVBO, spec->shader.vertex, 0, 2,
+                                  GL_FLOAT, 0 );
+      spfx_trail_attrib( spec->shader.segment,
+                         base + offsetof( TrailSegment, segment ), 4 );
+      spfx_trail_attrib( spec->shader.thick,
+                         base + offsetof( TrailSegment, thick ), 1 );
+      spfx_trail_attrib( spec->shader.depth,
+                         base + offsetof( TrailSegment, depth ), 2 );
+      spfx_trail_attrib( spec->shader.c1, base + offsetof( TrailSegment, c1 ),
+                         4 );
+      spfx_trail_attrib( spec->shader.c2, base + offsetof( TrailSegment, c2 ),
+                         4 );
+      spfx_trail_attrib( spec->shader.t, base + offsetof( TrailSegment, t ),
+                         2 );
+      spfx_trail_attrib( spec->shader.pos1,
+                         base + offsetof( TrailSegment, pos1 ), 2 );
+      spfx_trail_attrib( spec->shader.pos2,
+                         base + offsetof( TrailSegment, pos2 ), 2 );
+      spfx_trail_attrib( spec->shader.params,
+                         base + offsetof( TrailSegment, params ), 2 );
+
+      glDrawArraysInstanced( GL_TRIANGLE_STRIP, 0, 4, n );
+
+      spfx_trail_attribClear( spec->shader.segment );
+      spfx_trail_attribClear( spec->shader.thick );
+      spfx_trail_attribClear( spec->shader.depth );
+      spfx_trail_attribClear( spec->shader.c1 );
+      spfx_trail_attribClear( spec->shader.c2 );
+      spfx_trail_attribClear( spec->shader.t );
+      spfx_trail_attribClear( spec->shader.pos1 );
+      spfx_trail_attribClear( spec->shader.pos2 );
+      spfx_trail_attribClear( spec->shader.params );
+      glDisableVertexAttribArray( spec->shader.vertex );
+
+      offset += n;
+      array_resize( &trail_batch[i], 0 );
+   }
    glUseProgram( 0 );
 
    /* Check errors. */
    gl_checkErr();
 }
 
+/**
+ * @brief Draws a trail on screen.
+ *
+ * Assumes depth testing is enabled.
+ */
+void spfx_trail_draw( const Trail_spfx *trail )
+{
+   spfx_trail_batch( trail );
+   spfx_trail_flush();
+}
+
 /**
  * @brief Increases the current rumble level.
  *
@@ -1222,12 +1472,14 @@ void spfx_render( int layer, double dt )
       spfxL_renderbg( dt );
 
       NTracingZoneName( _ctx_trails, "spfx_render[trails]", 1 );
-      /* Trails are special (for now?). */
+      /* Trails are special (for now?). They're all batched together, so they
+       * end up grouped by specification. */
       for ( int i = 0; i < array_size( trail_spfx_stack ); i++ ) {
          const Trail_spfx *trail = trail_spfx_stack[i];
          if ( !trail->ontop )
-            spfx_trail_draw( trail );
+            spfx_trail_batch( trail );
       }
+      spfx_trail_flush();
       NTracingZoneEnd( _ctx_trails );
       break;
 
@@ -1339,19 +1591,20 @@ static int trailSpec_parse( TrailSpec *tc, const char *file, int firstpass )
    if ( firstpass && ( tc->shader_path != NULL ) ) {
       tc->shader.program =
          gl_program_vert_frag( "trail.vert", tc->shader_path );
-      tc->shader.vertex = glGetAttribLocation( tc->shader.program, "vertex" );
       tc->shader.projection =
          glGetUniformLocation( tc->shader.program, "projection" );
-      tc->shader.r    = glGetUniformLocation( tc->shader.program, "r" );
-      tc->shader.dt   = glGetUniformLocation( tc->shader.program, "dt" );
-      tc->shader.c1   = glGetUniformLocation( tc->shader.program, "c1" );
-      tc->shader.c2   = glGetUniformLocation( tc->shader.program, "c2" );
-      tc->shader.t    = glGetUniformLocation( tc->shader.program, "t" );
-      tc->shader.z    = glGetUniformLocation( tc->shader.program, "z" );
-      tc->shader.pos1 = glGetUniformLocation( tc->shader.program, "pos1" );
-      tc->shader.pos2 = glGetUniformLocation( tc->shader.program, "pos2" );
       tc->shader.nebu_col =
          glGetUniformLocation( tc->shader.program, "nebu_col" );
+      tc->shader.vertex  = glGetAttribLocation( tc->shader.program, "vertex" );
+      tc->shader.segment = glGetAttribLocation( tc->shader.program, "segment" );
+      tc->shader.thick   = glGetAttribLocation( tc->shader.program, "thick" );
+      tc->shader.depth   = glGetAttribLocation( tc->shader.program, "depth" );
+      tc->shader.c1      = glGetAttribLocation( tc->shader.program, "colour1" );
+      tc->shader.c2      = glGetAttribLocation( tc->shader.program, "colour2" );
+      tc->shader.t       = glGetAttribLocation( tc->shader.program, "time" );
+      tc->shader.pos1 = glGetAttribLocation( tc->shader.program, "position1" );
+      tc->shader.pos2 = glGetAttribLocation( tc->shader.program, "position2" );
+      tc->shader.params = glGetAttribLocation( tc->shader.program, "params" );
       gl_checkErr();
    }
 
@@ -65,17 +65,19 @@ typedef struct TrailSpec_ {
    char *shader_path; /**< Shader path. */
    struct {
       GLuint program;
-      GLuint vertex;
       GLuint projection;
-      GLuint r;
-      GLuint dt;
-      GLuint c1;
-      GLuint c2;
-      GLuint t;
-      GLuint z;
-      GLuint pos1;
-      GLuint pos2;
       GLuint nebu_col;
+      /* Attributes, -1 if optimized out. */
+      GLint vertex;
+      GLint segment;
+      GLint thick;
+      GLint depth;
+      GLint c1;
+      GLint c2;
+      GLint t;
+      GLint pos1;
+      GLint pos2;
+      GLint params;
    } shader;
 } TrailSpec;
 
@@ -9,6 +9,7 @@
  */
 /** @cond */
 #include <SDL3/SDL_timer.h>
+#include <stdint.h>
 /** @endcond */
 
 #include "tech.h"
@@ -20,6 +21,7 @@
 #include "log.h"
 #include "naev.h"
 #include "ndata.h"
+#include "ntracing.h"
 #include "nxml.h"
 #include "outfit.h"
 #include "ship.h"
@@ -57,6 +59,32 @@ typedef struct tech_item_s {
    } u;                           /**< Data union. */
 } tech_item_t;
 
+/**
+ * @brief Outfit, ship or commodity reachable from a tech group.
+ */
+typedef struct tech_leaf_s {
+   const tech_item_t  *item;  /**< The actual item. */
+   const tech_item_t **conds; /**< Conditional items along the path, including
+                                 the item itself (array.h). NULL if always
+                                 available. */
+} tech_leaf_t;
+
+/**
+ * @brief Tech group flattened with all the nested groups resolved.
+ *
+ * Items that are always available are stored in bitsets indexed by the outfit
+ * and ship stack positions, while the rest have to check their conditions
+ * when queried.
+ */
+typedef struct tech_flat_s {
+   unsigned int gen;     /**< Tech generation it was compiled at. */
+   uint64_t    *outfits; /**< Always available outfits. */
+   uint64_t    *ships;   /**< Always available ships. */
+   tech_leaf_t *leaves;  /**< All the leaves in lookup order (array.h). */
+   int         *cond;    /**< Conditional outfit and ship leaves (array.h). */
+   int         *comms;   /**< Commodity leaves (array.h). */
+} tech_flat_t;
+
 /**
  * @brief Group of tech items, basic unit of the tech trees.
  */
@@ -64,12 +92,19 @@ struct tech_group_s {
    char        *name;     /**< Name of the tech group. */
    char        *filename; /**< Name of the file. */
    tech_item_t *items;    /**< Items in the tech group. */
+   tech_flat_t *flat;     /**< Compiled group, may be out of date. */
 };
 
 /*
  * Group list.
  */
 static tech_group_t *tech_groups = NULL;
+static unsigned int  tech_gen =
+   1; /**< Incremented whenever any group changes, invalidating the compiled
+         groups. */
+static tech_group_t   tech_meta; /**< Last meta group, kept compiled. */
+static tech_group_t **tech_meta_techs =
+   NULL; /**< Groups in the last meta group (array.h). */
 
 /*
  * Prototypes.
@@ -93,6 +128,11 @@ static int          tech_getID( const char *name );
 static int          tech_addItemGroupPointer( tech_group_t       *grp,
                                               const tech_group_t *ptr );
 static tech_item_t *tech_addItemGroup( tech_group_t *grp, const char *name );
+/* Flattening. */
+static const tech_flat_t  *tech_compile( const tech_group_t *tech );
+static void                tech_flatFree( tech_flat_t *flat );
+static const tech_group_t *tech_getMetaGroup( tech_group_t **tech, int num );
+static void                tech_freeMetaGroup( void );
 /* Getting by tech. */
 static void **tech_addGroupItem( void **items, tech_item_type_t type,
                                  const tech_group_t *tech, int search );
@@ -181,6 +221,8 @@ int tech_load( void )
  */
 void tech_free( void )
 {
+   tech_freeMetaGroup();
+
    /* Free all individual techs. */
    int s = array_size( tech_groups );
    for ( int i = 0; i < s; i++ )
@@ -198,6 +240,7 @@ static void tech_freeGroup( tech_group_t *grp )
    free( grp->name );
    free( grp->filename );
    array_free( grp->items );
+   tech_flatFree( grp->flat );
 }
 
 /**
@@ -228,6 +271,14 @@ void tech_groupDestroy( tech_group_t *grp )
    if ( grp == NULL )
       return;
 
+   /* The meta group points to it. */
+   for ( int i = 0; i < array_size( tech_meta_techs ); i++ ) {
+      if ( tech_meta_techs[i] == grp ) {
+         tech_freeMetaGroup();
+         break;
+      }
+   }
+
    tech_freeGroup( grp );
    free( grp );
 }
@@ -321,6 +372,7 @@ static int tech_parseXMLData( tech_group_t *tech, xmlNodePtr parent )
 {
    /* Parse the data. */
    xmlNodePtr node = parent->xmlChildrenNode;
+   tech_gen++;
    do {
       xml_onlyNodes( node );
       if ( xml_isNode( node, "item" ) ) {
@@ -506,6 +558,7 @@ int tech_addItem( const char *name, const char *value )
       return -1;
    }
 
+   tech_gen++;
    return 0;
 }
 
@@ -514,6 +567,7 @@ int tech_addItem( const char *name, const char *value )
  */
 int tech_addItemTech( tech_group_t *tech, const char *value )
 {
+   tech_gen++;
    return ( tech_addItemTechInternal( tech, value ) != NULL );
 }
 
@@ -546,6 +600,7 @@ int tech_rmItemTech( tech_group_t *tech, const char *value )
       const char *buf = tech_getItemName( &tech->items[i] );
       if ( strcmp( buf, value ) == 0 ) {
          array_erase( &tech->items, &tech->items[i], &tech->items[i + 1] );
+         tech_gen++;
          return 0;
       }
    }
@@ -579,6 +634,7 @@ int tech_rmItem( const char *name, const char *value )
       const char *buf = tech_getItemName( &tech->items[i] );
       if ( strcmp( buf, value ) == 0 ) {
          array_erase( &tech->items, &tech->items[i], &tech->items[i + 1] );
+         tech_gen++;
          return 0;
       }
    }
@@ -652,46 +708,272 @@ static void tech_createMetaGroup( tech_group_t *grp, tech_group_t **tech,
 }
 
 /**
- * @brief Recursive function for creating an array of commodities from a tech
- * group.
+ * @brief Gets a meta group of an array of tech groups.
+ *
+ * The last meta group is kept around so that it is only compiled again when
+ * the tech groups change, like single groups.
+ *
+ *    @param tech List of tech groups to attach.
+ *    @param num Number of tech groups.
+ *    @return The meta group, valid until the next call.
+ */
+static const tech_group_t *tech_getMetaGroup( tech_group_t **tech, int num )
+{
+   if ( ( tech_meta_techs != NULL ) &&
+        ( array_size( tech_meta_techs ) == num ) &&
+        ( memcmp( tech_meta_techs, tech, num * sizeof( tech_group_t * ) ) ==
+          0 ) )
+      return &tech_meta;
+
+   tech_freeMetaGroup();
+   tech_createMetaGroup( &tech_meta, tech, num );
+   tech_meta_techs = array_create_size( tech_group_t *, num );
+   for ( int i = 0; i < num; i++ )
+      array_push_back( &tech_meta_techs, tech[i] );
+   return &tech_meta;
+}
+
+/**
+ * @brief Frees the cached meta group.
+ */
+static void tech_freeMetaGroup( void )
+{
+   if ( tech_meta_techs == NULL )
+      return;
+   tech_freeGroup( &tech_meta );
+   memset( &tech_meta, 0, sizeof( tech_group_t ) );
+   array_free( tech_meta_techs );
+   tech_meta_techs = NULL;
+}
+
+/**
+ * @brief Gets the position of an outfit in the outfit stack.
+ */
+static int tech_outfitID( const Outfit *o )
+{
+   return o - outfit_getAll_rust();
+}
+
+/**
+ * @brief Gets the position of a ship in the ship stack.
+ */
+static int tech_shipID( const Ship *s )
+{
+   return s - ship_getAll();
+}
+
+static uint64_t *tech_bitsetCreate( int n )
+{
+   return calloc( ( n + 63 ) / 64, sizeof( uint64_t ) );
+}
+static int tech_bitsetHas( const uint64_t *bits, int i )
+{
+   return ( bits[i / 64] >> ( i % 64 ) ) & 1;
+}
+static void tech_bitsetSet( uint64_t *bits, int i )
+{
+   bits[i / 64] |= ( (uint64_t)1 ) << ( i % 64 );
+}
+
+/**
+ * @brief Frees a compiled tech group.
+ */
+static void tech_flatFree( tech_flat_t *flat )
+{
+   if ( flat == NULL )
+      return;
+   free( flat->outfits );
+   free( flat->ships );
+   for ( int i = 0; i < array_size( flat->leaves ); i++ )
+      array_free( flat->leaves[i].conds );
+   array_free( flat->leaves );
+   array_free( flat->cond );
+   array_free( flat->comms );
+   free( flat );
+}
+
+/**
+ * @brief Creates a copy of a condition list with an additional item.
+ *
+ *    @param conds Condition list to copy (array.h), can be NULL.
+ *    @param item Item to add, if NULL just copies the list.
+ *    @return New condition list (array.h).
+ */
+static const tech_item_t **tech_condAppend( const tech_item_t **conds,
+                                            const tech_item_t  *item )
+{
+   const tech_item_t **out = array_create( const tech_item_t * );
+   for ( int i = 0; i < array_size( conds ); i++ )
+      array_push_back( &out, conds[i] );
+   if ( item != NULL )
+      array_push_back( &out, item );
+   return out;
+}
+
+/**
+ * @brief Checks the conditions of a leaf, same as tech_testCond().
+ */
+static int tech_testLeaf( const tech_leaf_t *leaf, int search )
+{
+   for ( int i = 0; i < array_size( leaf->conds ); i++ )
+      if ( tech_testCond( leaf->conds[i], search ) )
+         return 1;
+   return 0;
+}
+
+/**
+ * @brief Recursively adds the leaves of a group to a compiled group.
+ *
+ * The order matches the old recursive lookup: first the items of the group,
+ * and then the items of the nested groups.
+ */
+static void tech_flattenGroup( tech_flat_t *flat, const tech_group_t *tech,
+                               const tech_item_t **conds )
+{
+   int size = array_size( tech->items );
+
+   for ( int i = 0; i < size; i++ ) {
+      const tech_item_t *item = &tech->items[i];
+      tech_leaf_t        leaf;
+      int                id = array_size( flat->leaves );
+
+      if ( ( item->type == TECH_TYPE_GROUP ) ||
+           ( item->type == TECH_TYPE_GROUP_POINTER ) )
+         continue;
+
+      leaf.item = item;
+      if ( item->avail != NULL )
+         leaf.conds = tech_condAppend( conds, item );
+      else if ( conds != NULL )
+         leaf.conds = tech_condAppend( conds, NULL );
+      else
+         leaf.conds = NULL;
+      array_push_back( &flat->leaves, leaf );
+
+      switch ( item->type ) {
+      case TECH_TYPE_OUTFIT:
+         if ( leaf.conds == NULL )
+            tech_bitsetSet( flat->outfits, tech_outfitID( item->u.outfit ) );
+         else
+            array_push_back( &flat->cond, id );
+         break;
+      case TECH_TYPE_SHIP:
+         if ( leaf.conds == NULL )
+            tech_bitsetSet( flat->ships, tech_shipID( item->u.ship ) );
+         else
+            array_push_back( &flat->cond, id );
+         break;
+      case TECH_TYPE_COMMODITY:
+         array_push_back( &flat->comms, id );
+         break;
+      default:
+         break;
+      }
+   }
+
+   for ( int i = 0; i < size; i++ ) {
+      const tech_item_t  *item = &tech->items[i];
+      const tech_group_t *grp;
+      const tech_item_t **subconds;
+
+      if ( item->type == TECH_TYPE_GROUP )
+         grp = &tech_groups[item->u.grp];
+      else if ( item->type == TECH_TYPE_GROUP_POINTER )
+         grp = item->u.grpptr;
+      else
+         continue;
+
+      /* Conditions on groups apply to everything in them. */
+      subconds =
+         ( item->avail != NULL ) ? tech_condAppend( conds, item ) : conds;
+      tech_flattenGroup( flat, grp, subconds );
+      if ( subconds != conds )
+         array_free( subconds );
+   }
+}
+
+/**
+ * @brief Gets the compiled version of a tech group, compiling it if necessary.
+ */
+static const tech_flat_t *tech_compile( const tech_group_t *tech )
+{
+   tech_flat_t *flat = tech->flat;
+   if ( ( flat != NULL ) && ( flat->gen == tech_gen ) )
+      return flat;
+
+   NTracingZone( _ctx, 1 );
+
+   tech_flatFree( flat );
+   flat          = calloc( 1, sizeof( tech_flat_t ) );
+   flat->gen     = tech_gen;
+   flat->outfits = tech_bitsetCreate( array_size( outfit_getAll_rust() ) );
+   flat->ships   = tech_bitsetCreate( array_size( ship_getAll() ) );
+   flat->leaves  = array_create( tech_leaf_t );
+   flat->cond    = array_create( int );
+   flat->comms   = array_create( int );
+   tech_flattenGroup( flat, tech, NULL );
+
+   /* The compiled group is just a cache. */
+   ( (tech_group_t *)tech )->flat = flat;
+
+   NTracingZoneEnd( _ctx );
+   return flat;
+}
+
+/**
+ * @brief Creates an array of items of a type from a tech group.
  */
 static void **tech_addGroupItemPrice( void **items, double **price,
                                       tech_item_type_t    type,
                                       const tech_group_t *tech, int search )
 {
-   /* Set up. */
-   int size = array_size( tech->items );
+   const tech_flat_t *flat = tech_compile( tech );
+   uint64_t          *seen = NULL;
 
-   /* Handle specified type. */
-   for ( int i = 0; i < size; i++ ) {
-      int          f;
-      tech_item_t *item = &tech->items[i];
+   if ( type == TECH_TYPE_OUTFIT )
+      seen = tech_bitsetCreate( array_size( outfit_getAll_rust() ) );
+   else if ( type == TECH_TYPE_SHIP )
+      seen = tech_bitsetCreate( array_size( ship_getAll() ) );
+
+   for ( int i = 0; i < array_size( flat->leaves ); i++ ) {
+      const tech_leaf_t *leaf = &flat->leaves[i];
+      const tech_item_t *item = leaf->item;
+      int                f;
 
       /* Only care about type. */
       if ( item->type != type )
          continue;
 
       /* Check conditional. */
-      if ( tech_testCond( item, search ) )
+      if ( tech_testLeaf( leaf, search ) )
          continue;
 
       /* Skip if already in list. */
-      f = 0;
-      /* Count backwards so the price of newly added stuff is more important. */
-      for ( int j = array_size( items ) - 1; j >= 0; j-- ) {
-         if ( items[j] == item->u.ptr ) {
-            f = 1;
-            /* Overwrite price if it's not 1. */
-            if ( price != NULL ) {
-               if ( fabs( item->price_mod - 1. ) > 1e-8 ) {
-                  ( *price )[j] = item->price_mod;
+      if ( seen != NULL ) {
+         int id = ( type == TECH_TYPE_OUTFIT ) ? tech_outfitID( item->u.outfit )
+                                               : tech_shipID( item->u.ship );
+         if ( tech_bitsetHas( seen, id ) )
+            continue;
+         tech_bitsetSet( seen, id );
+      } else {
+         f = 0;
+         /* Count backwards so the price of newly added stuff is more
+          * important. */
+         for ( int j = array_size( items ) - 1; j >= 0; j-- ) {
+            if ( items[j] == item->u.ptr ) {
+               f = 1;
+               /* Overwrite price if it's not 1. */
+               if ( price != NULL ) {
+                  if ( fabs( item->price_mod - 1. ) > 1e-8 ) {
+                     ( *price )[j] = item->price_mod;
+                  }
                }
+               break;
             }
-            break;
          }
+         if ( f == 1 )
+            continue;
       }
-      if ( f == 1 )
-         continue;
 
       /* Add. */
       if ( items == NULL )
@@ -701,19 +983,7 @@ static void **tech_addGroupItemPrice( void **items, double **price,
          array_push_back( price, item->price_mod );
    }
 
-   /* Now handle other groups. */
-   for ( int i = 0; i < size; i++ ) {
-      tech_item_t *item = &tech->items[i];
-
-      /* Only handle commodities for now. */
-      if ( item->type == TECH_TYPE_GROUP )
-         items = tech_addGroupItemPrice( items, price, type,
-                                         &tech_groups[item->u.grp], search );
-      else if ( item->type == TECH_TYPE_GROUP_POINTER )
-         items = tech_addGroupItemPrice( items, price, type, item->u.grpptr,
-                                         search );
-   }
-
+   free( seen );
    return items;
 }
 static void **tech_addGroupItem( void **items, tech_item_type_t type,
@@ -750,51 +1020,47 @@ static int tech_hasItemInternal( const tech_group_t *tech,
                                  const tech_item_t *item, int search,
                                  double *price )
 {
+   const tech_flat_t *flat;
+   const int         *leaves;
+
    if ( tech == NULL )
       return 0;
-   int s = array_size( tech->items );
-   for ( int i = 0; i < s; i++ ) {
-      const tech_item_t *itemi = &tech->items[i];
+   flat = tech_compile( tech );
 
-      if ( tech_testCond( itemi, search ) )
-         continue;
+   /* Always available outfits and ships are in the bitsets. */
+   switch ( item->type ) {
+   case TECH_TYPE_OUTFIT:
+      if ( tech_bitsetHas( flat->outfits, tech_outfitID( item->u.outfit ) ) )
+         return 1;
+      leaves = flat->cond;
+      break;
+   case TECH_TYPE_SHIP:
+      if ( tech_bitsetHas( flat->ships, tech_shipID( item->u.ship ) ) )
+         return 1;
+      leaves = flat->cond;
+      break;
+   case TECH_TYPE_COMMODITY:
+      leaves = flat->comms;
+      break;
+   default:
+      return 0;
+   }
 
-      if ( item->type == itemi->type ) {
-         switch ( item->type ) {
-         case TECH_TYPE_OUTFIT:
-            if ( item->u.outfit == itemi->u.outfit ) {
-               if ( price != NULL )
-                  *price = item->price_mod;
-               return 1;
-            }
-            break;
-         case TECH_TYPE_SHIP:
-            if ( item->u.ship == itemi->u.ship ) {
-               if ( price != NULL )
-                  *price = item->price_mod;
-               return 1;
-            }
-            break;
-         case TECH_TYPE_COMMODITY:
-            if ( item->u.comm == itemi->u.comm ) {
-               if ( price != NULL )
-                  *price = item->price_mod;
-               return 1;
-            }
-            break;
-         default:
-            break;
-         }
-      }
+   /* Have to check the rest. */
+   for ( int i = 0; i < array_size( leaves ); i++ ) {
+      const tech_leaf_t *leaf  = &flat->leaves[leaves[i]];
+      const tech_item_t *itemi = leaf->item;
 
-      if ( itemi->type == TECH_TYPE_GROUP ) {
-         if ( tech_hasItemInternal( &tech_groups[itemi->u.grp], item, search,
-                                    price ) )
-            return 1;
-      } else if ( itemi->type == TECH_TYPE_GROUP_POINTER ) {
-         if ( tech_hasItemInternal( itemi->u.grpptr, item, search, price ) )
-            return 1;
-      }
+      if ( item->type != itemi->type )
+         continue;
+      if ( item->u.ptr != itemi->u.ptr )
+         continue;
+      if ( tech_testLeaf( leaf, search ) )
+         continue;
+
+      if ( price != NULL )
+         *price = item->price_mod;
+      return 1;
    }
    return 0;
 }
@@ -911,6 +1177,33 @@ char **tech_getAllItemNames( int *n )
    return names;
 }
 
+/**
+ * @brief Gets the current tech generation.
+ *
+ * Changes whenever any tech group is modified, so it can be used to know when
+ * lists generated from tech groups are out of date.
+ *
+ *    @return Current tech generation.
+ */
+unsigned int tech_generation( void )
+{
+   return tech_gen;
+}
+
+/**
+ * @brief Checks to see if a tech group has conditionally available outfits or
+ * ships.
+ *
+ *    @param tech Tech group to check.
+ *    @return 1 if the outfits or ships of the group depend on conditionals.
+ */
+int tech_isConditional( const tech_group_t *tech )
+{
+   if ( tech == NULL )
+      return 0;
+   return ( array_size( tech_compile( tech )->cond ) > 0 );
+}
+
 /**
  * @brief Gets all of the outfits associated to a tech group.
  *
@@ -950,12 +1243,7 @@ Outfit **tech_getOutfitArray( tech_group_t **tech, int num, int search )
    if ( tech == NULL )
       return NULL;
 
-   tech_group_t grp;
-   tech_createMetaGroup( &grp, tech, num );
-   Outfit **o = tech_getOutfit( &grp, search );
-   tech_freeGroup( &grp );
-
-   return o;
+   return tech_getOutfit( tech_getMetaGroup( tech, num ), search );
 }
 
 /**
@@ -997,12 +1285,7 @@ Ship **tech_getShipArray( tech_group_t **tech, int num, int search )
    if ( tech == NULL )
       return NULL;
 
-   tech_group_t grp;
-   tech_createMetaGroup( &grp, tech, num );
-   Ship **s = tech_getShip( &grp, search );
-   tech_freeGroup( &grp );
-
-   return s;
+   return tech_getShip( tech_getMetaGroup( tech, num ), search );
 }
 
 /**
@@ -45,6 +45,8 @@ int tech_hasOutfit( const tech_group_t *tech, const Outfit *o, int search );
 int tech_hasCommodity( const tech_group_t *tech, CommodityRef c, int search );
 int tech_hasCommodityPrice( const tech_group_t *tech, CommodityRef c,
                             double *price );
+unsigned int  tech_generation( void );
+int           tech_isConditional( const tech_group_t *tech );
 Outfit      **tech_getOutfit( const tech_group_t *tech, int search );
 Outfit      **tech_getOutfitArray( tech_group_t **tech, int num, int search );
 Ship        **tech_getShip( const tech_group_t *tech, int search );
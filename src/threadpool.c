@@ -2,34 +2,31 @@
  * See Licensing and Copyright notice in threadpool.h
  */
 /*
- * @brief A simple threadpool implementation using a single queue.
+ * @brief A work-stealing threadpool.
  *
- * The queue is inspired by this paper (look for the queue with two locks):
+ * Every worker thread owns a deque of tasks. New tasks spawned from a worker
+ * are pushed to the bottom of its own deque and popped from there in LIFO
+ * order, which keeps related work on the same thread. Idle workers steal from
+ * the top of the other deques. Tasks submitted from threads that are not
+ * workers go to a shared injection deque that every worker steals from.
  *
- * Maged M. Michael and Michael L. Scott. 1998. Nonblocking algorithms and
- * preemption-safe locking on multiprogrammed shared memory multiprocessors. J.
- * Parallel Distrib. Comput. 51, 1 (May 1998), 1-26. DOI=10.1006/jpdc.1998.1446
- * http://dx.doi.org/10.1006/jpdc.1998.1446
- *
- * @ARTICLE{Michael98non-blockingalgorithms,
- *    author = {Maged M. Michael and Michael L. Scott},
- *    title = {Non-Blocking Algorithms and Preemption-Safe Locking on
- * Multiprogrammed Shared Memory Multiprocessors}, journal = {Journal of
- * Parallel and Distributed Computing}, year = {1998}, volume = {51}, pages =
- * {1--26},
- * }
- *
- * @note The algorithm/strategy for killing idle workers should be moved into
- *       the threadhandler and it should also be improved (the current strategy
- *       is probably not very good).
+ * Tasks belong to a group, which counts unfinished tasks so they can be joined
+ * with taskgroup_wait(). Tasks can also depend on other tasks, in which case
+ * they are only scheduled once all of their dependencies have finished. Since
+ * a worker waiting on a group keeps running tasks, tasks may spawn and wait on
+ * other tasks without deadlocking.
  */
 
 /** @cond */
 #include <stdlib.h>
+#include <string.h>
 
+#include <SDL3/SDL_atomic.h>
 #include <SDL3/SDL_cpuinfo.h>
 #include <SDL3/SDL_mutex.h>
 #include <SDL3/SDL_thread.h>
+
+#include "naev.h"
 /** @endcond */
 
 #include "threadpool.h"
@@ -37,577 +34,661 @@
 #include "array.h"
 #include "log.h"
 
-#define THREADPOOL_TIMEOUT                                                     \
-   ( 5 * 100 )               /* The time a worker thread waits in ms. */
-#define THREADSIG_STOP ( 1 ) /* The signal to stop a worker thread */
-#define THREADSIG_RUN                                                          \
-   ( 0 ) /* The signal to indicate the worker thread is running */
+#define THREADPOOL_WAIT                                                        \
+   ( 1 ) /* Time in ms to wait for other tasks before looking for work. */
+#define PARALLEL_FOR_CHUNKS                                                    \
+   ( 4 ) /* Chunks per thread when automatically choosing the grain. */
+#define TASK_BLOCK ( 64 ) /* Tasks allocated at once by a group. */
 
 /**
- * Threads to use.
+ * @brief A task.
  */
-static int MAXTHREADS = 8; /* Bit overkill, but oh well. */
+struct Task_ {
+   int ( *function )( void * ); /**< The function to be called. */
+   void         *data;          /**< And its arguments. */
+   TaskGroup    *group;         /**< Group the task belongs to. */
+   SDL_AtomicInt pending; /**< Unfinished dependencies, plus one until the task
+                             is submitted. The task is scheduled at 0. */
+   SDL_SpinLock  lock;    /**< Lock for done and successors. */
+   int           done;    /**< Whether or not the task has finished. */
+   Task        **successors; /**< Array (array.h): Tasks depending on this. */
+};
 
 /**
- * @brief Node in the thread queue.
+ * @brief A group of tasks that can be waited on.
  */
-typedef struct Node_ {
-   void         *data; /**< The element in the list */
-   struct Node_ *next; /**< The next node in the list */
-} Node;
+struct TaskGroup_ {
+   SDL_AtomicInt  count;   /**< Number of unfinished tasks. */
+   SDL_AtomicInt  exiting; /**< Tasks that may still be touching the group. */
+   SDL_SpinLock   lock;    /**< Lock for the task blocks. */
+   Task         **blocks;  /**< Array (array.h): Blocks of TASK_BLOCK tasks,
+                              kept when the group is reused. */
+   int            ntasks;  /**< Number of tasks in use. */
+   SDL_Mutex     *mutex;   /**< Mutex for the condition variable. */
+   SDL_Condition *cond;    /**< Signalled when all tasks are done. */
+};
 
-struct vpoolThreadData_;
+/**
+ * @brief A double ended queue of tasks.
+ *
+ * The owner pushes and pops at the tail, while thieves take from the head.
+ */
+typedef struct TaskDeque_ {
+   SDL_SpinLock lock; /**< Lock for the deque. */
+   Task       **buf;  /**< Buffer of tasks. */
+   int          head; /**< First task in the buffer. */
+   int          tail; /**< One past the last task in the buffer. */
+   int          cap;  /**< Capacity of the buffer. */
+} TaskDeque;
 
 /**
- * @brief The `Threadqueue` structure itself.
+ * @brief A worker thread.
  */
-struct ThreadQueue_ {
-   Node *first;   /**< The first node */
-   Node *last;    /**< The second node */
-   Node *reserve; /**< Reserve buffer. */
-   /* A semaphore to ensure reads only happen when the queue is not empty */
-   SDL_Semaphore *semaphore;
-   SDL_Mutex     *t_lock; /**< Tail lock. Lock when reading/updating tail */
-   SDL_Mutex     *h_lock; /**< Same as tail lock, except it's head lock */
-   SDL_Mutex     *r_lock; /**< For reserve buffer. */
-   /* For vpools. */
-   SDL_Condition           *cond;
-   SDL_Mutex               *mutex;
-   struct vpoolThreadData_ *arg;
-   int                      cnt;
-};
+typedef struct Worker_ {
+   int         id;     /**< Index of the worker. */
+   TaskDeque   deque;  /**< Tasks owned by the worker. */
+   SDL_Thread *thread; /**< The thread itself. */
+} Worker;
 
 /**
- * @brief Data for the `Threadqueue`.
+ * @brief Legacy vpool job.
  */
 typedef struct ThreadQueueData_ {
-   int ( *function )( void * ); /* The function to be called */
-   void *data;                  /* And its arguments */
+   int ( *function )( void * ); /**< The function to be called. */
+   void *data;                  /**< And its arguments. */
 } ThreadQueueData;
 
 /**
- * @brief Thread data.
- */
-typedef struct ThreadData_ {
-   int ( *function )( void * ); /* The function to be called */
-   void          *data;         /* Arguments to the above function */
-   int            signal;       /* Signals to the thread */
-   SDL_Semaphore *semaphore; /* The semaphore to signal new jobs or new signal
-                          in the 'signal' variable */
-   ThreadQueue *idle;        /* The queue with idle threads */
-   ThreadQueue *stopped;     /* The queue with stopped threads */
-} ThreadData;
-
-/**
- * @brief Virtual thread pool data.
- */
-struct vpoolThreadData_ {
-   SDL_Condition *cond; /**< Condition variable for signalling all jobs in the
-                      vpool are done */
-   SDL_Mutex *mutex; /**< The mutex to use with the above condition variable */
-   int *count; /**< Variable to count number of finished jobs in the vpool */
-   ThreadQueueData node;    /**< The job to be done */
-   ThreadQueueData wrapper; /**< Wrapper to avoid malloc. */
+ * @brief The legacy vpool queue.
+ */
+struct ThreadQueue_ {
+   TaskGroup       *group; /**< Group running the jobs. */
+   ThreadQueueData *jobs;  /**< Array (array.h): Jobs waiting to be run. */
 };
-typedef struct vpoolThreadData_ vpoolThreadData;
 
-/* The global threadpool queue */
-static ThreadQueue *global_queue = NULL;
+/**
+ * @brief A chunk of a parallel_for.
+ */
+typedef struct ParallelForData_ {
+   void ( *function )( int, int, void * ); /**< Function to run. */
+   void *data;                             /**< Data to pass. */
+   int   start;                            /**< Start of the range. */
+   int   end;                              /**< End of the range. */
+} ParallelForData;
+
+static Worker       *tp_workers  = NULL; /**< The worker threads. */
+static int           tp_nworkers = 0;    /**< Number of worker threads. */
+static TaskDeque     tp_inject; /**< Tasks submitted from other threads. */
+static SDL_Semaphore *tp_sem =
+   NULL; /**< Counts pushed tasks, used to wake up idle workers. */
+static SDL_TLSID tp_self; /**< Worker of the current thread, NULL if none. */
+static SDL_AtomicInt tp_quit; /**< Set to make the workers exit. */
+static SDL_SpinLock  tp_groups_lock; /**< Lock for tp_groups. */
+static TaskGroup   **tp_groups =
+   NULL; /**< Array (array.h): Freed groups kept for reuse. */
 
 /*
  * Prototypes.
  */
-static ThreadQueue *tq_create( void );
-static void         tq_enqueue( ThreadQueue *q, void *data );
-static void        *tq_dequeue( ThreadQueue *q );
-static void         tq_destroy( ThreadQueue *q );
-static int          threadpool_worker( void *data );
-static int          threadpool_handler( void *data );
-static int          vpool_worker( void *data );
+static void  deque_push( TaskDeque *dq, Task *task );
+static Task *deque_pop( TaskDeque *dq );
+static Task *deque_steal( TaskDeque *dq );
+static void  tp_push( Task *task );
+static Task *tp_find( Worker *self );
+static void  tp_run( Task *task );
+static int   tp_worker( void *data );
+static void  taskgroup_join( TaskGroup *group, int help );
+static void  taskgroup_clear( TaskGroup *group );
 
 /**
- * @brief Creates a concurrent queue.
- *
- * The basic concept is that we have a separate lock for both head and tail, so
- *  we can operate separately on either head or tail. This lets us enqueue at
- *  tail and dequeue at the head in true FIFO fashion.
- *
- *    @return The `ThreadQueue`.
+ * @brief Pushes a task to the tail of a deque.
  */
-static ThreadQueue *tq_create( void )
+static void deque_push( TaskDeque *dq, Task *task )
 {
-   ThreadQueue *q;
-   Node        *n;
-
-   /* Queue memory allocation. */
-   q = calloc( 1, sizeof( ThreadQueue ) );
+   SDL_LockSpinlock( &dq->lock );
+   if ( dq->tail >= dq->cap ) {
+      /* Move to the start before growing. */
+      int n = dq->tail - dq->head;
+      if ( dq->head > 0 )
+         memmove( dq->buf, &dq->buf[dq->head], n * sizeof( Task * ) );
+      dq->head = 0;
+      dq->tail = n;
+      if ( n >= dq->cap ) {
+         dq->cap = ( dq->cap > 0 ) ? 2 * dq->cap : 64;
+         dq->buf = realloc( dq->buf, dq->cap * sizeof( Task * ) );
+      }
+   }
+   dq->buf[dq->tail++] = task;
+   SDL_UnlockSpinlock( &dq->lock );
+}
 
-   /* Allocate and insert the dummy node */
-   n        = calloc( 1, sizeof( Node ) );
-   n->next  = NULL;
-   q->first = n;
-   q->last  = n;
+/**
+ * @brief Pops the most recent task from the tail of a deque.
+ */
+static Task *deque_pop( TaskDeque *dq )
+{
+   Task *task = NULL;
+   SDL_LockSpinlock( &dq->lock );
+   if ( dq->tail > dq->head )
+      task = dq->buf[--dq->tail];
+   if ( dq->tail == dq->head )
+      dq->head = dq->tail = 0;
+   SDL_UnlockSpinlock( &dq->lock );
+   return task;
+}
 
-   /* Create locks. */
-   q->t_lock    = SDL_CreateMutex();
-   q->h_lock    = SDL_CreateMutex();
-   q->r_lock    = SDL_CreateMutex();
-   q->semaphore = SDL_CreateSemaphore( 0 );
+/**
+ * @brief Steals the oldest task from the head of a deque.
+ */
+static Task *deque_steal( TaskDeque *dq )
+{
+   Task *task = NULL;
+   SDL_LockSpinlock( &dq->lock );
+   if ( dq->tail > dq->head )
+      task = dq->buf[dq->head++];
+   if ( dq->tail == dq->head )
+      dq->head = dq->tail = 0;
+   SDL_UnlockSpinlock( &dq->lock );
+   return task;
+}
 
-   return q;
+/**
+ * @brief Schedules a task that is ready to run.
+ */
+static void tp_push( Task *task )
+{
+   Worker *self = SDL_GetTLS( &tp_self );
+   deque_push( ( self != NULL ) ? &self->deque : &tp_inject, task );
+   if ( tp_sem != NULL )
+      SDL_SignalSemaphore( tp_sem );
 }
 
 /**
- * @brief Enqueue data to the `ThreadQueue` `q`.
+ * @brief Finds a task to run, looking at the own deque first and then
+ * stealing from the others.
  *
- *    @param q The queue to be inserted into.
- *    @param data The element to be stored in the queue.
+ *    @param self Worker looking for a task, or NULL if not a worker.
+ *    @return Task to run or NULL if none found.
  */
-static void tq_enqueue( ThreadQueue *q, void *data )
+static Task *tp_find( Worker *self )
 {
-   Node *n;
+   Task *task;
+   int   start;
 
-   /* Try to grab reserved struct if possible. */
-   SDL_LockMutex( q->r_lock );
-   if ( q->reserve != NULL ) {
-      n          = q->reserve;
-      q->reserve = n->next;
-   } else
-      n = malloc( sizeof( Node ) );
-   n->data = data;
-   n->next = NULL;
-   SDL_UnlockMutex( q->r_lock );
-
-   /* Lock */
-   SDL_LockMutex( q->t_lock );
-
-   /* Enqueue. */
-   q->last->next = n;
-   q->last       = n;
-
-   /* Signal and unlock. This wil break if someone tries to enqueue 2^32+1
-    * elements or something. */
-   SDL_SignalSemaphore( q->semaphore );
-   SDL_UnlockMutex( q->t_lock );
+   if ( self != NULL ) {
+      task = deque_pop( &self->deque );
+      if ( task != NULL )
+         return task;
+   }
+
+   task = deque_steal( &tp_inject );
+   if ( task != NULL )
+      return task;
+
+   /* Start stealing from the next worker, to spread contention. */
+   start = ( self != NULL ) ? self->id + 1 : 0;
+   for ( int i = 0; i < tp_nworkers; i++ ) {
+      Worker *victim = &tp_workers[( start + i ) % tp_nworkers];
+      if ( victim == self )
+         continue;
+      task = deque_steal( &victim->deque );
+      if ( task != NULL )
+         return task;
+   }
+   return NULL;
+}
+
+/**
+ * @brief Runs a task and schedules the tasks depending on it.
+ */
+static void tp_run( Task *task )
+{
+   TaskGroup *group = task->group;
+   Task     **successors;
+
+   task->function( task->data );
+
+   /* Mark as done so new dependencies are not added. */
+   SDL_LockSpinlock( &task->lock );
+   task->done       = 1;
+   successors       = task->successors;
+   task->successors = NULL;
+   SDL_UnlockSpinlock( &task->lock );
+
+   /* Schedule the successors that no longer have to wait. */
+   for ( int i = 0; i < array_size( successors ); i++ )
+      if ( SDL_AddAtomicInt( &successors[i]->pending, -1 ) == 1 )
+         tp_push( successors[i] );
+   array_free( successors );
+
+   /* Signal the group if it was the last task. Only the last task takes the
+    * mutex, and the waiting thread does not free or reuse the group until
+    * exiting drops back to 0, which is the last access to the group. */
+   SDL_AddAtomicInt( &group->exiting, 1 );
+   if ( SDL_AddAtomicInt( &group->count, -1 ) == 1 ) {
+      SDL_LockMutex( group->mutex );
+      SDL_BroadcastCondition( group->cond );
+      SDL_UnlockMutex( group->mutex );
+   }
+   SDL_AddAtomicInt( &group->exiting, -1 );
 }
 
 /**
- * @brief Dequeue from the `ThreadQueue` `q`.
+ * @brief The worker thread main loop.
  *
- * @attention The callee should ALWAYS have called `SDL_WaitSemaphore()` on the
- * semaphore.
+ * Runs tasks while there are any, otherwise sleeps until new ones are pushed.
  *
- *    @param q The queue to dequeue from.
- *    @return A void pointer to the element from the queue.
+ *    @param data The Worker.
  */
-static void *tq_dequeue( ThreadQueue *q )
+static int tp_worker( void *data )
 {
-   void *d;
-   Node *newhead, *node;
-
-   /* Lock the head. */
-   SDL_LockMutex( q->h_lock );
-
-   /* Start running. */
-   node    = q->first;
-   newhead = node->next;
-
-   /* Head not consistent. */
-   if ( newhead == NULL ) {
-      WARN( _( "Tried to dequeue while the queue was empty!" ) );
-      /* Ugly fix :/ */
-      /*
-      SDL_UnlockMutex(q->h_lock);
-      return NULL;
-      */
-      /* We prefer to wait until the cache updates :/ */
-      do {
-         node    = q->first;
-         newhead = node->next;
-      } while ( newhead == NULL );
+   Worker *self = data;
+   SDL_SetTLS( &tp_self, self, NULL );
+   while ( !SDL_GetAtomicInt( &tp_quit ) ) {
+      Task *task = tp_find( self );
+      if ( task != NULL )
+         tp_run( task );
+      else
+         SDL_WaitSemaphore( tp_sem );
    }
-
-   /* Remember the value and assign newhead as the new dummy element. */
-   d        = newhead->data;
-   q->first = newhead;
-
-   /* Unlock */
-   SDL_UnlockMutex( q->h_lock );
-
-   /* Save memory in reserve. */
-   SDL_LockMutex( q->r_lock );
-   node->next = q->reserve;
-   q->reserve = node;
-   SDL_UnlockMutex( q->r_lock );
-
-   return d;
+   return 0;
 }
 
 /**
- * @brief Destroys and frees a `ThreadQueue`.
+ * @brief Initialize the global threadpool.
  *
- * Frees all elements too.
+ * Creates one worker per logical CPU core except for the one used by the main
+ * thread, which also runs tasks when waiting on them.
  *
- *    @param q The `ThreadQueue` to free.
+ *    @return Returns 0 on success and -1 if there's already a threadpool.
  */
-static void tq_destroy( ThreadQueue *q )
+int threadpool_init( void )
 {
-   /* Iterate through the list and free the nodes */
-   while ( q->first != NULL ) {
-      Node *n  = q->first;
-      q->first = n->next;
-      free( n );
+   /* There's already a threadpool. */
+   if ( tp_workers != NULL ) {
+      WARN( _( "Threadpool has already been initialized!" ) );
+      return -1;
    }
 
-   /* Free reserve. */
-   while ( q->reserve != NULL ) {
-      Node *n    = q->reserve;
-      q->reserve = n->next;
-      free( n );
+   SDL_SetAtomicInt( &tp_quit, 0 );
+   tp_nworkers = MAX( 1, SDL_GetNumLogicalCPUCores() - 1 );
+   tp_sem      = SDL_CreateSemaphore( 0 );
+   tp_workers  = calloc( tp_nworkers, sizeof( Worker ) );
+   for ( int i = 0; i < tp_nworkers; i++ ) {
+      Worker *w = &tp_workers[i];
+      w->id     = i;
+      w->thread = SDL_CreateThread( tp_worker, "threadpool_worker", w );
+      if ( w->thread == NULL ) {
+         ERR( _( "Threadpool init failed: %s" ), SDL_GetError() );
+         return -1;
+      }
    }
 
-   /* Clean up threading structures. */
-   SDL_DestroySemaphore( q->semaphore );
-   SDL_DestroyMutex( q->h_lock );
-   SDL_DestroyMutex( q->t_lock );
-   SDL_DestroyMutex( q->r_lock );
-
-   /* Clean up vpool structures. */
-   if ( q->mutex != NULL )
-      SDL_DestroyMutex( q->mutex );
-   if ( q->cond != NULL )
-      SDL_DestroyCondition( q->cond );
-   array_free( q->arg );
-
-   free( q->first );
-   free( q );
+   return 0;
 }
 
 /**
- * @brief The worker function for the threadpool.
+ * @brief Stops the worker threads and frees the threadpool.
  *
- * It waits for a signal from the handler. If it receives THREADSIG_STOP it
- *  means the worker thread should stop. Else it dequeues a job from the
- *  global_queue and executes it.
- *
- *    @param data A pointer to the `ThreadData` struct used for a lot of stuff.
+ * Tasks that have not started yet are dropped, so every task group should
+ * have been waited on.
  */
-static int threadpool_worker( void *data )
+void threadpool_exit( void )
 {
-   ThreadData *work = (ThreadData *)data;
-
-   /* Work loop */
-   while ( 1 ) {
-      /* Wait for new signal */
-      SDL_WaitSemaphore( work->semaphore );
-      /* Break if received signal to stop */
-      if ( work->signal == THREADSIG_STOP )
-         break;
-
-      /* Do work :-) */
-      work->function( work->data );
+   if ( tp_workers == NULL )
+      return;
 
-      /* Enqueue itself in the idle worker threads queue */
-      tq_enqueue( work->idle, work );
+   /* Wake up every worker so they see they have to quit. */
+   SDL_SetAtomicInt( &tp_quit, 1 );
+   for ( int i = 0; i < tp_nworkers; i++ )
+      SDL_SignalSemaphore( tp_sem );
+   for ( int i = 0; i < tp_nworkers; i++ ) {
+      SDL_WaitThread( tp_workers[i].thread, NULL );
+      free( tp_workers[i].deque.buf );
+   }
+   free( tp_workers );
+   tp_workers  = NULL;
+   tp_nworkers = 0;
+
+   SDL_DestroySemaphore( tp_sem );
+   tp_sem = NULL;
+   free( tp_inject.buf );
+   memset( &tp_inject, 0, sizeof( TaskDeque ) );
+
+   /* Free the groups kept for reuse. */
+   for ( int i = 0; i < array_size( tp_groups ); i++ ) {
+      TaskGroup *group = tp_groups[i];
+      for ( int j = 0; j < array_size( group->blocks ); j++ )
+         free( group->blocks[j] );
+      array_free( group->blocks );
+      SDL_DestroyCondition( group->cond );
+      SDL_DestroyMutex( group->mutex );
+      free( group );
    }
-   /* Enqueue itself in the stopped worker threads queue when stopped */
-   tq_enqueue( work->stopped, work );
+   array_free( tp_groups );
+   tp_groups = NULL;
+}
 
-   return 0;
+/**
+ * @brief Gets the number of worker threads in the threadpool.
+ */
+int threadpool_workers( void )
+{
+   return tp_nworkers;
 }
 
 /**
- * @brief Handles assigning jobs to the workers and killing them if necessary.
+ * @brief Creates a task group.
  *
- * @note Stopping the threeadpool_handler is not yet implemented.
+ *    @return The new task group, free with taskgroup_free().
+ */
+TaskGroup *taskgroup_create( void )
+{
+   TaskGroup *group = NULL;
+
+   /* Groups are created for every parallel_for, so reuse freed ones. */
+   SDL_LockSpinlock( &tp_groups_lock );
+   if ( array_size( tp_groups ) > 0 ) {
+      group = tp_groups[array_size( tp_groups ) - 1];
+      array_resize( &tp_groups, array_size( tp_groups ) - 1 );
+   }
+   SDL_UnlockSpinlock( &tp_groups_lock );
+   if ( group != NULL )
+      return group;
+
+   group         = calloc( 1, sizeof( TaskGroup ) );
+   group->blocks = array_create( Task * );
+   group->mutex  = SDL_CreateMutex();
+   group->cond   = SDL_CreateCondition();
+   return group;
+}
+
+/**
+ * @brief Creates a task.
  *
- * Process is:
+ * The task does not run until it is submitted with task_submit(), which allows
+ * setting up dependencies first.
  *
- * 1) Wait for job
- * 2) if Timed out -> kill idle, putting on stopped, go to 1)
- * 3) Have thread run job
- * 3.1) Grab a job from the queue
- * 3.2) If idle thread, grab idle thread
- *      else if stopped threads, reactivate stopped thread
- *      else wait for running thread
- * 4) Go to 1)
+ *    @param group Group the task belongs to.
+ *    @param function Function to run.
+ *    @param data Data to pass to the function.
+ *    @return The new task, valid until taskgroup_wait() returns.
+ */
+Task *task_create( TaskGroup *group, int ( *function )( void * ), void *data )
+{
+   Task *task;
+   int   n;
+
+   /* Tasks come from blocks owned by the group, which are kept around when the
+    * group is waited on so the next tasks do not have to be allocated. */
+   SDL_LockSpinlock( &group->lock );
+   n = group->ntasks++;
+   if ( n >= array_size( group->blocks ) * TASK_BLOCK )
+      array_push_back( &group->blocks, malloc( TASK_BLOCK * sizeof( Task ) ) );
+   task = &group->blocks[n / TASK_BLOCK][n % TASK_BLOCK];
+   SDL_UnlockSpinlock( &group->lock );
+
+   memset( task, 0, sizeof( Task ) );
+   task->function = function;
+   task->data     = data;
+   task->group    = group;
+   SDL_SetAtomicInt( &task->pending, 1 );
+   SDL_AddAtomicInt( &group->count, 1 );
+   return task;
+}
+
+/**
+ * @brief Makes a task wait for another one to finish before running.
  *
- *    @param data Not used. SDL threading requires functions to take a void
- *                pointer as argument.
- *    @return Not really implemented yet.
+ *    @param task Task that has not been submitted yet.
+ *    @param dependency Task to wait for.
  */
-static int threadpool_handler( void *data )
+void task_depends( Task *task, Task *dependency )
 {
-   (void)data;
-   int         nrunning, newthread;
-   ThreadData *threadargs, *threadarg;
-   /* Queues for idle workers and stopped workers */
-   ThreadQueue     *idle, *stopped;
-   ThreadQueueData *node;
-
-   /* Initialize the idle and stopped queues. */
-   idle    = tq_create();
-   stopped = tq_create();
-
-   /* Allocate threadargs to communicate with workers */
-   threadargs = calloc( MAXTHREADS, sizeof( ThreadData ) );
-
-   /* Initialize threadargs */
-   for ( int i = 0; i < MAXTHREADS; i++ ) {
-      threadargs[i].function = NULL;
-      threadargs[i].data     = NULL;
-      threadargs[i].semaphore =
-         SDL_CreateSemaphore( 0 ); /* Used to give orders. */
-      threadargs[i].idle    = idle;
-      threadargs[i].stopped = stopped;
-      threadargs[i].signal  = THREADSIG_RUN;
-      /* 'Workers' that do not have a thread are considered stopped */
-      tq_enqueue( stopped, &threadargs[i] );
+   SDL_LockSpinlock( &dependency->lock );
+   if ( !dependency->done ) {
+      if ( dependency->successors == NULL )
+         dependency->successors = array_create( Task * );
+      array_push_back( &dependency->successors, task );
+      SDL_AddAtomicInt( &task->pending, 1 );
    }
+   SDL_UnlockSpinlock( &dependency->lock );
+}
 
-   /* Set the number of running threads to 0 */
-   nrunning = 0;
-
-   /*
-    * Thread handler main loop.
-    */
-   while ( 1 ) {
-      /*
-       * We must now wait, this shall be done on each active thread. However
-       * they will be put to sleep as time passes. When we receive a command
-       * we'll proceed to process it.
-       */
-      if ( nrunning > 0 ) {
-         /*
-          * Here we'll wait until thread gets work to do. If it doesn't it will
-          * just stop a worker thread and wait until it gets something to do.
-          */
-         if ( SDL_WaitSemaphoreTimeout( global_queue->semaphore,
-                                        THREADPOOL_TIMEOUT ) == 0 ) {
-            /* There weren't any new jobs so we'll start killing threads ;) */
-            if ( SDL_TryWaitSemaphore( idle->semaphore ) ) {
-               threadarg = tq_dequeue( idle );
-               /* Set signal to stop worker thread */
-               threadarg->signal = THREADSIG_STOP;
-               /* Signal thread and decrement running threads counter */
-               SDL_SignalSemaphore( threadarg->semaphore );
-               nrunning -= 1;
-            }
-
-            /* We just go back to waiting on a thread. */
-            continue;
-         }
+/**
+ * @brief Submits a task, scheduling it once all dependencies are done.
+ */
+void task_submit( Task *task )
+{
+   if ( SDL_AddAtomicInt( &task->pending, -1 ) == 1 )
+      tp_push( task );
+}
 
-         /* We got work. Continue to handle work. */
-      } else {
-         /*
-          * Here we wait for a new job. No threads are alive at this point and
-          * the threadpool is just patiently waiting for work to arrive.
-          */
-         SDL_WaitSemaphore( global_queue->semaphore );
+/**
+ * @brief Creates and submits a task with no dependencies.
+ *
+ *    @param group Group the task belongs to.
+ *    @param function Function to run.
+ *    @param data Data to pass to the function.
+ *    @return The new task, valid until taskgroup_wait() returns.
+ */
+Task *taskgroup_spawn( TaskGroup *group, int ( *function )( void * ),
+                       void      *data )
+{
+   Task *task = task_create( group, function, data );
+   task_submit( task );
+   return task;
+}
 
-         /* We got work. Continue to handle work. */
-      }
+/**
+ * @brief Waits for all the tasks in a group and frees them.
+ *
+ *    @param group Group to wait for.
+ *    @param help Whether or not to run tasks while waiting.
+ */
+static void taskgroup_join( TaskGroup *group, int help )
+{
+   Worker *self = SDL_GetTLS( &tp_self );
 
-      /*
-       * Get a new job from the queue. This should be safe as we have received
-       * a permission from the global_queue->semaphore.
-       */
-      node      = tq_dequeue( global_queue );
-      newthread = 0;
-
-      /*
-       * Choose where to get the thread. Either idle, revive stopped or block
-       * until another thread becomes idle.
-       */
-      /* Idle thread available */
-      if ( SDL_TryWaitSemaphore( idle->semaphore ) )
-         threadarg = tq_dequeue( idle );
-      /* Make a new thread */
-      else if ( SDL_TryWaitSemaphore( stopped->semaphore ) ) {
-         threadarg         = tq_dequeue( stopped );
-         threadarg->signal = THREADSIG_RUN;
-         newthread         = 1;
-      }
-      /* Wait for idle thread */
-      else {
-         SDL_WaitSemaphore( idle->semaphore );
-         threadarg = tq_dequeue( idle );
+   while ( SDL_GetAtomicInt( &group->count ) > 0 ) {
+      if ( help ) {
+         Task *task = tp_find( self );
+         if ( task != NULL ) {
+            tp_run( task );
+            continue;
+         }
       }
 
-      /* Assign arguments for the thread */
-      threadarg->function = node->function;
-      threadarg->data     = node->data;
-      /* Signal the thread that there's a new job */
-      SDL_SignalSemaphore( threadarg->semaphore );
-
-      /* Start a new thread and increment the thread counter */
-      if ( newthread ) {
-         SDL_Thread *th = SDL_CreateThread( threadpool_worker,
-                                            "threadpool_worker", threadarg );
-         SDL_DetachThread( th );
-         nrunning += 1;
+      /* Nothing to do, wait for the other tasks. When helping, wake up every
+       * now and then to see if there are new tasks to run. */
+      SDL_LockMutex( group->mutex );
+      if ( SDL_GetAtomicInt( &group->count ) > 0 ) {
+         if ( help )
+            SDL_WaitConditionTimeout( group->cond, group->mutex,
+                                      THREADPOOL_WAIT );
+         else
+            SDL_WaitCondition( group->cond, group->mutex );
       }
+      SDL_UnlockMutex( group->mutex );
    }
-   /** @TODO A way to stop the threadpool. */
 
-   /* Clean up. */
-   tq_destroy( idle );
-   tq_destroy( stopped );
-   free( threadargs );
+   /* Make sure the last task is done with the group. */
+   while ( SDL_GetAtomicInt( &group->exiting ) > 0 )
+      SDL_CPUPauseInstruction();
 
-   return 0;
+   /* All tasks are done so they can be reused. */
+   taskgroup_clear( group );
 }
 
 /**
- * @brief Initialize the global threadpool.
+ * @brief Clears the tasks of a group, keeping the blocks they were in.
+ */
+static void taskgroup_clear( TaskGroup *group )
+{
+   for ( int i = 0; i < group->ntasks; i++ )
+      array_free( group->blocks[i / TASK_BLOCK][i % TASK_BLOCK].successors );
+   group->ntasks = 0;
+}
+
+/**
+ * @brief Runs tasks until all the tasks in a group are done.
  *
- *    @return Returns 0 on success and -1 if there's already a threadpool.
+ * Afterwards all the tasks in the group are freed, but the group can be used
+ * again.
+ *
+ *    @param group Group to wait for.
  */
-int threadpool_init( void )
+void taskgroup_wait( TaskGroup *group )
 {
-   MAXTHREADS = SDL_GetNumLogicalCPUCores() + 1;
+   taskgroup_join( group, 1 );
+}
 
-   /* There's already a queue */
-   if ( global_queue != NULL ) {
-      WARN( _( "Threadpool has already been initialized!" ) );
-      return -1;
+/**
+ * @brief Frees a task group.
+ *
+ * The group is kept to be handed out again by taskgroup_create(), and is only
+ * really freed by threadpool_exit().
+ */
+void taskgroup_free( TaskGroup *group )
+{
+   if ( group == NULL )
+      return;
+   if ( SDL_GetAtomicInt( &group->count ) > 0 ) {
+      /* Tasks may still be using it, so it can't be reused. */
+      WARN( _( "Freeing task group with unfinished tasks!" ) );
+      return;
    }
+   while ( SDL_GetAtomicInt( &group->exiting ) > 0 )
+      SDL_CPUPauseInstruction();
+   taskgroup_clear( group );
+
+   SDL_LockSpinlock( &tp_groups_lock );
+   if ( tp_groups == NULL )
+      tp_groups = array_create( TaskGroup * );
+   array_push_back( &tp_groups, group );
+   SDL_UnlockSpinlock( &tp_groups_lock );
+}
 
-   /* Create the global queue queue */
-   global_queue = tq_create();
+/**
+ * @brief Runs a chunk of a parallel_for.
+ */
+static int parallel_forChunk( void *data )
+{
+   const ParallelForData *pfd = data;
+   pfd->function( pfd->start, pfd->end, pfd->data );
+   return 0;
+}
 
-   /* Initialize the threadpool handler. */
-   SDL_Thread *th =
-      SDL_CreateThread( threadpool_handler, "threadpool_handler", NULL );
-   if ( th == NULL ) {
-      ERR( _( "Threadpool init failed: %s" ), SDL_GetError() );
-      return -1;
+/**
+ * @brief Runs a function over a range in parallel.
+ *
+ * The range is split into chunks that are run as tasks, with the calling
+ * thread helping out until all are done. It can be nested within tasks.
+ *
+ *    @param start Start of the range.
+ *    @param end End of the range (not included).
+ *    @param grain Maximum number of elements per chunk, or 0 or less to pick
+ *           one based on the number of threads.
+ *    @param function Function to run on each chunk [start, end).
+ *    @param data Data to pass to the function.
+ */
+void parallel_for( int start, int end, int grain,
+                   void ( *function )( int start, int end, void *data ),
+                   void *data )
+{
+   ParallelForData *chunks;
+   TaskGroup       *group;
+   int              n = end - start;
+   int              nchunks;
+
+   if ( n <= 0 )
+      return;
+   if ( grain <= 0 )
+      grain = MAX( 1, n / ( ( tp_nworkers + 1 ) * PARALLEL_FOR_CHUNKS ) );
+
+   /* Not worth going through the threadpool. */
+   if ( ( n <= grain ) || ( tp_nworkers <= 0 ) ) {
+      function( start, end, data );
+      return;
    }
-   SDL_DetachThread( th );
 
-   return 0;
+   nchunks = ( n + grain - 1 ) / grain;
+   chunks  = malloc( nchunks * sizeof( ParallelForData ) );
+   group   = taskgroup_create();
+   for ( int i = 0; i < nchunks; i++ ) {
+      ParallelForData *pfd = &chunks[i];
+      pfd->function        = function;
+      pfd->data            = data;
+      pfd->start           = start + i * grain;
+      pfd->end             = MIN( end, pfd->start + grain );
+      taskgroup_spawn( group, parallel_forChunk, pfd );
+   }
+   taskgroup_wait( group );
+   taskgroup_free( group );
+   free( chunks );
 }
 
 /**
  * @brief Creates a new vpool queue.
  *
  * This is just an interface to make running a number of jobs and then wait for
- *  them to finish more pleasant. You should not nest `vpools` as of now as
- * there are only a limit number of worker threads and we can't have them wait
- * for a thread to finish that doesn't exist.
- *
- * If you really want to sort of nest `vpools`, you should start a new thread
- *  instead of using the threadpool. I might add a vpool_waitInANewThread
- *  function some day.
+ * them to finish more pleasant.
  *
  *    @return Returns a `ThreadQueue` to be used.
  */
 ThreadQueue *vpool_create( void )
 {
-   ThreadQueue *tq = tq_create();
-   /* Create vpool-specific threading structures. */
-   tq->cond  = SDL_CreateCondition();
-   tq->mutex = SDL_CreateMutex();
-   tq->arg   = array_create( vpoolThreadData );
+   ThreadQueue *tq = calloc( 1, sizeof( ThreadQueue ) );
+   tq->group       = taskgroup_create();
+   tq->jobs        = array_create( ThreadQueueData );
    return tq;
 }
 
 /**
  * @brief Enqueue a job in the vpool queue.
  *
- * @warning Do NOT enqueue jobs that wait for another job to be done, as this
- *          could lead to a deadlock.
+ * The job does not start until vpool_wait() is called.
  */
 void vpool_enqueue( ThreadQueue *queue, int ( *function )( void * ),
                     void        *data )
 {
-   vpoolThreadData *arg = &array_grow( &queue->arg );
-   memset( arg, 0, sizeof( vpoolThreadData ) );
-   /* Common field.s */
-   arg->cond  = queue->cond;
-   arg->mutex = queue->mutex;
-   arg->count = &queue->cnt;
-   /* Task-specific stuff. */
-   arg->node.data     = data;
-   arg->node.function = function;
-   SDL_SignalSemaphore( queue->semaphore );
-   arg->wrapper.function = vpool_worker;
-}
-
-/**
- * @brief A special vpool worker that signals the waiting thread when all jobs
- *        are done.
- *
- * It uses a mutex+condition variable+counter.
- */
-static int vpool_worker( void *data )
-{
-   int              cnt;
-   vpoolThreadData *work = (vpoolThreadData *)data;
-
-   /* Do work */
-   work->node.function( work->node.data );
-
-   /* Decrement the counter and signal vpool_wait if all threads are done */
-   SDL_LockMutex( work->mutex );
-   cnt = *( work->count ) - 1;
-   if ( cnt <= 0 )                       /* All jobs done. */
-      SDL_SignalCondition( work->cond ); /* Signal waiting thread */
-   *( work->count ) = cnt;
-   SDL_UnlockMutex( work->mutex );
-
-   return 0;
+   ThreadQueueData *job = &array_grow( &queue->jobs );
+   job->function        = function;
+   job->data            = data;
 }
 
 /* @brief Run every job in the vpool queue and block until every job in the
  *        queue is done.
  *
- * @note It destroys the queue when it's done.
+ * Jobs may set their own OpenGL context, so when not called from a task the
+ * calling thread does not run any of them.
  */
 void vpool_wait( ThreadQueue *queue )
 {
-   /* Number of tasks we have. */
-   int cnt;
-   queue->cnt = array_size( queue->arg );
-   cnt        = queue->cnt;
+   int help;
 
-   if ( global_queue == NULL ) {
+   if ( tp_workers == NULL ) {
       WARN( _( "Threadpool has not been initialized yet!" ) );
-      return;
-   }
-
-   /* Nothing to do. */
-   if ( cnt <= 0 )
-      return;
-
-   /* Allocate all vpoolThreadData objects */
-   SDL_LockMutex( queue->mutex );
-   /* Initialize the vpoolThreadData */
-   for ( int i = 0; i < cnt; i++ ) {
-      vpoolThreadData *arg;
-      /* This is needed to keep the invariants of the queue */
-      SDL_WaitSemaphore( queue->semaphore );
-      /* Launch new job. */
-      arg               = &queue->arg[i];
-      arg->wrapper.data = arg;
-      tq_enqueue( global_queue, &queue->arg[i].wrapper );
-   }
+      help = 1;
+   } else
+      help = ( SDL_GetTLS( &tp_self ) != NULL );
 
-   /* Wait for the threads to finish */
-   SDL_WaitCondition( queue->cond, queue->mutex );
-   SDL_UnlockMutex( queue->mutex );
+   for ( int i = 0; i < array_size( queue->jobs ); i++ )
+      taskgroup_spawn( queue->group, queue->jobs[i].function,
+                       queue->jobs[i].data );
+   taskgroup_join( queue->group, help );
 
    /* Can toss away all the queue stuff. */
-   array_erase( &queue->arg, array_begin( queue->arg ),
-                array_end( queue->arg ) );
+   array_erase( &queue->jobs, array_begin( queue->jobs ),
+                array_end( queue->jobs ) );
 }
 
 /**
- * @brief Cleans up the threadpool.
+ * @brief Cleans up the vpool queue.
  */
 void vpool_cleanup( ThreadQueue *queue )
 {
-   /* Clean up */
-   tq_destroy( queue );
+   taskgroup_free( queue->group );
+   array_free( queue->jobs );
+   free( queue );
 }
@@ -14,23 +14,75 @@
  */
 #pragma once
 
-struct ThreadQueue_;
-typedef struct ThreadQueue_ ThreadQueue;
+/*
+ * Work-stealing scheduler.
+ *
+ * Each worker thread has its own deque of tasks and steals from the others
+ * when it runs out. Tasks may spawn other tasks and wait on them, as waiting
+ * from a worker thread runs other tasks instead of blocking.
+ */
+struct Task_;
+typedef struct Task_ Task;
+struct TaskGroup_;
+typedef struct TaskGroup_ TaskGroup;
 
-/* Initializes the threadpool */
+/* Initializes the threadpool, sized to the number of CPU cores. */
 int threadpool_init( void );
 
-/* Creates a new vpool queue. Destroy with vpool_wait. */
+/* Stops the worker threads and frees the threadpool. */
+void threadpool_exit( void );
+
+/* Gets the number of worker threads. */
+int threadpool_workers( void );
+
+/* Creates a group of tasks that can be waited on. */
+TaskGroup *taskgroup_create( void );
+
+/* Creates a task in a group. It will not run until submitted with
+ * task_submit(). Tasks are valid until taskgroup_wait() returns. */
+Task *task_create( TaskGroup *group, int ( *function )( void * ), void *data );
+
+/* Makes a task wait for another to finish before running. Must be called
+ * before the task is submitted. */
+void task_depends( Task *task, Task *dependency );
+
+/* Submits a task to run when all its dependencies are done. */
+void task_submit( Task *task );
+
+/* Creates and submits a task with no dependencies. */
+Task *taskgroup_spawn( TaskGroup *group, int ( *function )( void * ),
+                       void      *data );
+
+/* Runs tasks until every task in the group is done, then frees them. Can be
+ * called from tasks. */
+void taskgroup_wait( TaskGroup *group );
+
+/* Frees a task group, keeping it around for taskgroup_create() to reuse. It
+ * must have been waited on. */
+void taskgroup_free( TaskGroup *group );
+
+/* Runs a function over the range [start, end) in parallel, in chunks of at
+ * most grain elements. A grain of 0 or less picks one automatically. */
+void parallel_for( int start, int end, int grain,
+                   void ( *function )( int start, int end, void *data ),
+                   void *data );
+
+/*
+ * Legacy vpool interface, implemented on top of task groups.
+ */
+struct ThreadQueue_;
+typedef struct ThreadQueue_ ThreadQueue;
+
+/* Creates a new vpool queue. Destroy with vpool_cleanup. */
 ThreadQueue *vpool_create( void );
 
-/* Enqueue a job in the vpool queue. Do NOT enqueue a job that has to wait for
- * another job to be done as this could lead to a deadlock. Also do not enqueue
- * jobs from enqueued threads. */
+/* Enqueue a job in the vpool queue. Jobs are only started by vpool_wait. */
 void vpool_enqueue( ThreadQueue *queue, int ( *function )( void * ),
                     void        *data );
 
 /* Run every job in the vpool queue and block until every job in the queue is
- * done. */
+ * done. Unless called from a task, the calling thread only waits and does not
+ * run jobs itself, so jobs never run on the main thread. */
 void vpool_wait( ThreadQueue *queue );
 
 /* Clean up. */
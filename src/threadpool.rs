@@ -0,0 +1,135 @@
+//! Tests for the work-stealing threadpool in threadpool.c.
+
+#[cfg(test)]
+mod tests {
+   use std::ffi::c_void;
+   use std::os::raw::c_int;
+   use std::sync::atomic::{AtomicI32, Ordering};
+
+   const ITERATIONS: usize = 200;
+   const ELEMENTS: usize = 10000;
+   const CHAIN: usize = 32;
+
+   /// Job visiting a single element.
+   struct Job {
+      visits: *const Vec<AtomicI32>,
+      index: usize,
+   }
+
+   /// Link in a chain of dependent tasks.
+   struct Link {
+      order: *const AtomicI32,
+      ran: i32,
+   }
+
+   unsafe extern "C" fn visit(start: c_int, end: c_int, data: *mut c_void) {
+      let visits = unsafe { &*(data as *const Vec<AtomicI32>) };
+      for i in start..end {
+         visits[i as usize].fetch_add(1, Ordering::Relaxed);
+      }
+   }
+
+   /// Runs a small parallel_for per element, waiting on it from within a task.
+   unsafe extern "C" fn nested(start: c_int, end: c_int, data: *mut c_void) {
+      for _ in start..end {
+         unsafe { naevc::parallel_for(0, (ELEMENTS / 100) as c_int, 4, Some(visit), data) };
+      }
+   }
+
+   unsafe extern "C" fn run_job(data: *mut c_void) -> c_int {
+      let job = unsafe { &*(data as *const Job) };
+      let visits = unsafe { &*job.visits };
+      visits[job.index].fetch_add(1, Ordering::Relaxed);
+      0
+   }
+
+   unsafe extern "C" fn run_link(data: *mut c_void) -> c_int {
+      let link = unsafe { &mut *(data as *mut Link) };
+      link.ran = unsafe { &*link.order }.fetch_add(1, Ordering::SeqCst);
+      0
+   }
+
+   /// Checks how many times the first n elements were visited and resets them.
+   fn check(visits: &[AtomicI32], n: usize, expected: i32, name: &str) {
+      for (i, v) in visits[..n].iter().enumerate() {
+         assert_eq!(
+            v.swap(0, Ordering::Relaxed),
+            expected,
+            "{name}: element {i}"
+         );
+      }
+   }
+
+   /// Runs every part of the threadpool many times over, which is mainly useful to have data
+   /// races and lost wake ups show up, ideally with the C code built with ThreadSanitizer.
+   #[test]
+   fn test_threadpool_stress() {
+      unsafe { naevc::threadpool_init() };
+
+      let visits: Vec<AtomicI32> = (0..ELEMENTS).map(|_| AtomicI32::new(0)).collect();
+      let data = &visits as *const Vec<AtomicI32> as *mut c_void;
+      let jobs: Vec<Job> = (0..ELEMENTS)
+         .map(|index| Job {
+            visits: &visits,
+            index,
+         })
+         .collect();
+      let order = AtomicI32::new(0);
+
+      for _ in 0..ITERATIONS {
+         // Plain and automatically sized parallel_for
+         unsafe {
+            naevc::parallel_for(0, ELEMENTS as c_int, 64, Some(visit), data);
+            naevc::parallel_for(0, ELEMENTS as c_int, 0, Some(visit), data);
+         }
+         check(&visits, ELEMENTS, 2, "parallel_for");
+
+         // Nested parallel_for
+         unsafe { naevc::parallel_for(0, 100, 1, Some(nested), data) };
+         check(&visits, ELEMENTS / 100, 100, "nested");
+
+         // A chain of dependencies submitted in reverse, which has to run in order, next to tasks
+         // that can run at any time
+         order.store(0, Ordering::SeqCst);
+         let mut links: Vec<Link> = (0..CHAIN)
+            .map(|_| Link {
+               order: &order,
+               ran: -1,
+            })
+            .collect();
+         unsafe {
+            let group = naevc::taskgroup_create();
+            let tasks: Vec<*mut naevc::Task> = links
+               .iter_mut()
+               .map(|l| naevc::task_create(group, Some(run_link), l as *mut Link as *mut c_void))
+               .collect();
+            for w in tasks.windows(2) {
+               naevc::task_depends(w[1], w[0]);
+            }
+            for (i, task) in tasks.iter().enumerate().rev() {
+               naevc::task_submit(*task);
+               naevc::taskgroup_spawn(group, Some(run_job), &jobs[i] as *const Job as *mut c_void);
+            }
+            naevc::taskgroup_wait(group);
+            naevc::taskgroup_free(group);
+         }
+         for (i, w) in links.windows(2).enumerate() {
+            assert!(w[1].ran > w[0].ran, "task {} ran before task {i}", i + 1);
+         }
+         check(&visits, CHAIN, 1, "spawn");
+
+         // Legacy vpool interface
+         unsafe {
+            let queue = naevc::vpool_create();
+            for job in &jobs {
+               naevc::vpool_enqueue(queue, Some(run_job), job as *const Job as *mut c_void);
+            }
+            naevc::vpool_wait(queue);
+            naevc::vpool_cleanup(queue);
+         }
+         check(&visits, ELEMENTS, 1, "vpool");
+      }
+
+      unsafe { naevc::threadpool_exit() };
+   }
+}
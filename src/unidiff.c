@@ -1577,28 +1577,34 @@ int diff_patchHunk( UniHunk_t *hunk )
       diff_universe_changed = 1;
       hunk->o.fdata         = p->presence.base;
       p->presence.base      = hunk->u.fdata;
+      space_presenceDirty( &p->presence );
       return 0;
    case HUNK_TYPE_SPOB_PRESENCE_BASE_REVERT:
       diff_universe_changed = 1;
       p->presence.base      = hunk->o.fdata;
+      space_presenceDirty( &p->presence );
       return 0;
    case HUNK_TYPE_SPOB_PRESENCE_BONUS:
       diff_universe_changed = 1;
       hunk->o.fdata         = p->presence.bonus;
       p->presence.bonus     = hunk->u.fdata;
+      space_presenceDirty( &p->presence );
       return 0;
    case HUNK_TYPE_SPOB_PRESENCE_BONUS_REVERT:
       diff_universe_changed = 1;
       p->presence.bonus     = hunk->o.fdata;
+      space_presenceDirty( &p->presence );
       return 0;
    case HUNK_TYPE_SPOB_PRESENCE_RANGE:
       diff_universe_changed = 1;
       hunk->o.data          = p->presence.range;
       p->presence.range     = hunk->u.data;
+      space_presenceDirty( &p->presence );
       return 0;
    case HUNK_TYPE_SPOB_PRESENCE_RANGE_REVERT:
       diff_universe_changed = 1;
       p->presence.range     = hunk->o.data;
+      space_presenceDirty( &p->presence );
       return 0;
 
    /* Changing spob hide. */
@@ -2090,7 +2096,7 @@ static int diff_checkUpdateUniverse( void )
    /* Reconstruct jumps just in case. */
    systems_reconstructJumps();
    /* Update presences, then safelanes. */
-   space_reconstructPresences();
+   space_updatePresences();
    safelanes_recalculate();
 
    /* Re-compute the economy. */
@@ -634,18 +634,25 @@ static void think_beam( Weapon *w, double dt )
 void weapons_updatePurge( void )
 {
    NTracingZone( _ctx, 1 );
+   int n;
 
    /* Clear quadtree. */
    qt_clear( &weapon_quadtree );
 
-   /* Actually purge and remove weapons. */
-   for ( int i = array_size( weapon_stack ) - 1; i >= 0; i-- ) {
+   /* Actually purge and remove weapons. Done in a single compacting pass so
+    * the stack stays sorted by ID without shifting it once per weapon. */
+   n = 0;
+   for ( int i = 0; i < array_size( weapon_stack ); i++ ) {
       Weapon *w = &weapon_stack[i];
-      if ( !weapon_isFlag( w, WEAPON_FLAG_DESTROYED ) )
+      if ( weapon_isFlag( w, WEAPON_FLAG_DESTROYED ) ) {
+         weapon_free( w );
          continue;
-      weapon_free( w );
-      array_erase( &weapon_stack, &weapon_stack[i], &weapon_stack[i + 1] );
+      }
+      if ( n != i )
+         weapon_stack[n] = *w;
+      n++;
    }
+   array_resize( &weapon_stack, n );
 
    /* Do a second pass to add the quadtree elements. */
    for ( int i = 0; i < array_size( weapon_stack ); i++ ) {
@@ -1792,8 +1799,7 @@ static void weapon_miss( Weapon *w )
    if ( outfit_luaOnMiss( w->outfit ) != LUA_NOREF ) {
       const Pilot *parent = pilot_get( w->parent );
 
-      lua_rawgeti( naevL, LUA_REGISTRYINDEX, w->lua_mem );     /* mem */
-      nlua_setenv( naevL, outfit_luaEnv( w->outfit ), "mem" ); /* */
+      outfit_luaSetMem( w->outfit, w->lua_mem );
 
       /* Set up the function: onmiss() */
       lua_rawgeti( naevL, LUA_REGISTRYINDEX,
@@ -0,0 +1,27 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+# Records a few seconds of the main menu, replays it and checks that the
+# simulation ended up in the same state.
+command = sys.argv[1:-1]
+frames = sys.argv[-1]
+recording = 'replay_test.rec'
+
+record = subprocess.run(command + ['--record', recording, '--recordframes', frames],
+         stdout=subprocess.PIPE,
+         stderr=subprocess.STDOUT,
+         encoding='utf-8')
+print(record.stdout, end='')
+if 'Recorded' not in record.stdout:
+   sys.exit(1)
+
+replay = subprocess.run(command + ['--replay', recording],
+         stdout=subprocess.PIPE,
+         stderr=subprocess.STDOUT,
+         encoding='utf-8')
+print(replay.stdout, end='')
+if 'Replay was deterministic' not in replay.stdout:
+   sys.exit(1)
+sys.exit(0)
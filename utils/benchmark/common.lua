@@ -0,0 +1,119 @@
+--[[
+Shared helpers for the benchmarks in this directory. They are run headless with
+"naev --bench-lua utils/benchmark/<name>.lua" or "meson test --benchmark",
+which runs them from the "Lua Benchmark" event. Each benchmark returns a
+function that gets run as a coroutine, so it can use bench.frames() to let the
+simulation run, and that returns the table made with bench.results(), which
+gets printed and written as csv. Run the same benchmark on a previous build to
+compare.
+--]]
+local bench = {}
+
+-- Clears the system and keeps the player out of the way
+function bench.setup()
+   pilot.clear()
+   pilot.toggleSpawn(false)
+   local pp = player.pilot()
+   pp:setInvincible(true)
+   pp:setNoDeath(true)
+   collectgarbage("collect")
+end
+
+-- Creates a pair of hostile factions
+function bench.factions( name )
+   local fa = faction.dynAdd( "Mercenary", name.."_a", name.." A", {ai="mercenary"} )
+   local fb = faction.dynAdd( "Mercenary", name.."_b", name.." B", {ai="mercenary"} )
+   fa:dynEnemy( fb )
+   return fa, fb
+end
+
+-- Spawns n pilots going through ships in order and alternating between two
+-- hostile factions, spread around center
+function bench.spawnFight( n, ships, center, radius, name )
+   local fa, fb = bench.factions( name )
+   local tstart = naev.clock()
+   local plts = {}
+   for i=1,n do
+      local fct = (i % 2 == 0) and fa or fb
+      local pos = center + vec2.newP( radius*rnd.rnd(), rnd.angle() )
+      local p = pilot.add( ships[ (i-1) % #ships + 1 ], fct, pos )
+      p:setNoDeath(true)
+      plts[i] = p
+   end
+   print(string.format("Spawned %d pilots in %.3f ms", n, (naev.clock()-tstart)*1000 ))
+   return plts
+end
+
+-- Spawns n naked pilots that don't do anything, each with ncopies of every
+-- outfit in outfits, spread around the player
+function bench.spawnDummies( n, outfits, ncopies )
+   local tstart = naev.clock()
+   local plts = {}
+   for i=1,n do
+      local pos = player.pos() + vec2.newP( 1000+5000*rnd.rnd(), rnd.angle() )
+      local p = pilot.add( "Llama", "Dummy", pos, nil, {naked=true, ai="dummy"} )
+      for k,o in ipairs(outfits) do
+         p:outfitAdd( o, ncopies, true )
+      end
+      p:setInvincible(true)
+      plts[i] = p
+   end
+   print(string.format("Spawned %d pilots in %.3f ms", n, (naev.clock()-tstart)*1000 ))
+   return plts
+end
+
+-- Runs func niter times with the garbage collector stopped. func runs a single
+-- batch and returns the number of calls it made. Returns the calls per second,
+-- the bytes allocated per call, the time in seconds it takes the collector to
+-- clean up afterwards and the total number of calls.
+function bench.measure( niter, func )
+   collectgarbage("collect")
+   collectgarbage("stop")
+   local m0 = collectgarbage("count")
+   local calls = 0
+   local tstart = naev.clock()
+   for i=1,niter do
+      calls = calls + func()
+   end
+   local elapsed = naev.clock()-tstart
+   local kb = collectgarbage("count")-m0
+   collectgarbage("restart")
+   local tgc = naev.clock()
+   collectgarbage("collect")
+   local gc = naev.clock()-tgc
+   return calls / math.max( elapsed, 1e-9 ), kb*1024 / math.max( calls, 1 ), gc, calls
+end
+
+-- Lets n frames of the simulation run, and returns the wall time in seconds
+-- they took. If nogc is set, the garbage collector is stopped meanwhile and the
+-- memory allocated in bytes is returned too.
+function bench.frames( n, nogc )
+   local m0
+   if nogc then
+      collectgarbage("collect")
+      collectgarbage("stop")
+      m0 = collectgarbage("count")
+   end
+   local tstart = naev.clock()
+   for i=1,n do
+      coroutine.yield()
+   end
+   local elapsed = naev.clock()-tstart
+   if nogc then
+      local kb = collectgarbage("count")-m0
+      collectgarbage("restart")
+      return elapsed, kb*1024
+   end
+   return elapsed
+end
+
+-- Creates the results to return, with the given columns
+function bench.results( columns )
+   local res = { columns=columns, rows={} }
+   function res.add( row )
+      res.rows[ #res.rows+1 ] = row
+   end
+   return res
+end
+
+return bench
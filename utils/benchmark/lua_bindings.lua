@@ -0,0 +1,143 @@
+--[[
+Microbenchmark for the Lua bindings. Spawns a configurable mix of pilots near
+the player and runs small snippets through the real bindings in timed loops.
+For each binding it reports the calls per second, the memory allocated per call
+with the garbage collector stopped, and the time it takes the collector to
+clean up afterwards. Since it runs from the benchmark event, the hook bindings
+and the AI task helpers are covered too. See common.lua for how to run it.
+--]]
+local bench = require "utils.benchmark.common"
+
+local niter = 200
+local mix = {
+   { ship="Llama",     num=50 },
+   { ship="Hyena",     num=50 },
+   { ship="Shark",     num=50 },
+   { ship="Lancelot",  num=30 },
+   { ship="Pacifier",  num=15 },
+   { ship="Hawking",   num=5 },
+}
+
+return function ()
+   bench.setup()
+
+   local ships = {}
+   for k,m in ipairs(mix) do
+      for i=1,m.num do
+         ships[ #ships+1 ] = m.ship
+      end
+   end
+   bench.spawnFight( #ships, ships, player.pos(), 3000, "bench" )
+
+   -- Let the AI get going so the pilots have targets and tasks
+   bench.frames( 60 )
+   local plts = pilot.get()
+
+   local res = bench.results{ "binding", "calls_per_s", "bytes_per_call", "gc_ms" }
+   local function measure( name, func )
+      local ok, err = pcall( func )
+      if not ok then
+         warn(string.format("%s skipped: %s", name, err))
+         return
+      end
+      local rate, bytes, gc = bench.measure( niter, func )
+      res.add{ binding=name, calls_per_s=rate, bytes_per_call=bytes, gc_ms=gc*1000 }
+   end
+
+   local v1 = vec2.new( 100, 200 )
+   local v2 = vec2.new( -300, 50 )
+
+   measure( "pilot.get", function ()
+      pilot.get()
+      return 1
+   end )
+   measure( "pilot:pos", function ()
+      for k,p in ipairs(plts) do
+         p:pos()
+      end
+      return #plts
+   end )
+   measure( "pilot:health", function ()
+      for k,p in ipairs(plts) do
+         p:health()
+      end
+      return #plts
+   end )
+   measure( "pilot:stats", function ()
+      for k,p in ipairs(plts) do
+         p:stats("speed")
+      end
+      return #plts
+   end )
+   measure( "pilot:target", function ()
+      for k,p in ipairs(plts) do
+         p:target()
+      end
+      return #plts
+   end )
+   measure( "pilot:memory", function ()
+      for k,p in ipairs(plts) do
+         p:memory()
+      end
+      return #plts
+   end )
+   measure( "pilot:getEnemies", function ()
+      for k,p in ipairs(plts) do
+         p:getEnemies( 3000 )
+      end
+      return #plts
+   end )
+   measure( "pilot:inrange", function ()
+      local t = plts[1]
+      for k,p in ipairs(plts) do
+         p:inrange( t )
+      end
+      return #plts
+   end )
+   measure( "pilot:taskname/taskdata", function ()
+      for k,p in ipairs(plts) do
+         p:taskname()
+         p:taskdata()
+      end
+      return 2*#plts
+   end )
+   measure( "pilot:pushtask/taskClear", function ()
+      for k,p in ipairs(plts) do
+         p:pushtask( "idle", v1 )
+         p:taskClear()
+      end
+      return 2*#plts
+   end )
+   measure( "vec2.new", function ()
+      for i=1,1000 do
+         vec2.new( i, i )
+      end
+      return 1000
+   end )
+   measure( "vec2 add/mul", function ()
+      for i=1,1000 do
+         local _v = (v1 + v2) * 0.5
+      end
+      return 2000
+   end )
+   measure( "vec2:dist", function ()
+      for i=1,1000 do
+         v1:dist( v2 )
+      end
+      return 1000
+   end )
+   measure( "hook.timer/rm", function ()
+      for i=1,100 do
+         hook.rm( hook.timer( 1000, "_bench_hook" ) )
+      end
+      return 200
+   end )
+   measure( "hook.pilot/rm", function ()
+      for k,p in ipairs(plts) do
+         hook.rm( hook.pilot( p, "death", "_bench_hook" ) )
+      end
+      return 2*#plts
+   end )
+
+   return res
+end
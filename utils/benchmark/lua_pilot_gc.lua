@@ -0,0 +1,54 @@
+--[[
+Benchmark for the garbage generated when pushing pilots and vectors to Lua.
+Spawns a large number of fighting pilots near the player so that their AI runs
+at full rate, and reports the memory allocated per call of the usual AI queries
+with the garbage collector stopped, as well as the memory allocated per pilot
+and frame while the AI is running. See common.lua for how to run it.
+--]]
+local bench = require "utils.benchmark.common"
+
+local npilots = 300
+local niter = 50
+local nframes = 300
+local ships = { "Llama", "Hyena", "Shark", "Ancestor", "Lancelot" }
+
+return function ()
+   bench.setup()
+   bench.spawnFight( npilots, ships, player.pos(), 3000, "gc" )
+   bench.frames( 60 )
+
+   local res = bench.results{ "query", "calls", "calls_per_s", "bytes_per_call" }
+   local plts = pilot.get()
+   local function measure( name, func )
+      local rate, bytes, _gc, calls = bench.measure( niter, func )
+      res.add{ query=name, calls=calls, calls_per_s=rate, bytes_per_call=bytes }
+   end
+   measure( "pilot.get", function ()
+      pilot.get()
+      return 1
+   end )
+   measure( "pilot:target", function ()
+      for k,p in ipairs(plts) do
+         p:target()
+      end
+      return #plts
+   end )
+   measure( "pilot:getEnemies", function ()
+      for k,p in ipairs(plts) do
+         p:getEnemies( 3000 )
+      end
+      return #plts
+   end )
+   measure( "pilot:pos", function ()
+      for k,p in ipairs(plts) do
+         p:pos()
+      end
+      return #plts
+   end )
+
+   -- The whole simulation, counting a call per pilot and frame
+   local elapsed, bytes = bench.frames( nframes, true )
+   local calls = npilots * nframes
+   res.add{ query="frame", calls=calls, calls_per_s=calls / elapsed, bytes_per_call=bytes / calls }
+   return res
+end
@@ -0,0 +1,32 @@
+--[[
+Benchmark for the per-call overhead of setting up the outfit Lua memory. Spawns
+a large number of pilots with several copies of an outfit that only defines a
+cheap update function, so most of the time is spent setting up the calls, and
+lets them run for a while. Reports the time and the Lua memory allocated per
+outfit update, with a single copy per pilot where the memory never has to
+change between calls, and with several copies. See common.lua for how to run
+it.
+--]]
+local bench = require "utils.benchmark.common"
+
+local npilots = 500
+local nframes = 300
+local outfit = "Emergency Shield Booster" -- update
+
+return function ()
+   local res = bench.results{ "copies", "updates", "us_per_update", "bytes_per_update" }
+   for k,ncopies in ipairs{ 1, 3 } do
+      bench.setup()
+      bench.spawnDummies( npilots, {outfit}, ncopies )
+      bench.frames( 60 )
+      local elapsed, bytes = bench.frames( nframes, true )
+      local updates = npilots * ncopies * nframes
+      res.add{
+         copies = ncopies,
+         updates = updates,
+         us_per_update = elapsed*1e6 / updates,
+         bytes_per_update = bytes / updates,
+      }
+   end
+   return res
+end
@@ -0,0 +1,33 @@
+--[[
+Benchmark for the outfit Lua update scripts. Spawns a large number of pilots
+with scripted outfits that define update or update_batch, and lets them run for
+a while with the outfit updates batched and then with every slot updated on its
+own. Reports the time per frame of both. See common.lua for how to run it.
+--]]
+local bench = require "utils.benchmark.common"
+
+local npilots = 500
+local nframes = 600
+local outfits = {
+   "Nebular Shielding Prototype", -- update_batch
+   "Emergency Shield Booster", -- update
+}
+
+return function ()
+   local outfit_batch = naev.conf().outfit_batch
+   local res = bench.results{ "outfit_batch", "frames", "ms_per_frame" }
+   bench.setup()
+   bench.spawnDummies( npilots, outfits, 1 )
+   for k,batch in ipairs{ true, false } do
+      naev.confSet( "outfit_batch", batch )
+      bench.frames( 60 )
+      local elapsed = bench.frames( nframes )
+      res.add{
+         outfit_batch = batch,
+         frames = nframes,
+         ms_per_frame = elapsed*1000 / nframes,
+      }
+   end
+   naev.confSet( "outfit_batch", outfit_batch )
+   return res
+end
@@ -0,0 +1,35 @@
+--[[
+Benchmark for the reduced detail simulation of distant pilots. Spawns a large
+number of pilots in two hostile groups far from the player so that they are off
+screen and outside of sensor range, and lets them fight for a while with the
+reduced detail simulation enabled and then disabled. Reports the time per frame
+of both, the "pilots_lod" plot of the profiler shows how many pilots are being
+simulated at reduced detail. See common.lua for how to run it.
+--]]
+local bench = require "utils.benchmark.common"
+
+local npilots = 400
+local nframes = 600
+local ships = { "Llama", "Hyena", "Shark", "Ancestor", "Lancelot" }
+
+return function ()
+   local sim_lod = naev.conf().sim_lod
+   local res = bench.results{ "sim_lod", "frames", "ms_per_frame" }
+   for k,lod in ipairs{ true, false } do
+      naev.confSet( "sim_lod", lod )
+      bench.setup()
+      local center = player.pos() + vec2.newP( 30e3, rnd.angle() )
+      bench.spawnFight( npilots, ships, center, 5000, "lod" )
+
+      -- Let things settle before measuring
+      bench.frames( 60 )
+      local elapsed = bench.frames( nframes )
+      res.add{
+         sim_lod = lod,
+         frames = nframes,
+         ms_per_frame = elapsed*1000 / nframes,
+      }
+   end
+   naev.confSet( "sim_lod", sim_lod )
+   return res
+end